@@ -0,0 +1,138 @@
+#include "Core/Archive.hpp"
+
+#include "BenchSetup.hpp"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <cstdio>
+
+#include "Platform/Platform.hpp"
+
+#ifndef GAME_OS_WIN
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+constexpr std::size_t kFileCount = 2000;
+constexpr std::size_t kFileSize = 16 * 1024;
+constexpr int kWarmPasses = 10;
+
+namespace fs = std::filesystem;
+
+/// Drop file from page cache, so next read goes to disk
+/// Only possible on POSIX, on Windows cold numbers are warm ones
+void Evict(const std::string &path)
+{
+#ifndef GAME_OS_WIN
+    const int file = open(path.c_str(), O_RDONLY);
+    if(file < 0)
+        return;
+    fdatasync(file);
+    posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+    close(file);
+#else
+    (void)path;
+#endif
+}
+
+/// Sum of bytes, so reads can't be optimized out
+volatile uint64_t sink = 0;
+
+void Touch(const std::byte *data, std::size_t size)
+{
+    uint64_t sum = 0;
+    for(std::size_t i = 0; i < size; i += 64)
+        sum += static_cast<uint64_t>(data[i]);
+    sink = sink + sum;
+}
+
+void ReadLoose(const std::vector<std::string> &paths)
+{
+    std::vector<std::byte> buffer;
+    for(const std::string &path : paths)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        buffer.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        Touch(buffer.data(), buffer.size());
+    }
+}
+
+void ReadArchive(const std::string &archive_path, const std::vector<std::string> &names)
+{
+    Archive archive;
+    if(!archive.Open(archive_path))
+        return;
+    std::vector<std::byte> buffer;
+    for(const std::string &name : names)
+    {
+        const Archive::Entry *entry = archive.Find(name);
+        if(entry->flags & Archive::Entry::kCompressed)
+        {
+            (void)archive.Read(*entry, buffer);
+            Touch(buffer.data(), buffer.size());
+        }
+        else
+        {
+            const ByteSpan stored = archive.GetStored(*entry);
+            Touch(stored.data, stored.size);
+        }
+    }
+}
+} // namespace
+
+int main()
+{
+    const fs::path directory = fs::temp_directory_path() / "ArchiveBenchmark";
+    fs::create_directories(directory);
+
+    // Half of every file is noise and half is repeated, roughly like uncompressed image data
+    std::mt19937 random(42);
+    std::vector<std::string> paths;
+    std::vector<std::string> names;
+    std::vector<char> bytes(kFileSize);
+    ArchiveWriter stored;
+    ArchiveWriter compressed;
+    for(std::size_t i = 0; i < kFileCount; ++i)
+    {
+        for(std::size_t j = 0; j < kFileSize; ++j)
+            bytes[j] = j < kFileSize / 2 ? static_cast<char>(random()) : static_cast<char>(j % 32);
+        names.push_back("res/file" + std::to_string(i) + ".bin");
+        paths.push_back((directory / ("file" + std::to_string(i) + ".bin")).string());
+        std::ofstream(paths.back(), std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        (void)stored.Add(names.back(), reinterpret_cast<const std::byte*>(bytes.data()), bytes.size(), false);
+        (void)compressed.Add(names.back(), reinterpret_cast<const std::byte*>(bytes.data()), bytes.size(), true);
+    }
+    const std::string stored_path = (directory / "stored.pak").string();
+    const std::string compressed_path = (directory / "compressed.pak").string();
+    (void)stored.Write(stored_path);
+    (void)compressed.Write(compressed_path);
+
+    const auto evict_all = [&]
+    {
+        for(const std::string &path : paths)
+            Evict(path);
+        Evict(stored_path);
+        Evict(compressed_path);
+    };
+
+    evict_all();
+    ReportBenchmark("Loose files cold", kFileCount, MeasureSeconds([&]{ ReadLoose(paths); }));
+    evict_all();
+    ReportBenchmark("Archive cold", kFileCount, MeasureSeconds([&]{ ReadArchive(stored_path, names); }));
+    evict_all();
+    ReportBenchmark("LZ4 archive cold", kFileCount, MeasureSeconds([&]{ ReadArchive(compressed_path, names); }));
+
+    ReportBenchmark("Loose files warm", kFileCount * kWarmPasses, MeasureSeconds([&]{ for(int i = 0; i < kWarmPasses; ++i) ReadLoose(paths); }));
+    ReportBenchmark("Archive warm", kFileCount * kWarmPasses, MeasureSeconds([&]{ for(int i = 0; i < kWarmPasses; ++i) ReadArchive(stored_path, names); }));
+    ReportBenchmark("LZ4 archive warm", kFileCount * kWarmPasses, MeasureSeconds([&]{ for(int i = 0; i < kWarmPasses; ++i) ReadArchive(compressed_path, names); }));
+
+    fs::remove_all(directory);
+    return 0;
+}
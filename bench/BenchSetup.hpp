@@ -0,0 +1,26 @@
+#ifndef BENCH_SETUP_HPP
+#define BENCH_SETUP_HPP
+
+#include <iostream>
+#include <chrono>
+#include <string>
+
+namespace game {}
+using namespace game;
+
+/// Measure wall time of a callable in seconds
+template<typename F>
+inline double MeasureSeconds(F &&function)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+/// Print result line in form: name: operations ops in seconds s (operations / seconds ops/s)
+inline void ReportBenchmark(const std::string &name, double operations, double seconds)
+{
+    std::cout << name << ": " << operations << " ops in " << seconds << " s (" << operations / seconds << " ops/s)\n";
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include "Core/JobSystem.hpp"
+
+#include "BenchSetup.hpp"
+
+#include <thread>
+#include <vector>
+#include <cmath>
+
+namespace
+{
+constexpr uint32_t kElementCount = 1 << 20;
+constexpr uint32_t kIterationsPerElement = 64;
+constexpr int kRepeatCount = 4;
+
+/// Synthetic compute bound workload, result is stored so it isn't optimized away
+void Work(std::vector<float> &values, uint32_t begin, uint32_t end)
+{
+    for(uint32_t i = begin; i < end; ++i)
+    {
+        float value = static_cast<float>(i);
+        for(uint32_t j = 0; j < kIterationsPerElement; ++j)
+            value = std::sqrt(value * 1.0001f + 1.0f);
+        values[i] = value;
+    }
+}
+
+double BenchParallelFor(std::size_t worker_count, std::vector<float> &values)
+{
+    JobSystem jobs;
+    jobs.Init(worker_count);
+
+    // Warm up, so workers are awake and caches are filled
+    jobs.ParallelFor(kElementCount, 1024, [&values](uint32_t begin, uint32_t end) { Work(values, begin, end); });
+
+    const double seconds = MeasureSeconds([&]
+    {
+        for(int i = 0; i < kRepeatCount; ++i)
+            jobs.ParallelFor(kElementCount, 1024, [&values](uint32_t begin, uint32_t end) { Work(values, begin, end); });
+    });
+    jobs.Exit();
+
+    ReportBenchmark("ParallelFor elements, threads: " + std::to_string(worker_count + 1), static_cast<double>(kElementCount) * kRepeatCount, seconds);
+    return seconds;
+}
+
+void BenchEmptyJobs()
+{
+    JobSystem jobs;
+    jobs.Init();
+
+    constexpr int kJobCount = 1000000;
+    const double seconds = MeasureSeconds([&]
+    {
+        JobCounter counter;
+        for(int i = 0; i < kJobCount; ++i)
+            jobs.Run([](__attribute__((unused)) void *data) {}, nullptr, &counter);
+        jobs.Wait(counter);
+    });
+    jobs.Exit();
+
+    ReportBenchmark("Empty job run/execute", kJobCount, seconds);
+}
+} // namespace
+
+int main()
+{
+    std::vector<float> values(kElementCount);
+    const std::size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+    const double single_thread = MeasureSeconds([&] { for(int i = 0; i < kRepeatCount; ++i) Work(values, 0, kElementCount); });
+    ReportBenchmark("Single thread elements", static_cast<double>(kElementCount) * kRepeatCount, single_thread);
+
+    for(std::size_t threads = 2; threads <= cores; threads *= 2)
+    {
+        const double seconds = BenchParallelFor(threads - 1, values);
+        std::cout << "  speedup: " << single_thread / seconds << "x\n";
+    }
+
+    BenchEmptyJobs();
+    return 0;
+}
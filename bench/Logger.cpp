@@ -0,0 +1,82 @@
+#include "Utils/Logger.hpp"
+#include "Utils/BinaryLog.hpp"
+
+#include "BenchSetup.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t kLinesPerThread = 200000;
+constexpr std::size_t kBurstCount = 100;
+
+/// Time spent by threads that log, writer thread drains and writes in background
+/// Lines that don't fit into queue are dropped, like they would be in game
+/// Binary lines are written to .binlog file, so formatting is left to LogDecoder
+void BenchLogging(std::size_t thread_count, bool binary)
+{
+    const uint64_t dropped = Logger::Get().GetDroppedCount();
+    const double seconds = MeasureSeconds([&]
+    {
+        std::vector<std::thread> threads;
+        for(std::size_t i = 0; i < thread_count; ++i)
+            threads.emplace_back([i, binary]
+            {
+                if(binary)
+                    for(std::size_t line = 0; line < kLinesPerThread; ++line)
+                        GAME_BLOG(LogType::Info, "Benchmark thread {} line {} value {}", i, line, 0.5f * static_cast<float>(line));
+                else
+                    for(std::size_t line = 0; line < kLinesPerThread; ++line)
+                        GAME_LOG(LogType::Info) << "Benchmark thread " << i << " line " << line << " value " << 0.5f * static_cast<float>(line);
+            });
+        for(std::thread &thread : threads)
+            thread.join();
+    });
+    Logger::Get().Flush();
+
+    const std::string name = std::string(binary ? "Logger binary lines" : "Logger lines") + ", threads: " + std::to_string(thread_count);
+    ReportBenchmark(name, static_cast<double>(thread_count * kLinesPerThread), seconds);
+    std::cout << name << ": " << Logger::Get().GetDroppedCount() - dropped << " lines dropped\n";
+}
+/// Bursts fit into queue, so every line is kept and only cost of call is measured
+void BenchBursts(bool binary)
+{
+    const std::size_t burst_size = Logger::kQueueCapacity / 2;
+    double seconds = 0.0;
+    for(std::size_t burst = 0; burst < kBurstCount; ++burst)
+    {
+        seconds += MeasureSeconds([&]
+        {
+            if(binary)
+                for(std::size_t line = 0; line < burst_size; ++line)
+                    GAME_BLOG(LogType::Info, "Burst {} line {} value {}", burst, line, 0.5f * static_cast<float>(line));
+            else
+                for(std::size_t line = 0; line < burst_size; ++line)
+                    GAME_LOG(LogType::Info) << "Burst " << burst << " line " << line << " value " << 0.5f * static_cast<float>(line);
+        });
+        Logger::Get().Flush();
+    }
+    ReportBenchmark(std::string(binary ? "Logger binary line bursts" : "Logger line bursts"), static_cast<double>(kBurstCount * burst_size), seconds);
+}
+} // namespace
+
+int main()
+{
+    // Console would measure terminal, not logger
+    std::ostream discarded(nullptr);
+    Logger::Get().SetOutStreamBuffer(discarded);
+
+    BenchBursts(false);
+    BenchLogging(1, false);
+    BenchLogging(4, false);
+    Logger::Get().SetBinaryOutput(true);
+    BenchBursts(true);
+    BenchLogging(1, true);
+    BenchLogging(4, true);
+    Logger::Get().SetBinaryOutput(false);
+
+    Logger::Get().SetOutStreamBuffer(std::cout);
+    return 0;
+}
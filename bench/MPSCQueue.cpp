@@ -0,0 +1,79 @@
+#include "Utils/MPSCQueue.hpp"
+#include "Core/EventHandler.hpp"
+
+#include "BenchSetup.hpp"
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+constexpr std::size_t kItemsPerProducer = 1000000;
+
+bool CountEvent(__attribute__((unused)) const Event &event, void *data)
+{
+    ++*reinterpret_cast<std::size_t*>(data);
+    return true;
+}
+
+void BenchQueue(std::size_t producer_count)
+{
+    MPSCQueue<Event> queue(4096);
+    const std::size_t total = producer_count * kItemsPerProducer;
+
+    const double seconds = MeasureSeconds([&]
+    {
+        std::vector<std::thread> producers;
+        for(std::size_t i = 0; i < producer_count; ++i)
+            producers.emplace_back([&queue]
+            {
+                for(std::size_t j = 0; j < kItemsPerProducer; ++j)
+                    while(!queue.TryPush(Event{Event::Quit{}}))
+                        std::this_thread::yield();
+            });
+
+        Event event;
+        for(std::size_t received = 0; received < total;)
+            received += queue.TryPop(event);
+
+        for(std::thread &producer : producers)
+            producer.join();
+    });
+
+    ReportBenchmark("MPSCQueue push/pop, producers: " + std::to_string(producer_count), static_cast<double>(total), seconds);
+}
+
+void BenchEventHandler()
+{
+    EventHandler events(EventHandler::kDefQueueCapacity);
+    EventCleaner cleaner(events);
+    std::size_t dispatched = 0;
+    events.AddListener(cleaner, EventType::Quit, &dispatched, CountEvent);
+
+    const std::size_t total = 1000 * EventHandler::kDefQueueCapacity;
+    const double seconds = MeasureSeconds([&]
+    {
+        for(std::size_t frame = 0; frame < 1000; ++frame)
+        {
+            for(std::size_t i = 0; i < EventHandler::kDefQueueCapacity; ++i)
+                events.EnqueEvent(Event{Event::Quit{}});
+            events.DispatchEnquedEvents();
+        }
+    });
+
+    ReportBenchmark("EventHandler enque/dispatch", static_cast<double>(total), seconds);
+}
+} // namespace
+
+int main()
+{
+    // One core is left for consumer
+    const std::size_t max_producers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    for(std::size_t producer_count = 1; producer_count <= max_producers; producer_count *= 2)
+        BenchQueue(producer_count);
+
+    BenchEventHandler();
+
+    return 0;
+}
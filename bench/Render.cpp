@@ -0,0 +1,54 @@
+#include "RenderHarness.hpp"
+
+#include "BenchSetup.hpp"
+
+#include <string>
+
+namespace
+{
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+constexpr uint32_t kWarmupFrames = 10;
+constexpr uint32_t kFrames = 60;
+
+/// Render frames of scene and wait for GPU to finish them, so frame rate includes GPU time
+/// With capture every frame is read back too, finished reads are taken without waiting like renderer does
+double RenderFrames(RenderHarness &harness, const Scene &scene, uint32_t first, uint32_t count, bool capture)
+{
+    Image image;
+    const double seconds = MeasureSeconds([&]
+    {
+        for(uint32_t frame = first; frame < first + count; ++frame)
+        {
+            while(harness.readback.Poll(image)) {}
+            harness.RenderFrame(scene, frame, capture);
+        }
+        while(harness.readback.Wait(image)) {}
+        glFinish();
+    });
+    return seconds;
+}
+} // namespace
+
+int main()
+{
+    RenderHarness harness;
+    const std::string error = harness.Init(kWidth, kHeight);
+    if(!error.empty())
+    {
+        std::cout << "Skipping render benchmark: " << error << '\n';
+        harness.Exit();
+        return 0;
+    }
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << ", " << kWidth << "x" << kHeight << '\n';
+
+    for(const Scene &scene : kBenchmarkScenes)
+    {
+        RenderFrames(harness, scene, 0, kWarmupFrames, false);
+        ReportBenchmark(std::string("Render ") + scene.name + " fps", kFrames, RenderFrames(harness, scene, kWarmupFrames, kFrames, false));
+        ReportBenchmark(std::string("Render ") + scene.name + " with readback fps", kFrames, RenderFrames(harness, scene, kWarmupFrames, kFrames, true));
+    }
+
+    harness.Exit();
+    return 0;
+}
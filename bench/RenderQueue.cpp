@@ -0,0 +1,40 @@
+#include "Core/RenderQueue.hpp"
+
+#include "BenchSetup.hpp"
+
+#include <vector>
+#include <random>
+
+namespace
+{
+constexpr std::size_t kCommandCount = 100000;
+constexpr int kFrameCount = 100;
+} // namespace
+
+int main()
+{
+    RenderQueue queue;
+    queue.Reserve(kCommandCount, kCommandCount * 48);
+
+    std::mt19937 random(42);
+    std::vector<uint64_t> keys(kCommandCount);
+    for(uint64_t &key : keys)
+        key = RenderQueue::MakeKey(random() % 4, random() % 16, random() % 256, static_cast<float>(random()) / static_cast<float>(random.max()));
+
+    double record_seconds = 0.0;
+    double sort_seconds = 0.0;
+    for(int frame = 0; frame < kFrameCount; ++frame)
+    {
+        record_seconds += MeasureSeconds([&]
+        {
+            for(std::size_t i = 0; i < kCommandCount; ++i)
+                queue.Add(keys[i], DrawCommand{1, 2, 3, DrawCommand::kTriangles, 0, 6, 1});
+        });
+        sort_seconds += MeasureSeconds([&] { queue.Sort(); });
+        queue.Clear();
+    }
+
+    ReportBenchmark("RenderQueue record", static_cast<double>(kCommandCount) * kFrameCount, record_seconds);
+    ReportBenchmark("RenderQueue sort", static_cast<double>(kCommandCount) * kFrameCount, sort_seconds);
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "Archive.hpp"
+
+#include "Setup.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+#include "Utils/Hash.hpp"
+#include "Utils/LZ4.hpp"
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+auto Archive::Open(const std::string &path) noexcept -> bool
+{
+  ZoneScopedC(0xb3041b);
+
+  Close();
+  if(!file_.Open(path))
+    return false;
+
+  const auto invalid = [&](const char *reason) -> bool
+  {
+    GAME_LOG(LogType::Warning) << "Archive " << path << " is invalid: " << reason;
+    Close();
+    return false;
+  };
+
+  if(file_.GetSize() < sizeof(Header))
+    return invalid("file is smaller than header");
+  Header header;
+  std::memcpy(&header, file_.GetData(), sizeof(header));
+  if(std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+    return invalid("wrong magic");
+  if(header.version != kVersion)
+    return invalid("unsupported version");
+  if(header.index_offset % alignof(Entry) != 0 || header.index_offset > file_.GetSize() || (file_.GetSize() - header.index_offset) / sizeof(Entry) < header.entry_count)
+    return invalid("index is out of file");
+
+  // Mapping is page aligned and index offset is aligned to Entry, so index is used in place
+  entries_ = reinterpret_cast<const Entry*>(file_.GetData() + header.index_offset);
+  entry_count_ = header.entry_count;
+  for(std::size_t i = 0; i < entry_count_; ++i)
+  {
+    const Entry &entry = entries_[i];
+    if(i != 0 && entries_[i - 1].path_hash >= entry.path_hash)
+      return invalid("index isn't sorted");
+    if(entry.offset > header.index_offset || entry.stored_size > header.index_offset - entry.offset)
+      return invalid("entry is out of file");
+    if(!(entry.flags & Entry::kCompressed) && entry.stored_size != entry.size)
+      return invalid("stored entry has wrong size");
+  }
+
+  GAME_LOG(LogType::Info) << "Opened archive " << path << " with " << entry_count_ << " entries";
+  return true;
+}
+
+auto Archive::Find(std::string_view path) const noexcept -> const Entry*
+{
+  const uint32_t hash = HashString(path);
+  const Entry *entry = std::lower_bound(begin(), end(), hash, [](const Entry &lhs, uint32_t rhs){ return lhs.path_hash < rhs; });
+  return entry != end() && entry->path_hash == hash ? entry : nullptr;
+}
+
+auto Archive::Read(const Entry &entry, std::vector<std::byte> &output) const noexcept -> bool
+{
+  ZoneScopedC(0xb3041b);
+  ZoneValue(entry.size);
+
+  const ByteSpan stored = GetStored(entry);
+  output.resize(static_cast<std::size_t>(entry.size));
+  if(!(entry.flags & Entry::kCompressed))
+  {
+    // Empty entry can have null data, memcpy needs valid pointers even for zero bytes
+    if(stored.size != 0)
+      std::memcpy(output.data(), stored.data, stored.size);
+    return true;
+  }
+  if(LZ4Decompress(stored.data, stored.size, output.data(), output.size()))
+    return true;
+
+  GAME_LOG(LogType::Warning) << "Archive entry " << entry.path_hash << " is corrupted";
+  return false;
+}
+
+auto ArchiveWriter::Add(std::string_view path, const std::byte *data, std::size_t size, bool compress) noexcept -> bool
+{
+  ZoneScopedC(0xb3041b);
+
+  const uint32_t hash = HashString(path);
+  for(std::size_t i = 0; i < entries_.size(); ++i)
+  {
+    if(entries_[i].path_hash == hash)
+    {
+      GAME_LOG(LogType::Error) << "Archive paths " << paths_[i] << " and " << path << " have the same hash";
+      return false;
+    }
+  }
+
+  Archive::Entry entry{hash, 0, 0, size, size};
+  std::vector<std::byte> blob;
+  if(compress)
+  {
+    LZ4Compress(data, size, blob);
+    if(static_cast<double>(blob.size()) <= static_cast<double>(size) * kMinCompressionRatio)
+    {
+      entry.flags |= Archive::Entry::kCompressed;
+      entry.stored_size = blob.size();
+    }
+    else
+      blob.clear();
+  }
+  if(!(entry.flags & Archive::Entry::kCompressed))
+    blob.assign(data, data + size);
+
+  entries_.push_back(entry);
+  blobs_.push_back(std::move(blob));
+  paths_.emplace_back(path);
+  return true;
+}
+
+auto ArchiveWriter::Write(const std::string &path) const noexcept -> bool
+{
+  ZoneScopedC(0xb3041b);
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if(!file)
+  {
+    GAME_LOG(LogType::Error) << "Couldn't open " << path << " for writing";
+    return false;
+  }
+
+  const auto align = [](uint64_t offset) { return (offset + Archive::kAlignment - 1) / Archive::kAlignment * Archive::kAlignment; };
+  static constexpr char kZeros[Archive::kAlignment] = {};
+
+  std::vector<Archive::Entry> index = entries_;
+  uint64_t offset = align(sizeof(Archive::Header));
+  for(std::size_t i = 0; i < index.size(); ++i)
+  {
+    index[i].offset = offset;
+    offset = align(offset + blobs_[i].size());
+  }
+
+  Archive::Header header{};
+  std::memcpy(header.magic, Archive::kMagic, sizeof(header.magic));
+  header.version = Archive::kVersion;
+  header.entry_count = static_cast<uint32_t>(index.size());
+  header.index_offset = offset;
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  uint64_t written = sizeof(header);
+  for(std::size_t i = 0; i < index.size(); ++i)
+  {
+    file.write(kZeros, static_cast<std::streamsize>(index[i].offset - written));
+    file.write(reinterpret_cast<const char*>(blobs_[i].data()), static_cast<std::streamsize>(blobs_[i].size()));
+    written = index[i].offset + blobs_[i].size();
+  }
+  file.write(kZeros, static_cast<std::streamsize>(offset - written));
+
+  std::sort(index.begin(), index.end(), [](const Archive::Entry &lhs, const Archive::Entry &rhs){ return lhs.path_hash < rhs.path_hash; });
+  file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(Archive::Entry)));
+
+  if(!file)
+  {
+    GAME_LOG(LogType::Error) << "Couldn't write archive " << path;
+    return false;
+  }
+  return true;
+}
+} // game
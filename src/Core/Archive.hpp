@@ -0,0 +1,113 @@
+#ifndef GAME_ARCHIVE_HPP
+#define GAME_ARCHIVE_HPP
+
+#include "Setup.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+#include "Platform/MappedFile.hpp"
+
+
+namespace game
+{
+/// Contiguous read only bytes
+struct ByteSpan
+{
+  const std::byte *data = nullptr;
+  std::size_t size = 0;
+};
+
+/// Packed read only file archive
+///
+/// Layout: header, blobs aligned to kAlignment, index of entries sorted by path hash
+/// Paths aren't stored, entries are found by HashString of path with binary search
+/// Archive is memory mapped, so stored entries are handed out without copying
+/// and only pages that are touched are read from disk
+/// Every const method is thread safe
+class Archive
+{
+public:
+  static constexpr inline char kMagic[4] = { 'G', 'P', 'A', 'K' };
+  static constexpr inline uint32_t kVersion = 1;
+  static constexpr inline std::size_t kAlignment = 64;
+
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+    uint64_t index_offset;
+  };
+
+  struct Entry
+  {
+    enum : uint32_t { kCompressed = 1 };
+
+    uint32_t path_hash;
+    uint32_t flags;
+    uint64_t offset;
+    /// Size of bytes in archive
+    uint64_t stored_size;
+    /// Size after decompression
+    uint64_t size;
+  };
+
+  static_assert(sizeof(Header) == 24 && sizeof(Entry) == 32, "Archive structures are written as is, so they shouldn't have padding");
+
+  Archive() noexcept = default;
+  Archive(const Archive &) = delete;
+  Archive &operator=(const Archive &) = delete;
+
+  /// Map archive and check its index
+  /// return false if file can't be mapped or isn't valid archive
+  [[nodiscard]] auto Open(const std::string &path) noexcept -> bool;
+  inline void Close() noexcept { file_.Close(); entries_ = nullptr; entry_count_ = 0; }
+
+  /// return nullptr if there is no entry with this path
+  [[nodiscard]] auto Find(std::string_view path) const noexcept -> const Entry*;
+  /// Bytes of entry as they are stored, compressed entries should be read with Read
+  /// Valid until archive is closed
+  [[nodiscard]] inline auto GetStored(const Entry &entry) const noexcept -> ByteSpan { return ByteSpan{file_.GetData() + entry.offset, static_cast<std::size_t>(entry.stored_size)}; }
+  /// Decompress or copy entry into output
+  /// return false if compressed data is corrupted
+  [[nodiscard]] auto Read(const Entry &entry, std::vector<std::byte> &output) const noexcept -> bool;
+
+  [[nodiscard]] constexpr inline auto IsOpen() const noexcept -> bool { return file_.IsOpen(); }
+  [[nodiscard]] constexpr inline auto begin() const noexcept -> const Entry* { return entries_; }
+  [[nodiscard]] constexpr inline auto end() const noexcept -> const Entry* { return entries_ + entry_count_; }
+  [[nodiscard]] constexpr inline auto GetEntryCount() const noexcept -> std::size_t { return entry_count_; }
+
+private:
+  MappedFile file_;
+  const Entry *entries_ = nullptr;
+  std::size_t entry_count_ = 0;
+};
+
+/// Builds archive file
+class ArchiveWriter
+{
+public:
+  /// Compressed entry is kept only if it is at least that much smaller
+  static constexpr inline double kMinCompressionRatio = 0.9;
+
+  /// Add entry, compress tells to try LZ4
+  /// return false if path hash collides with other entry
+  [[nodiscard]] auto Add(std::string_view path, const std::byte *data, std::size_t size, bool compress) noexcept -> bool;
+  /// Write archive to file
+  [[nodiscard]] auto Write(const std::string &path) const noexcept -> bool;
+
+  [[nodiscard]] inline auto GetEntryCount() const noexcept -> std::size_t { return entries_.size(); }
+
+private:
+  std::vector<Archive::Entry> entries_;
+  /// Blob of each entry in order they were added
+  std::vector<std::vector<std::byte>> blobs_;
+  std::vector<std::string> paths_;
+};
+} // game
+
+#endif // GAME_ARCHIVE_HPP
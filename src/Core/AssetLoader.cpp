@@ -0,0 +1,269 @@
+#include "AssetLoader.hpp"
+
+#include "Setup.hpp"
+
+#include <algorithm>
+
+#include "Utils/Hash.hpp"
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+void AssetLoader::Init(TextureCache &textures, EventHandler &events, std::size_t thread_count, int64_t memory_limit) noexcept
+{
+  ZoneScopedC(0xb3041b);
+
+  textures_ = &textures;
+  events_ = &events;
+  memory_limit_ = memory_limit;
+  RegisterEventTypeName(kAssetLoadedEventType, "Asset Loaded");
+
+  running_ = true;
+  thread_count = std::max<std::size_t>(thread_count, 1);
+  for(std::size_t i = 0; i < thread_count; ++i)
+    threads_.emplace_back(&AssetLoader::ThreadLoop, this);
+  GAME_LOG(LogType::Info) << "Asset loader threads: " << thread_count << ", texture memory limit: " << (memory_limit_ >> 20) << "MB";
+}
+
+void AssetLoader::Exit() noexcept
+{
+  if(threads_.empty())
+    return;
+
+  ZoneScopedC(0xb3041b);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+    requests_.clear();
+  }
+  condition_.notify_all();
+  for(std::thread &thread : threads_)
+    thread.join();
+  threads_.clear();
+}
+
+auto AssetLoader::LoadTexture(std::string_view path) noexcept -> TextureHandle
+{
+  ZoneScopedC(0xb3041b);
+
+  const uint32_t path_hash = HashString(path);
+  if(const auto it = slot_by_hash_.find(path_hash); it != slot_by_hash_.end())
+    return TextureHandle(this, it->second);
+
+  const uint32_t index = NewSlot(path, path_hash);
+  Slot &slot = slots_[index];
+
+  // Loaded before and not evicted yet
+  if(const TextureRegion *cached = textures_->Find(path); cached != nullptr)
+  {
+    slot.region = *cached;
+    slot.state = AssetState::Ready;
+    textures_->Retain(slot.region.texture);
+    if(!events_->EnqueCustomEvent<AssetLoadedEvent>(kAssetLoadedEventType, AssetLoadedEvent{path_hash, slot.state}))
+      GAME_LOG(LogType::Warning) << "Event queue is full, asset loaded event is dropped: " << path;
+    return TextureHandle(this, index);
+  }
+
+  ++pending_count_;
+  QueueRequest(slot);
+  return TextureHandle(this, index);
+}
+
+void AssetLoader::Reload(std::string_view path) noexcept
+{
+  ZoneScopedC(0xb3041b);
+
+  const uint32_t path_hash = HashString(path);
+  if(const auto it = slot_by_hash_.find(path_hash); it != slot_by_hash_.end())
+  {
+    Slot &slot = slots_[it->second];
+    if(slot.state == AssetState::Pending || slot.reloading)
+    {
+      slot.reload_again = true;
+      return;
+    }
+    slot.reloading = true;
+    QueueRequest(slot);
+    return;
+  }
+
+  // Textures loaded with TextureCache::Load are small and few, so they are decoded right here
+  if(textures_->Find(path) == nullptr)
+    return;
+  Image image;
+  if(LoadImage(std::string(path), image))
+    (void)textures_->Reload(path, image);
+}
+
+void AssetLoader::QueueRequest(Slot &slot) noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    requests_.push_back(&slot);
+  }
+  condition_.notify_one();
+}
+
+void AssetLoader::Update() noexcept
+{
+  ZoneScopedC(0xb3041b);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(finished_, decoded_);
+  }
+
+  for(Slot *slot : finished_)
+  {
+    const uint32_t index = slot_by_hash_.at(slot->path_hash);
+    if(slot->reloading)
+    {
+      FinishReload(*slot, index);
+      continue;
+    }
+
+    --pending_count_;
+    // Every handle was dropped while it was loading
+    if(slot->references == 0)
+    {
+      FreeSlot(index);
+      continue;
+    }
+
+    if(slot->decoded)
+    {
+      slot->region = textures_->Add(slot->path, slot->image, true);
+      slot->state = AssetState::Ready;
+      textures_->Retain(slot->region.texture);
+    }
+    else
+    {
+      slot->region = textures_->GetFallback();
+      slot->state = AssetState::Failed;
+    }
+    slot->image = Image{};
+
+    if(!events_->EnqueCustomEvent<AssetLoadedEvent>(kAssetLoadedEventType, AssetLoadedEvent{slot->path_hash, slot->state}))
+      GAME_LOG(LogType::Warning) << "Event queue is full, asset loaded event is dropped: " << slot->path;
+    if(std::exchange(slot->reload_again, false))
+      Reload(slot->path);
+  }
+  finished_.clear();
+  TracyPlot("Pending assets", static_cast<int64_t>(pending_count_));
+
+  if(textures_->GetMemoryUsage() > memory_limit_)
+  {
+    textures_->Evict(memory_limit_);
+    // Warn once, otherwise it would be every frame
+    const bool over_limit = textures_->GetMemoryUsage() > memory_limit_;
+    if(over_limit && !over_limit_)
+      GAME_LOG(LogType::Warning) << "Texture memory usage " << textures_->GetMemoryUsage() << " is over the limit " << memory_limit_ << ", but every texture is in use";
+    over_limit_ = over_limit;
+  }
+}
+
+void AssetLoader::FinishReload(Slot &slot, uint32_t index) noexcept
+{
+  slot.reloading = false;
+  if(slot.references == 0)
+  {
+    if(slot.state == AssetState::Ready)
+      textures_->Release(slot.region.texture);
+    FreeSlot(index);
+    return;
+  }
+
+  if(!slot.decoded)
+    GAME_LOG(LogType::Warning) << "Couldn't reload " << slot.path << ", old texture is kept";
+  else if(slot.state == AssetState::Failed)
+  {
+    // File is fixed, so asset finally loads
+    slot.region = textures_->Add(slot.path, slot.image, true);
+    slot.state = AssetState::Ready;
+    textures_->Retain(slot.region.texture);
+  }
+  else if(const TextureRegion *region = textures_->Reload(slot.path, slot.image); region != nullptr)
+  {
+    if(region->texture != slot.region.texture)
+    {
+      textures_->Retain(region->texture);
+      textures_->Release(slot.region.texture);
+    }
+    slot.region = *region;
+  }
+  slot.image = Image{};
+
+  if(slot.decoded && !events_->EnqueCustomEvent<AssetLoadedEvent>(kAssetLoadedEventType, AssetLoadedEvent{slot.path_hash, slot.state}))
+    GAME_LOG(LogType::Warning) << "Event queue is full, asset loaded event is dropped: " << slot.path;
+  if(std::exchange(slot.reload_again, false))
+    Reload(slot.path);
+}
+
+auto AssetLoader::NewSlot(std::string_view path, uint32_t path_hash) noexcept -> uint32_t
+{
+  uint32_t index;
+  if(free_slots_.empty())
+  {
+    index = static_cast<uint32_t>(slots_.size());
+    slots_.emplace_back();
+  }
+  else
+  {
+    index = free_slots_.back();
+    free_slots_.pop_back();
+  }
+
+  Slot &slot = slots_[index];
+  slot.path = path;
+  slot.path_hash = path_hash;
+  slot_by_hash_.emplace(path_hash, index);
+  return index;
+}
+
+void AssetLoader::FreeSlot(uint32_t index) noexcept
+{
+  Slot &slot = slots_[index];
+  slot_by_hash_.erase(slot.path_hash);
+  slot = Slot{};
+  free_slots_.push_back(index);
+}
+
+void AssetLoader::ReleaseSlot(uint32_t index) noexcept
+{
+  Slot &slot = slots_[index];
+  // Loader thread still uses it, it is freed in Update
+  if(slot.state == AssetState::Pending || slot.reloading)
+    return;
+
+  // Fallback is pinned, so it isn't retained
+  if(slot.state == AssetState::Ready)
+    textures_->Release(slot.region.texture);
+  FreeSlot(index);
+}
+
+void AssetLoader::ThreadLoop() noexcept
+{
+  #ifdef TRACY_ENABLE
+  tracy::SetThreadName("Asset Loader");
+  #endif
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while(true)
+  {
+    condition_.wait(lock, [this]{ return !requests_.empty() || !running_; });
+    if(!running_)
+      break;
+    Slot *slot = requests_.front();
+    requests_.pop_front();
+    lock.unlock();
+
+    // Reload is caused by change of file on disk, so archive is skipped
+    slot->decoded = LoadImage(slot->reloading ? nullptr : textures_->GetArchive(), slot->path, slot->image);
+
+    lock.lock();
+    decoded_.push_back(slot);
+  }
+}
+} // game
@@ -0,0 +1,200 @@
+#ifndef GAME_ASSET_LOADER_HPP
+#define GAME_ASSET_LOADER_HPP
+
+#include "Setup.hpp"
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+#include "Core/Image.hpp"
+#include "Core/TextureCache.hpp"
+#include "Core/EventHandler.hpp"
+
+
+namespace game
+{
+class AssetLoader;
+
+enum class AssetState : uint8_t
+{
+  Pending,
+  Ready,
+  /// Asset couldn't be loaded, fallback is used instead
+  Failed
+};
+
+/// Custom event that is enqued when asset leaves pending state, payload is AssetLoadedEvent
+constexpr inline EventType kAssetLoadedEventType = static_cast<EventType>(Event::kCustomTypeBitMask | 0x100);
+
+struct AssetLoadedEvent
+{
+  /// HashString of path asset was loaded with
+  uint32_t path_hash;
+  AssetState state;
+};
+
+/// Reference counted handle to texture loaded by AssetLoader
+/// Texture can be evicted only when no handle references it
+/// Should be used only on main thread and shouldn't outlive loader
+class TextureHandle
+{
+  friend AssetLoader;
+public:
+  TextureHandle() noexcept = default;
+  inline TextureHandle(const TextureHandle &other) noexcept;
+  inline TextureHandle(TextureHandle &&other) noexcept : loader_(other.loader_), slot_(other.slot_) { other.loader_ = nullptr; }
+  inline TextureHandle &operator=(TextureHandle other) noexcept { std::swap(loader_, other.loader_); std::swap(slot_, other.slot_); return *this; }
+  inline ~TextureHandle() noexcept;
+
+  [[nodiscard]] inline auto GetState() const noexcept -> AssetState;
+  [[nodiscard]] inline auto IsReady() const noexcept -> bool { return GetState() != AssetState::Pending; }
+  /// Region to draw, it has texture 0 while asset is pending and fallback texture if loading failed
+  [[nodiscard]] inline auto GetRegion() const noexcept -> const TextureRegion&;
+  [[nodiscard]] inline auto GetPathHash() const noexcept -> uint32_t;
+  /// Handle refers to an asset
+  [[nodiscard]] constexpr inline explicit operator bool() const noexcept { return loader_ != nullptr; }
+
+private:
+  inline TextureHandle(AssetLoader *loader, uint32_t slot) noexcept;
+
+  AssetLoader *loader_ = nullptr;
+  uint32_t slot_ = 0;
+};
+
+/// Loads textures without blocking main thread
+///
+/// Files are read and decoded on loader threads, from archive of texture cache if it has them, handle is returned right away in pending state
+/// Update is called once per frame on main thread, it packs decoded images into texture cache
+/// and enques kAssetLoadedEventType event for each of them
+/// Pixels reach GPU when renderer takes uploads from the cache, it limits time spent on them per frame
+/// Textures that no handle references are evicted when cache memory usage goes over the limit
+class AssetLoader
+{
+  friend TextureHandle;
+public:
+  static constexpr inline std::size_t kDefThreadCount = 1;
+  static constexpr inline int64_t kDefMemoryLimit = int64_t{512} << 20;
+
+  AssetLoader() noexcept = default;
+  AssetLoader(const AssetLoader &) = delete;
+  AssetLoader &operator=(const AssetLoader &) = delete;
+  inline ~AssetLoader() noexcept { Exit(); }
+
+  /// Start loader threads
+  void Init(TextureCache &textures, EventHandler &events, std::size_t thread_count = kDefThreadCount, int64_t memory_limit = kDefMemoryLimit) noexcept;
+  /// Drop requests that weren't started and join loader threads
+  /// Handles stay valid, but pending ones never become ready
+  void Exit() noexcept;
+
+  /// Start loading texture, or return handle to the one that is loading or loaded already
+  [[nodiscard]] auto LoadTexture(std::string_view path) noexcept -> TextureHandle;
+  /// Decode file again and replace pixels of texture loaded with this path, used for hot reload
+  /// Handles stay valid and get new region once Update finishes it, kAssetLoadedEventType is enqued again then
+  /// Files on disk are read even if archive is used, textures loaded only through cache are reloaded right away
+  void Reload(std::string_view path) noexcept;
+  /// Finish loads that were decoded since last call and evict textures if needed
+  /// Should be called once per frame on main thread
+  void Update() noexcept;
+
+  /// Amount of loads that didn't finish yet
+  [[nodiscard]] constexpr inline auto GetPendingCount() const noexcept -> std::size_t { return pending_count_; }
+  [[nodiscard]] constexpr inline auto GetMemoryLimit() const noexcept -> int64_t { return memory_limit_; }
+
+private:
+  struct Slot
+  {
+    std::string path;
+    uint32_t path_hash = 0;
+    uint32_t references = 0;
+    AssetState state = AssetState::Pending;
+    TextureRegion region;
+    /// Written by loader thread while pending or reloading
+    Image image;
+    bool decoded = false;
+    /// Ready or failed asset is being decoded again, its state doesn't change meanwhile
+    bool reloading = false;
+    /// File changed again while it was loading
+    bool reload_again = false;
+  };
+
+  auto NewSlot(std::string_view path, uint32_t path_hash) noexcept -> uint32_t;
+  void FreeSlot(uint32_t index) noexcept;
+  /// Called by last handle that references slot
+  void ReleaseSlot(uint32_t index) noexcept;
+  void QueueRequest(Slot &slot) noexcept;
+  void FinishReload(Slot &slot, uint32_t index) noexcept;
+  void ThreadLoop() noexcept;
+
+  TextureCache *textures_ = nullptr;
+  EventHandler *events_ = nullptr;
+  int64_t memory_limit_ = kDefMemoryLimit;
+  bool over_limit_ = false;
+
+  // Main thread only
+  /// Deque, so loader threads can keep pointers to slots while new ones are added
+  std::deque<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+  std::unordered_map<uint32_t, uint32_t> slot_by_hash_;
+  std::size_t pending_count_ = 0;
+  /// Swapped with decoded_, so memory is reused
+  std::vector<Slot*> finished_;
+
+  // Guarded by mutex_
+  std::deque<Slot*> requests_;
+  std::vector<Slot*> decoded_;
+  bool running_ = false;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<std::thread> threads_;
+};
+
+
+
+inline TextureHandle::TextureHandle(AssetLoader *loader, uint32_t slot) noexcept
+: loader_(loader)
+, slot_(slot)
+{
+  ++loader_->slots_[slot_].references;
+}
+
+inline TextureHandle::TextureHandle(const TextureHandle &other) noexcept
+: loader_(other.loader_)
+, slot_(other.slot_)
+{
+  if(loader_ != nullptr)
+    ++loader_->slots_[slot_].references;
+}
+
+inline TextureHandle::~TextureHandle() noexcept
+{
+  if(loader_ != nullptr && --loader_->slots_[slot_].references == 0)
+    loader_->ReleaseSlot(slot_);
+}
+
+inline auto TextureHandle::GetState() const noexcept -> AssetState
+{
+  GAME_ASSERT_STD(loader_ != nullptr, "Accessing empty texture handle");
+  return loader_->slots_[slot_].state;
+}
+
+inline auto TextureHandle::GetRegion() const noexcept -> const TextureRegion&
+{
+  GAME_ASSERT_STD(loader_ != nullptr, "Accessing empty texture handle");
+  return loader_->slots_[slot_].region;
+}
+
+inline auto TextureHandle::GetPathHash() const noexcept -> uint32_t
+{
+  GAME_ASSERT_STD(loader_ != nullptr, "Accessing empty texture handle");
+  return loader_->slots_[slot_].path_hash;
+}
+} // game
+
+#endif // GAME_ASSET_LOADER_HPP
@@ -3,10 +3,15 @@
 #include "Setup.hpp"
 
 #include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <thread>
+#include <limits>
 
 #include <SDL2/SDL.h>
 
 #include "Utils/Enum.hpp"
+#include "Utils/BinaryLog.hpp"
 
 
 namespace game
@@ -15,40 +20,315 @@ void EventHandler::DispatchEvent(const Event &event) noexcept
 {
   ZoneScopedC(0xe8bb25);
 
-  ZoneText(event.GetName().c_str(), event.GetName().size());
+  #ifdef TRACY_ENABLE
+  const std::string_view name = event.GetName();
+  ZoneText(name.data(), name.size());
+  #endif
+
+  ListenerList *list = FindListeners(event.GetType());
+  if(list == nullptr)
+    return;
+
+  ZoneValue(list->listeners.callbacks.size() - list->listeners.removed_count);
 
-  std::pair<MapType::const_iterator, MapType::const_iterator> range = listeners_.equal_range(event.GetType());
+  dispatch_depth_++;
+  CallListeners(*list, event);
+  dispatch_depth_--;
 
-  ZoneValue(std::distance(range.first, range.second));
+  CompactCallbacks(list->listeners);
+}
 
-  for(; range.first != range.second; ++range.first)
+void EventHandler::DispatchBatch(std::vector<Event> &events) noexcept
+{
+  ZoneScopedC(0xe8bb25);
+
+  ZoneValue(events.size());
+
+  // Stable so events of the same type keep their order
+  std::stable_sort(events.begin(), events.end(), [](const Event &lhs, const Event &rhs) { return ToUnderlying(lhs.GetType()) < ToUnderlying(rhs.GetType()); });
+
+  for(std::size_t first = 0; first < events.size();)
   {
-    // range.first = current listener
-    // range.first->second = value of listener
-    // range.first->second.first = data
-    // range.first->second.second = callback
-    if(!range.first->second.second(event, range.first->second.first))
+    const EventType type = events[first].GetType();
+    std::size_t last = first + 1;
+    while(last < events.size() && events[last].GetType() == type)
+      ++last;
+
+    ListenerList *list = FindListeners(type);
+    if(list != nullptr)
+      DispatchGroup(*list, events.data() + first, last - first);
+
+    first = last;
+  }
+}
+
+void EventHandler::DispatchGroup(ListenerList &list, const Event *events, std::size_t count) noexcept
+{
+  ZoneScopedC(0xe8bb25);
+
+  switch(list.coalesce_policy)
+  {
+  case CoalescePolicy::KeepFirst:
+    count = 1;
+    break;
+  case CoalescePolicy::KeepLast:
+    events += count - 1;
+    count = 1;
+    break;
+  case CoalescePolicy::None:
+    break;
+  }
+
+  ZoneValue(count);
+
+  dispatch_depth_++;
+
+  // Same as in CallListeners callbacks added during dispatch aren't called
+  const std::size_t batch_listener_count = list.batch_listeners.callbacks.size();
+  for(std::size_t i = 0; i < batch_listener_count; ++i)
+  {
+    const auto listener = list.batch_listeners.callbacks[i];
+    if(listener.second == nullptr)
+      continue;
+    if(!listener.second(events, count, listener.first))
+      break;
+  }
+
+  for(std::size_t i = 0; i < count; ++i)
+    CallListeners(list, events[i]);
+
+  dispatch_depth_--;
+
+  CompactCallbacks(list.listeners);
+  CompactCallbacks(list.batch_listeners);
+}
+
+void EventHandler::CallListeners(ListenerList &list, const Event &event) noexcept
+{
+  // Listeners added by callbacks are not called for the current event
+  // Vector can be reallocated by them, so listener is copied instead of referenced
+  const std::size_t count = list.listeners.callbacks.size();
+  for(std::size_t i = 0; i < count; ++i)
+  {
+    const ListenerType listener = list.listeners.callbacks[i];
+    if(listener.second == nullptr)
+      continue;
+    if(!listener.second(event, listener.first))
       break;
   }
 }
 
+void EventHandler::DispatchEnquedEvents() noexcept
+{
+  ZoneScopedC(0xe8bb25);
+
+  SwitchPayloadArena();
+
+  // Drain first so producers get free cells back as soon as possible
+  Event event;
+  while(queue_.TryPop(event))
+  {
+    if((ToUnderlying(event.GetType()) & Event::kCustomTypeBitMask) && event.custom.arena != nullptr)
+      event.custom.arena->popped_count_++;
+    dispatch_buffer_.push_back(event);
+  }
+
+  ZoneValue(dispatch_buffer_.size());
+
+  if(batched_)
+    DispatchBatch(dispatch_buffer_);
+  else
+  {
+    for(const Event &buffered_event : dispatch_buffer_)
+      DispatchEvent(buffered_event);
+  }
+  dispatch_buffer_.clear();
+
+  ResetInactivePayloadArena();
+
+  const uint64_t overflow_count = overflow_count_.load(std::memory_order_relaxed);
+  if(GAME_IS_UNLIKELY(overflow_count != reported_overflow_count_))
+  {
+    GAME_BLOG(LogType::Warning, "Event queue overflow: {} events were dropped (capacity: {})", overflow_count - reported_overflow_count_, queue_.GetCapacity());
+    reported_overflow_count_ = overflow_count;
+  }
+  TracyPlot("Dropped events", static_cast<int64_t>(overflow_count));
+}
+
+void EventHandler::SwitchPayloadArena() noexcept
+{
+  const uint32_t current = current_payload_arena_.load(std::memory_order_relaxed);
+  const uint32_t next = 1 - current;
+  if(payload_arenas_[next].GetUsed() != 0)
+    return;
+
+  current_payload_arena_.store(next);
+  // After it no one starts writing to previous arena, so all of it's events will be in queue
+  // Producers hold arena only for a single push, so it's short
+  while(payload_arenas_[current].writer_count_.load() != 0)
+    std::this_thread::yield();
+}
+
+void EventHandler::ResetInactivePayloadArena() noexcept
+{
+  EventPayloadArena &arena = payload_arenas_[1 - current_payload_arena_.load(std::memory_order_relaxed)];
+  if(arena.writer_count_.load(std::memory_order_acquire) != 0 || arena.popped_count_ != arena.pushed_count_.load(std::memory_order_relaxed))
+    return;
+
+  TracyPlot("Event payload bytes", static_cast<int64_t>(arena.GetUsed()));
+
+  arena.Reset();
+  arena.pushed_count_.store(0, std::memory_order_relaxed);
+  arena.popped_count_ = 0;
+}
+
 void EventHandler::ClearListeners(EventType type) noexcept
 {
-  std::pair<MapType::const_iterator, MapType::const_iterator> range = listeners_.equal_range(type);
-  listeners_.erase(range.first, range.second);
+  ListenerList *list = FindListeners(type);
+  if(list == nullptr)
+    return;
+
+  ClearCallbacks(list->listeners);
+  ClearCallbacks(list->batch_listeners);
+}
+
+void EventHandler::SetCoalescePolicy(EventType type, CoalescePolicy policy) noexcept
+{
+  GetOrCreateListeners(type).coalesce_policy = policy;
+}
+
+auto EventHandler::AddListener(EventCleaner &cleaner, EventType type, void *data, CallbackType callback) noexcept -> ListenerHandle
+{
+  ListenerList &list = GetOrCreateListeners(type);
+  const ListenerHandle handle = AddCallback(list, list.listeners, data, callback);
+  cleaner.AddHandle(handle);
+  return handle;
+}
+
+auto EventHandler::AddBatchListener(EventCleaner &cleaner, EventType type, void *data, BatchCallbackType callback) noexcept -> ListenerHandle
+{
+  ListenerList &list = GetOrCreateListeners(type);
+  const ListenerHandle handle = AddCallback(list, list.batch_listeners, data, callback);
+  cleaner.AddHandle(handle);
+  return handle;
+}
+
+template<typename Callback>
+auto EventHandler::AddCallback(ListenerList &list, CallbackList<Callback> &callbacks, void *data, Callback callback) noexcept -> ListenerHandle
+{
+  GAME_ASSERT(callback != nullptr) << "Listener callback can't be nullptr";
+
+  uint32_t index;
+  if(free_handle_slots_.empty())
+  {
+    index = static_cast<uint32_t>(handle_slots_.size());
+    handle_slots_.emplace_back();
+  }
+  else
+  {
+    index = free_handle_slots_.back();
+    free_handle_slots_.pop_back();
+  }
+
+  HandleSlot &slot = handle_slots_[index];
+  slot.list = &list;
+  slot.position = static_cast<uint32_t>(callbacks.callbacks.size());
+  slot.batch = std::is_same_v<Callback, BatchCallbackType>;
+
+  callbacks.callbacks.emplace_back(data, callback);
+  callbacks.handles.push_back(index);
+
+  return ListenerHandle{index, slot.generation};
+}
+
+void EventHandler::RemoveListener(ListenerHandle handle) noexcept
+{
+  if(handle.index >= handle_slots_.size())
+    return;
+  const HandleSlot &slot = handle_slots_[handle.index];
+  if(slot.generation != handle.generation || slot.list == nullptr)
+    return;
+
+  ListenerList &list = *slot.list;
+  const uint32_t position = slot.position;
+  const bool batch = slot.batch;
+  ReleaseHandle(handle.index);
+
+  if(batch)
+  {
+    list.batch_listeners.callbacks[position].second = nullptr;
+    list.batch_listeners.removed_count++;
+    CompactCallbacks(list.batch_listeners);
+  }
+  else
+  {
+    list.listeners.callbacks[position].second = nullptr;
+    list.listeners.removed_count++;
+    CompactCallbacks(list.listeners);
+  }
 }
 
-auto EventHandler::AddListener(EventCleaner &cleaner, EventType type, void *data, CallbackType callback) noexcept -> MapPtrType
+auto EventHandler::GetOrCreateListeners(EventType type) noexcept -> ListenerList&
 {
-  MapPtrType it = listeners_.insert(MapType::value_type(type, MapValueType(data, callback)));
-  cleaner.AddPtr(it);
-  return it;
+  if(GAME_IS_LIKELY(ToUnderlying(type) < kBuiltinEventTypeCount))
+    return builtin_listeners_[ToUnderlying(type)];
+  return custom_listeners_[type];
+}
+
+void EventHandler::ReleaseHandle(uint32_t index) noexcept
+{
+  HandleSlot &slot = handle_slots_[index];
+  slot.list = nullptr;
+  slot.generation++;
+  free_handle_slots_.push_back(index);
+}
+
+template<typename Callback>
+void EventHandler::ClearCallbacks(CallbackList<Callback> &callbacks) noexcept
+{
+  for(std::size_t i = 0; i < callbacks.callbacks.size(); ++i)
+  {
+    if(callbacks.callbacks[i].second == nullptr)
+      continue;
+    callbacks.callbacks[i].second = nullptr;
+    ReleaseHandle(callbacks.handles[i]);
+  }
+  callbacks.removed_count = callbacks.callbacks.size();
+
+  CompactCallbacks(callbacks);
+}
+
+template<typename Callback>
+void EventHandler::CompactCallbacks(CallbackList<Callback> &callbacks) noexcept
+{
+  // Few dead callbacks are cheaper to skip than to shift the whole list on each removal
+  if(dispatch_depth_ > 0 || callbacks.removed_count == 0 || callbacks.removed_count * 2 < callbacks.callbacks.size())
+    return;
+
+  ZoneScopedC(0xe8bb25);
+
+  std::size_t alive = 0;
+  for(std::size_t i = 0; i < callbacks.callbacks.size(); ++i)
+  {
+    if(callbacks.callbacks[i].second == nullptr)
+      continue;
+    callbacks.callbacks[alive] = callbacks.callbacks[i];
+    callbacks.handles[alive] = callbacks.handles[i];
+    handle_slots_[callbacks.handles[alive]].position = static_cast<uint32_t>(alive);
+    alive++;
+  }
+
+  callbacks.callbacks.resize(alive);
+  callbacks.handles.resize(alive);
+  callbacks.removed_count = 0;
 }
 
 void EventHandler::DispatchSDLEvents() noexcept
 {
   ZoneScopedC(0xe8bb25);
 
+  input_.BeginFrame();
+
   SDL_Event event;
   #ifndef TRACY_ENABLE
   while(SDL_PollEvent(&event))
@@ -64,40 +344,191 @@ void EventHandler::DispatchSDLEvents() noexcept
       ZoneValue(event.type);
     }
   #endif
-    switch(event.type)
+    TranslateSDLEvent(event);
+  }
+
+  if(batched_ && !sdl_batch_buffer_.empty())
+  {
+    DispatchBatch(sdl_batch_buffer_);
+    sdl_batch_buffer_.clear();
+  }
+}
+
+namespace
+{
+static_assert(InputState::kScancodeCount == SDL_NUM_SCANCODES, "Input state should fit all scancodes");
+
+constexpr inline auto ClampToInt16(int32_t value) noexcept -> int16_t
+{ return static_cast<int16_t>(std::clamp<int32_t>(value, std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max())); }
+
+/// Decode next codepoint from UTF-8 string
+/// Invalid sequences are decoded as U+FFFD
+/// return pointer past the decoded codepoint
+auto DecodeUTF8(const char *text, uint32_t *codepoint) noexcept -> const char*
+{
+  const unsigned char first = static_cast<unsigned char>(*text);
+  int length;
+  if(first < 0x80)
+  {
+    *codepoint = first;
+    return text + 1;
+  }
+  else if((first & 0xe0) == 0xc0)
+  {
+    *codepoint = first & 0x1f;
+    length = 2;
+  }
+  else if((first & 0xf0) == 0xe0)
+  {
+    *codepoint = first & 0x0f;
+    length = 3;
+  }
+  else if((first & 0xf8) == 0xf0)
+  {
+    *codepoint = first & 0x07;
+    length = 4;
+  }
+  else
+  {
+    *codepoint = 0xfffd;
+    return text + 1;
+  }
+
+  for(int i = 1; i < length; ++i)
+  {
+    const unsigned char next = static_cast<unsigned char>(text[i]);
+    if((next & 0xc0) != 0x80)
+    {
+      *codepoint = 0xfffd;
+      return text + i;
+    }
+    *codepoint = (*codepoint << 6) | (next & 0x3f);
+  }
+
+  return text + length;
+}
+} // namespace
+
+void EventHandler::TranslateSDLEvent(const SDL_Event &event) noexcept
+{
+  switch(event.type)
+  {
+  case SDL_QUIT:
+    DispatchOrBatch(Event{Event::Quit{}}, sdl_batch_buffer_);
+    break;
+  case SDL_KEYDOWN:
+  {
+    const Event::Keyboard keyboard{
+      static_cast<uint16_t>(event.key.keysym.sym),
+      static_cast<uint16_t>(event.key.keysym.scancode),
+      static_cast<uint16_t>(event.key.keysym.mod)
+    };
+    // Repeats come only while key is held, so they don't change state
+    if(event.key.repeat)
+      DispatchOrBatch(Event{Event::KeyPressed{keyboard}}, sdl_batch_buffer_);
+    else
+    {
+      input_.KeyDown(keyboard.scancode);
+      DispatchOrBatch(Event{Event::KeyDown{keyboard}}, sdl_batch_buffer_);
+    }
+    break;
+  }
+  case SDL_KEYUP:
+  {
+    const Event::Keyboard keyboard{
+      static_cast<uint16_t>(event.key.keysym.sym),
+      static_cast<uint16_t>(event.key.keysym.scancode),
+      static_cast<uint16_t>(event.key.keysym.mod)
+    };
+    input_.KeyUp(keyboard.scancode);
+    DispatchOrBatch(Event{Event::KeyUp{keyboard}}, sdl_batch_buffer_);
+    break;
+  }
+  case SDL_MOUSEMOTION:
+    input_.mouse_x_ = event.motion.x;
+    input_.mouse_y_ = event.motion.y;
+    input_.mouse_delta_x_ += event.motion.xrel;
+    input_.mouse_delta_y_ += event.motion.yrel;
+    DispatchOrBatch(Event{Event::MouseMove{Event::Mouse{event.motion.x, event.motion.y}, ClampToInt16(event.motion.xrel), ClampToInt16(event.motion.yrel)}}, sdl_batch_buffer_);
+    break;
+  case SDL_MOUSEBUTTONDOWN:
+    input_.mouse_x_ = event.button.x;
+    input_.mouse_y_ = event.button.y;
+    input_.MouseButtonDown(event.button.button);
+    DispatchOrBatch(Event{Event::MouseButtonDown{Event::MouseButton{Event::Mouse{event.button.x, event.button.y}, event.button.button, event.button.clicks}}}, sdl_batch_buffer_);
+    break;
+  case SDL_MOUSEBUTTONUP:
+    input_.mouse_x_ = event.button.x;
+    input_.mouse_y_ = event.button.y;
+    input_.MouseButtonUp(event.button.button);
+    DispatchOrBatch(Event{Event::MouseButtonUp{Event::MouseButton{Event::Mouse{event.button.x, event.button.y}, event.button.button, event.button.clicks}}}, sdl_batch_buffer_);
+    break;
+  case SDL_MOUSEWHEEL:
+  {
+    const float direction = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -1.0f : 1.0f;
+    const float x = static_cast<float>(event.wheel.x) * direction;
+    const float y = static_cast<float>(event.wheel.y) * direction;
+    input_.wheel_x_ += x;
+    input_.wheel_y_ += y;
+    DispatchOrBatch(Event{Event::MouseWheel{x, y}}, sdl_batch_buffer_);
+    break;
+  }
+  case SDL_TEXTINPUT:
+  {
+    uint32_t codepoint;
+    for(const char *text = event.text.text; *text != '\0';)
+    {
+      text = DecodeUTF8(text, &codepoint);
+      DispatchOrBatch(Event{Event::TextInput{codepoint}}, sdl_batch_buffer_);
+    }
+    break;
+  }
+  case SDL_WINDOWEVENT:
+    switch(event.window.event)
     {
-    case SDL_QUIT:
-      DispatchEvent(Event{Event::Quit{}});
+    case SDL_WINDOWEVENT_SIZE_CHANGED:
+      DispatchOrBatch(Event{Event::WindowResize{event.window.data1, event.window.data2}}, sdl_batch_buffer_);
+      break;
+    case SDL_WINDOWEVENT_FOCUS_GAINED:
+      input_.has_focus_ = true;
+      DispatchOrBatch(Event{Event::WindowFocusGained{}}, sdl_batch_buffer_);
       break;
-    case SDL_KEYDOWN:
-      DispatchEvent(Event{Event::KeyDown{Event::Keyboard{
-        static_cast<uint16_t>(event.key.keysym.sym),
-        static_cast<uint16_t>(event.key.keysym.scancode),
-        static_cast<uint16_t>(event.key.keysym.mod)
-      }}});
+    case SDL_WINDOWEVENT_FOCUS_LOST:
+      input_.LoseFocus();
+      DispatchOrBatch(Event{Event::WindowFocusLost{}}, sdl_batch_buffer_);
       break;
     default:
       break;
     }
+    break;
+  default:
+    break;
   }
 }
 
-auto Event::GetName() const noexcept -> std::string
+namespace
 {
-  switch(GetType())
-  {
-  case EventType::None:
-    return "None";
-  case EventType::Quit:
-    return "Quit";
-  case EventType::KeyDown:
-    return "Key Down";
-  case EventType::KeyUp:
-    return "Key Up";
-  case EventType::KeyPressed:
-    return "Key Pressed";
-  default:
-    return "Other: " + std::to_string(ToUnderlying(GetType()));
-  }
+auto GetEventTypeNameRegistry() noexcept -> std::unordered_map<EventType, std::string>&
+{
+  static std::unordered_map<EventType, std::string> registry;
+  return registry;
+}
+} // namespace
+
+void RegisterEventTypeName(EventType type, std::string_view name) noexcept
+{
+  GAME_ASSERT(ToUnderlying(type) >= kBuiltinEventTypeCount) << "Can't rename built-in event type: " << kBuiltinEventTypeNames[ToUnderlying(type)];
+
+  GetEventTypeNameRegistry()[type] = name;
+}
+
+auto GetEventTypeName(EventType type) noexcept -> std::string_view
+{
+  if(GAME_IS_LIKELY(ToUnderlying(type) < kBuiltinEventTypeCount))
+    return kBuiltinEventTypeNames[ToUnderlying(type)];
+
+  const std::unordered_map<EventType, std::string> &registry = GetEventTypeNameRegistry();
+  const auto it = registry.find(type);
+  return it == registry.end() ? kUnnamedEventTypeName : std::string_view{it->second};
 }
 }
\ No newline at end of file
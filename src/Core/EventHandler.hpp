@@ -3,16 +3,25 @@
 
 #include "Setup.hpp"
 
-#include <map>
-#include <set>
-#include <queue>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <climits>
 
 #include "Utils/Logger.hpp"
+#include "Utils/Enum.hpp"
+#include "Utils/MPSCQueue.hpp"
+#include "Core/EventPayloadArena.hpp"
+#include "Core/Input.hpp"
 
 
+union SDL_Event;
+
 namespace game
 {
 enum class EventType : uint32_t
@@ -21,20 +30,57 @@ enum class EventType : uint32_t
   KeyDown,
   KeyUp,
   KeyPressed,
-  Quit
+  Quit,
+  MouseMove,
+  MouseButtonDown,
+  MouseButtonUp,
+  MouseWheel,
+  TextInput,
+  WindowResize,
+  WindowFocusGained,
+  WindowFocusLost
+};
+
+/// Amount of built-in event types, they are looked up directly by value
+/// Should be updated when new built-in type is added
+constexpr inline std::size_t kBuiltinEventTypeCount = static_cast<std::size_t>(EventType::WindowFocusLost) + 1;
+
+/// Names of built-in event types indexed by type value
+constexpr inline std::array<std::string_view, kBuiltinEventTypeCount> kBuiltinEventTypeNames =
+{
+  "None", "Key Down", "Key Up", "Key Pressed", "Quit",
+  "Mouse Move", "Mouse Button Down", "Mouse Button Up", "Mouse Wheel", "Text Input",
+  "Window Resize", "Window Focus Gained", "Window Focus Lost"
 };
 
+/// Name that is used for types without built-in or registered name
+constexpr inline std::string_view kUnnamedEventTypeName = "Unnamed";
+
+/// Register name of custom event type, so it can be looked up without allocations
+/// Name is copied, registering name for the same type again replaces it
+/// Should be called from main thread, ideally on startup
+void RegisterEventTypeName(EventType type, std::string_view name) noexcept;
+/// Get name of built-in or registered event type
+/// If type has no name kUnnamedEventTypeName is returned
+/// Doesn't allocate
+[[nodiscard]] auto GetEventTypeName(EventType type) noexcept -> std::string_view;
+
+class EventHandler;
+
 union Event
 {
+  friend EventHandler;
 public:
   static constexpr inline std::underlying_type_t<EventType> kCustomTypeBitMask = std::underlying_type_t<EventType>{1} << (sizeof(EventType) * CHAR_BIT - 1);
 
-  
+  /// Event of EventType::None, used as placeholder
+  constexpr inline Event() noexcept : common{EventType::None} {}
+
   [[nodiscard]] constexpr inline auto GetType() const noexcept -> EventType { return common.type; }
   /// Get name of event according to type
-  /// If type is custom "Other: (type value)" is returned
+  /// If type is custom and it's name wasn't registered with RegisterEventTypeName kUnnamedEventTypeName is returned
   /// Mainly debuging feature
-  [[nodiscard]] auto GetName() const noexcept -> std::string;
+  [[nodiscard]] inline auto GetName() const noexcept -> std::string_view { return GetEventTypeName(GetType()); }
 	
 	[[nodiscard]] inline auto GetKeycode() const noexcept -> uint16_t
   { GAME_ASSERT_STD(common.type == EventType::KeyDown || common.type == EventType::KeyUp || common.type == EventType::KeyPressed, "Acces data from wrong event type. Expected: kKeyDown/kKeyUp/kKeyPressed"); return keyboard.keycode; }
@@ -42,8 +88,36 @@ public:
   { GAME_ASSERT_STD(common.type == EventType::KeyDown || common.type == EventType::KeyUp || common.type == EventType::KeyPressed, "Acces data from wrong event type. Expected: kKeyDown/kKeyUp/kKeyPressed"); return keyboard.scancode; }
 	[[nodiscard]] inline auto GetModKeys() const noexcept -> uint16_t
   { GAME_ASSERT_STD(common.type == EventType::KeyDown || common.type == EventType::KeyUp || common.type == EventType::KeyPressed, "Acces data from wrong event type. Expected: kKeyDown/kKeyUp/kKeyPressed"); return keyboard.mod_keys; }
-	[[nodiscard]] inline auto GetCustomData() const noexcept -> void*
-  { GAME_ASSERT_STD(common.type & kCustomTypeBitMask, "Acces data from wrong event type. Expected: to contain kCustomTypeBitMask"); return custom.data; }
+	[[nodiscard]] inline auto GetMouseX() const noexcept -> int32_t
+  { GAME_ASSERT_STD(common.type == EventType::MouseMove || common.type == EventType::MouseButtonDown || common.type == EventType::MouseButtonUp, "Acces data from wrong event type. Expected: kMouseMove/kMouseButtonDown/kMouseButtonUp"); return mouse.x; }
+	[[nodiscard]] inline auto GetMouseY() const noexcept -> int32_t
+  { GAME_ASSERT_STD(common.type == EventType::MouseMove || common.type == EventType::MouseButtonDown || common.type == EventType::MouseButtonUp, "Acces data from wrong event type. Expected: kMouseMove/kMouseButtonDown/kMouseButtonUp"); return mouse.y; }
+	[[nodiscard]] inline auto GetMouseDeltaX() const noexcept -> int16_t
+  { GAME_ASSERT_STD(common.type == EventType::MouseMove, "Acces data from wrong event type. Expected: kMouseMove"); return mouse_move.delta_x; }
+	[[nodiscard]] inline auto GetMouseDeltaY() const noexcept -> int16_t
+  { GAME_ASSERT_STD(common.type == EventType::MouseMove, "Acces data from wrong event type. Expected: kMouseMove"); return mouse_move.delta_y; }
+	[[nodiscard]] inline auto GetMouseButton() const noexcept -> uint8_t
+  { GAME_ASSERT_STD(common.type == EventType::MouseButtonDown || common.type == EventType::MouseButtonUp, "Acces data from wrong event type. Expected: kMouseButtonDown/kMouseButtonUp"); return mouse_button.button; }
+	[[nodiscard]] inline auto GetMouseClicks() const noexcept -> uint8_t
+  { GAME_ASSERT_STD(common.type == EventType::MouseButtonDown || common.type == EventType::MouseButtonUp, "Acces data from wrong event type. Expected: kMouseButtonDown/kMouseButtonUp"); return mouse_button.clicks; }
+	[[nodiscard]] inline auto GetWheelX() const noexcept -> float
+  { GAME_ASSERT_STD(common.type == EventType::MouseWheel, "Acces data from wrong event type. Expected: kMouseWheel"); return mouse_wheel.x; }
+	[[nodiscard]] inline auto GetWheelY() const noexcept -> float
+  { GAME_ASSERT_STD(common.type == EventType::MouseWheel, "Acces data from wrong event type. Expected: kMouseWheel"); return mouse_wheel.y; }
+	[[nodiscard]] inline auto GetCodepoint() const noexcept -> uint32_t
+  { GAME_ASSERT_STD(common.type == EventType::TextInput, "Acces data from wrong event type. Expected: kTextInput"); return text_input.codepoint; }
+	[[nodiscard]] inline auto GetWindowWidth() const noexcept -> int32_t
+  { GAME_ASSERT_STD(common.type == EventType::WindowResize, "Acces data from wrong event type. Expected: kWindowResize"); return window_resize.width; }
+	[[nodiscard]] inline auto GetWindowHeight() const noexcept -> int32_t
+  { GAME_ASSERT_STD(common.type == EventType::WindowResize, "Acces data from wrong event type. Expected: kWindowResize"); return window_resize.height; }
+	[[nodiscard]] inline auto HasCustomData() const noexcept -> bool
+  { GAME_ASSERT_STD(common.type & kCustomTypeBitMask, "Acces data from wrong event type. Expected: to contain kCustomTypeBitMask"); return custom.arena != nullptr; }
+  /// Get payload of event enqued with EventHandler::EnqueCustomEvent
+  /// Reference is valid only while event is being dispatched
+  /// In debug builds T is checked to be the type payload was constructed with
+  template<typename T>
+	[[nodiscard]] inline auto GetCustomData() const noexcept -> const T&
+  { GAME_ASSERT_STD(HasCustomData(), "Custom event has no payload"); return custom.arena->Get<T>(custom.offset); }
 
 
   struct Common
@@ -94,14 +168,102 @@ public:
 		explicit constexpr inline Quit() noexcept : Common(EventType::Quit) {}
 	};
 	inline Event(const Quit &quit_data) noexcept : quit{quit_data} {}
+
+
+  /// Mouse position relative to window
+  struct Mouse
+  {
+    constexpr inline Mouse(int32_t x_data, int32_t y_data) noexcept : x{x_data}, y{y_data} {}
+    int32_t x;
+    int32_t y;
+  };
+
+
+  struct MouseMove : Common, Mouse
+  {
+    /// Delta is clamped to int16_t so event stays small
+    constexpr inline MouseMove(const Mouse &mouse_data, int16_t delta_x_data, int16_t delta_y_data) noexcept : Common{EventType::MouseMove}, Mouse{mouse_data}, delta_x{delta_x_data}, delta_y{delta_y_data} {}
+    int16_t delta_x;
+    int16_t delta_y;
+  };
+  constexpr inline Event(const MouseMove &mouse_move_data) noexcept : mouse_move{mouse_move_data} {}
+
+
+  struct MouseButton : Mouse
+  {
+    constexpr inline MouseButton(const Mouse &mouse_data, uint8_t button_data, uint8_t clicks_data) noexcept : Mouse{mouse_data}, button{button_data}, clicks{clicks_data} {}
+    /// SDL button index
+    uint8_t button;
+    uint8_t clicks;
+    uint16_t padding = 0;
+  };
+
+
+  struct MouseButtonDown : Common, MouseButton
+  {
+    explicit constexpr inline MouseButtonDown(const MouseButton &mouse_button_data) noexcept : Common{EventType::MouseButtonDown}, MouseButton{mouse_button_data} {}
+  };
+  constexpr inline Event(const MouseButtonDown &mouse_button_down_data) noexcept : mouse_button_down{mouse_button_down_data} {}
+
+
+  struct MouseButtonUp : Common, MouseButton
+  {
+    explicit constexpr inline MouseButtonUp(const MouseButton &mouse_button_data) noexcept : Common{EventType::MouseButtonUp}, MouseButton{mouse_button_data} {}
+  };
+  constexpr inline Event(const MouseButtonUp &mouse_button_up_data) noexcept : mouse_button_up{mouse_button_up_data} {}
+
+
+  struct MouseWheel : Common
+  {
+    constexpr inline MouseWheel(float x_data, float y_data) noexcept : Common{EventType::MouseWheel}, x{x_data}, y{y_data} {}
+    float x;
+    float y;
+  };
+  constexpr inline Event(const MouseWheel &mouse_wheel_data) noexcept : mouse_wheel{mouse_wheel_data} {}
+
+
+  /// One event is sent for each unicode codepoint of typed text
+  struct TextInput : Common
+  {
+    explicit constexpr inline TextInput(uint32_t codepoint_data) noexcept : Common{EventType::TextInput}, codepoint{codepoint_data} {}
+    uint32_t codepoint;
+  };
+  constexpr inline Event(const TextInput &text_input_data) noexcept : text_input{text_input_data} {}
+
+
+  struct WindowResize : Common
+  {
+    constexpr inline WindowResize(int32_t width_data, int32_t height_data) noexcept : Common{EventType::WindowResize}, width{width_data}, height{height_data} {}
+    int32_t width;
+    int32_t height;
+  };
+  constexpr inline Event(const WindowResize &window_resize_data) noexcept : window_resize{window_resize_data} {}
+
+
+  struct WindowFocusGained : Common
+  {
+    explicit constexpr inline WindowFocusGained() noexcept : Common{EventType::WindowFocusGained} {}
+  };
+  constexpr inline Event(const WindowFocusGained &window_focus_gained_data) noexcept : window_focus_gained{window_focus_gained_data} {}
+
+
+  struct WindowFocusLost : Common
+  {
+    explicit constexpr inline WindowFocusLost() noexcept : Common{EventType::WindowFocusLost} {}
+  };
+  constexpr inline Event(const WindowFocusLost &window_focus_lost_data) noexcept : window_focus_lost{window_focus_lost_data} {}
 	
 
 	/// Custom type should specify it's type for listeners and it's last bit should be 1 or contain just use kCustomTypeBitMask
+  /// Events with payload are created with EventHandler::EnqueCustomEvent
 	struct Custom : Common
 	{
-    explicit constexpr inline Custom(EventType custom_type, void *data_data) noexcept : Common(custom_type), data(data_data)
+    explicit constexpr inline Custom(EventType custom_type) noexcept : Custom(custom_type, nullptr, 0) {}
+    constexpr inline Custom(EventType custom_type, const EventPayloadArena *arena_data, uint32_t offset_data) noexcept : Common(custom_type), offset(offset_data), arena(arena_data)
     { GAME_ASSERT_STD(custom_type & kCustomTypeBitMask, "Custom type's should contain kCustomTypeBitMask"); }
-		void *data;
+    // Offset goes first to fill padding after type
+    uint32_t offset;
+		const EventPayloadArena *arena;
 	};
 	inline Event(const Custom &custom_data) noexcept : custom{custom_data} {}
 
@@ -110,6 +272,10 @@ public:
 private:
   struct CommonKeyboard : Common, Keyboard
   {};
+  struct CommonMouse : Common, Mouse
+  {};
+  struct CommonMouseButton : Common, MouseButton
+  {};
 
   Common common;
   CommonKeyboard keyboard;
@@ -117,9 +283,21 @@ private:
 	KeyUp key_up;
 	KeyPressed key_pressed;
 	Quit quit;
+  CommonMouse mouse;
+  MouseMove mouse_move;
+  MouseButtonDown mouse_button_down;
+  MouseButtonUp mouse_button_up;
+  CommonMouseButton mouse_button;
+  MouseWheel mouse_wheel;
+  TextInput text_input;
+  WindowResize window_resize;
+  WindowFocusGained window_focus_gained;
+  WindowFocusLost window_focus_lost;
 	Custom custom;
 };
 
+static_assert(sizeof(Event) <= 16, "Events are copied through queues and batches, so they should stay small");
+
 
 
 class EventCleaner;
@@ -129,33 +307,165 @@ class EventHandler
   friend EventCleaner;
 public:
   using CallbackType = bool(*)(const Event &, void *data);
-  using MapValueType = std::pair<void*, CallbackType>;
-  using MapType = std::multimap<EventType, MapValueType>;
-  using MapPtrType = MapType::iterator;
-  using QueueType = std::queue<Event>;
+  /// Receives all events of one type from a batch at once
+  using BatchCallbackType = bool(*)(const Event *events, std::size_t count, void *data);
+  using ListenerType = std::pair<void*, CallbackType>;
+  using QueueType = MPSCQueue<Event>;
+
+  /// Maximum amount of enqueued events between two DispatchEnquedEvents calls
+  static constexpr inline std::size_t kDefQueueCapacity = 4096;
+  /// Size in bytes of each of two custom event payload arenas
+  static constexpr inline std::size_t kDefPayloadArenaCapacity = 1 << 20;
+
+  /// What is left of several events of the same type in one batch
+  enum class CoalescePolicy : uint8_t
+  {
+    None, KeepFirst, KeepLast
+  };
+
+  /// Handle to added listener
+  /// Stays valid until listener is removed, removing listener with stale handle does nothing
+  struct ListenerHandle
+  {
+    uint32_t index;
+    uint32_t generation;
+
+    [[nodiscard]] friend constexpr inline auto operator==(ListenerHandle lhs, ListenerHandle rhs) noexcept -> bool { return lhs.index == rhs.index && lhs.generation == rhs.generation; }
+    [[nodiscard]] friend constexpr inline auto operator!=(ListenerHandle lhs, ListenerHandle rhs) noexcept -> bool { return !(lhs == rhs); }
+  };
+
 
+  /// queue_capacity should be power of 2
+  explicit EventHandler(std::size_t queue_capacity = kDefQueueCapacity, std::size_t payload_arena_capacity = kDefPayloadArenaCapacity) noexcept
+    : queue_{queue_capacity}, payload_arenas_{{EventPayloadArena{payload_arena_capacity}, EventPayloadArena{payload_arena_capacity}}} {}
+  // Handles keep pointers to listener lists, so handler can't be moved or copied
+  EventHandler(const EventHandler &) = delete;
+  EventHandler &operator=(const EventHandler &) = delete;
 
   /// Add to type event listener that will be trigered when event fires
   /// First in is first to be called when event happens 
-  auto AddListener(EventCleaner &cleaner, EventType type, void *data, CallbackType callback) noexcept -> MapPtrType;
-  inline void RemoveListener(EventCleaner &cleaner, MapPtrType ptr) noexcept;
+  auto AddListener(EventCleaner &cleaner, EventType type, void *data, CallbackType callback) noexcept -> ListenerHandle;
+  /// Add to type listener that receives all events of that type from a batch in a single call
+  /// Called only in batched mode, before listeners added with AddListener
+  /// Returning false stops only other batch listeners from being called
+  auto AddBatchListener(EventCleaner &cleaner, EventType type, void *data, BatchCallbackType callback) noexcept -> ListenerHandle;
+  inline void RemoveListener(EventCleaner &cleaner, ListenerHandle handle) noexcept;
   /// Remove all listeners of specified type
   void ClearListeners(EventType type) noexcept;
+
+  /// In batched mode DispatchSDLEvents and DispatchEnquedEvents first collect all events and then dispatch them grouped by type
+  /// Order of events of different types isn't kept then
+  /// Default value is false
+  constexpr inline void SetBatched(bool batched) noexcept { batched_ = batched; }
+  [[nodiscard]] constexpr inline auto IsBatched() const noexcept -> bool { return batched_; }
+  /// Set what is left of several events of type in one batch, has effect only in batched mode
+  /// Default value is CoalescePolicy::None
+  void SetCoalescePolicy(EventType type, CoalescePolicy policy) noexcept;
  
   /// Instantly dispatch event
   void DispatchEvent(const Event &event) noexcept;
+  /// Instantly dispatch events grouped by type
+  /// events are sorted by type in place, coalescing only skips some of them while dispatching, so none are removed
+  void DispatchBatch(std::vector<Event> &events) noexcept;
   /// Poll and dispatch al current SDL events
+  /// Also updates input state snapshot
   void DispatchSDLEvents() noexcept;
-  inline void EnqueEvent(const Event &event) noexcept { queue_.push(event); }
-  inline void DispatchEnquedEvents() noexcept { ZoneScopedC(0xe8bb25); while(queue_.size()) { DispatchEvent(queue_.front()); queue_.pop(); } }
+  /// Keyboard and mouse state after the last DispatchSDLEvents
+  [[nodiscard]] constexpr inline auto GetInput() const noexcept -> const InputState& { return input_; }
+  /// Enque event to be dispatched on the next DispatchEnquedEvents call
+  /// Lock-free and can be called from any thread
+  /// return false if queue is full, event is dropped and counted in overflow counter then
+  inline auto EnqueEvent(const Event &event) noexcept -> bool;
+  /// Construct payload of type T in handler's arena and enque custom event that references it
+  /// Payload lives until the end of DispatchEnquedEvents call that dispatches the event, it's destructor is never called
+  /// Lock-free and can be called from any thread
+  /// return false if queue or arena is full, event is dropped and counted in overflow counter then
+  template<typename T, typename... Args>
+  inline auto EnqueCustomEvent(EventType type, Args &&...args) noexcept -> bool;
+  /// Dispatch all events that were enqued before the call
+  /// Events enqued by listeners during it will be dispatched on the next call
+  /// Should be called only from main thread
+  void DispatchEnquedEvents() noexcept;
+  /// Total amount of events dropped because queue was full
+  [[nodiscard]] inline auto GetOverflowCount() const noexcept -> uint64_t { return overflow_count_.load(std::memory_order_relaxed); }
 
 
 private:
-  /// Used in event cleaner to directly remove listener when EventCleaner is destroyed
-  inline void RemoveListener(MapPtrType ptr) noexcept { listeners_.erase(ptr); }  
+  /// Contiguous callbacks in order they were added
+  /// Removed callbacks are left as nullptr until list is compacted, so removal never shifts elements under running dispatch
+  template<typename Callback>
+  struct CallbackList
+  {
+    std::vector<std::pair<void*, Callback>> callbacks;
+    /// Index of handle slot for callback with the same index
+    std::vector<uint32_t> handles;
+    std::size_t removed_count = 0;
+  };
+
+  /// Everything registered for a single event type
+  struct ListenerList
+  {
+    CallbackList<CallbackType> listeners;
+    CallbackList<BatchCallbackType> batch_listeners;
+    CoalescePolicy coalesce_policy = CoalescePolicy::None;
+  };
+
+  struct HandleSlot
+  {
+    ListenerList *list = nullptr;
+    uint32_t position = 0;
+    uint32_t generation = 0;
+    bool batch = false;
+  };
 
+  /// Used in event cleaner to directly remove listener when EventCleaner is destroyed
+  void RemoveListener(ListenerHandle handle) noexcept;
+
+  /// Built-in types are indexed directly, others are hashed
+  /// return nullptr if there never were listeners of that type
+  [[nodiscard]] inline auto FindListeners(EventType type) noexcept -> ListenerList*;
+  [[nodiscard]] auto GetOrCreateListeners(EventType type) noexcept -> ListenerList&;
+  template<typename Callback>
+  auto AddCallback(ListenerList &list, CallbackList<Callback> &callbacks, void *data, Callback callback) noexcept -> ListenerHandle;
+  void ReleaseHandle(uint32_t index) noexcept;
+  template<typename Callback>
+  void ClearCallbacks(CallbackList<Callback> &callbacks) noexcept;
+  /// Remove dead callbacks if there are enough of them and no dispatch is running
+  template<typename Callback>
+  void CompactCallbacks(CallbackList<Callback> &callbacks) noexcept;
+  /// Call listeners until one of them returns false
+  void CallListeners(ListenerList &list, const Event &event) noexcept;
+  /// Dispatch group of events of the same type
+  void DispatchGroup(ListenerList &list, const Event *events, std::size_t count) noexcept;
+  /// Dispatch event instantly or add it to batch in batched mode
+  inline void DispatchOrBatch(const Event &event, std::vector<Event> &batch) noexcept { if(batched_) batch.push_back(event); else DispatchEvent(event); }
+
+  /// Producers construct payloads in current arena, while the other one waits for it's events to be dispatched and reset
+  /// Arenas are switched in DispatchEnquedEvents when the other one is empty
+  void SwitchPayloadArena() noexcept;
+  void ResetInactivePayloadArena() noexcept;
+
+  /// Translate SDL event and dispatch or batch it
+  void TranslateSDLEvent(const SDL_Event &event) noexcept;
+
+  InputState input_;
   QueueType queue_;
-  MapType listeners_;
+  std::array<EventPayloadArena, 2> payload_arenas_;
+  std::atomic<uint32_t> current_payload_arena_{0};
+  std::atomic<uint64_t> overflow_count_{0};
+  uint64_t reported_overflow_count_ = 0;
+  // Reused between DispatchEnquedEvents calls to not allocate every frame
+  std::vector<Event> dispatch_buffer_;
+  // Reused between DispatchSDLEvents calls in batched mode
+  std::vector<Event> sdl_batch_buffer_;
+  bool batched_ = false;
+  std::array<ListenerList, kBuiltinEventTypeCount> builtin_listeners_;
+  // Node based container is used so pointers to lists stay valid on rehash
+  std::unordered_map<EventType, ListenerList> custom_listeners_;
+  std::vector<HandleSlot> handle_slots_;
+  std::vector<uint32_t> free_handle_slots_;
+  // Compaction is postponed while greater than 0 so listeners can safely add and remove listeners from callbacks
+  int dispatch_depth_ = 0;
 };
 
 
@@ -167,23 +477,70 @@ class EventCleaner
   friend EventHandler;
 public:
   inline EventCleaner(EventHandler &events) noexcept : events_{events} {}
-  inline ~EventCleaner() noexcept { ZoneScopedC(0xe8bb25); for(auto ptr : ptrs_) events_.RemoveListener(ptr); }
+  inline ~EventCleaner() noexcept { ZoneScopedC(0xe8bb25); for(auto handle : handles_) events_.RemoveListener(handle); }
 
-  /// Add ptr (you can get it when adding listener in EventHandler) to EventClener that will be removed from EventHandler on the destruction
-  inline void AddPtr(EventHandler::MapPtrType ptr) noexcept { ptrs_.push_back(ptr); }
-  /// Remove ptr (you can get it when adding listener in EventHandler) from EventCleaner to not remove it on the destruction of a cleaner
-  inline void RemovePtr(EventHandler::MapPtrType ptr) noexcept { std::swap(ptrs_.back(), *std::find(ptrs_.begin(), ptrs_.end(), ptr)); ptrs_.pop_back(); }
-  /// Remove all ptrs from cleaner so they won't be removed on destruction of EventCleaner
-  inline void ClearPtrs() noexcept { ptrs_.clear(); }
+  /// Add handle (you can get it when adding listener in EventHandler) to EventClener that will be removed from EventHandler on the destruction
+  inline void AddHandle(EventHandler::ListenerHandle handle) noexcept { handles_.push_back(handle); }
+  /// Remove handle (you can get it when adding listener in EventHandler) from EventCleaner to not remove it on the destruction of a cleaner
+  inline void RemoveHandle(EventHandler::ListenerHandle handle) noexcept { std::swap(handles_.back(), *std::find(handles_.begin(), handles_.end(), handle)); handles_.pop_back(); }
+  /// Remove all handles from cleaner so they won't be removed on destruction of EventCleaner
+  inline void ClearHandles() noexcept { handles_.clear(); }
 
 private:
   EventHandler &events_;
-  std::vector<EventHandler::MapPtrType> ptrs_;
+  std::vector<EventHandler::ListenerHandle> handles_;
 };
 
 
 
-inline void EventHandler::RemoveListener(EventCleaner &cleaner, MapPtrType ptr) noexcept { listeners_.erase(ptr); cleaner.RemovePtr(ptr); }
+inline void EventHandler::RemoveListener(EventCleaner &cleaner, ListenerHandle handle) noexcept { RemoveListener(handle); cleaner.RemoveHandle(handle); }
+
+inline auto EventHandler::EnqueEvent(const Event &event) noexcept -> bool
+{
+  if(GAME_IS_LIKELY(queue_.TryPush(event)))
+    return true;
+
+  overflow_count_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+template<typename T, typename... Args>
+inline auto EventHandler::EnqueCustomEvent(EventType type, Args &&...args) noexcept -> bool
+{
+  // Writer is registered before arena is checked again, so either SwitchPayloadArena waits for it or it sees the switch and retries
+  EventPayloadArena *arena;
+  while(true)
+  {
+    arena = &payload_arenas_[current_payload_arena_.load()];
+    arena->writer_count_.fetch_add(1);
+    if(GAME_IS_LIKELY(arena == &payload_arenas_[current_payload_arena_.load()]))
+      break;
+    arena->writer_count_.fetch_sub(1, std::memory_order_release);
+  }
+
+  bool pushed = false;
+  const uint32_t offset = arena->Construct<T>(std::forward<Args>(args)...);
+  if(GAME_IS_LIKELY(offset != EventPayloadArena::kInvalidOffset))
+  {
+    pushed = queue_.TryPush(Event{Event::Custom{type, arena, offset}});
+    if(GAME_IS_LIKELY(pushed))
+      arena->pushed_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if(GAME_IS_UNLIKELY(!pushed))
+    overflow_count_.fetch_add(1, std::memory_order_relaxed);
+
+  arena->writer_count_.fetch_sub(1, std::memory_order_release);
+  return pushed;
+}
+
+inline auto EventHandler::FindListeners(EventType type) noexcept -> ListenerList*
+{
+  if(GAME_IS_LIKELY(ToUnderlying(type) < kBuiltinEventTypeCount))
+    return &builtin_listeners_[ToUnderlying(type)];
+
+  const auto it = custom_listeners_.find(type);
+  return it == custom_listeners_.end() ? nullptr : &it->second;
+}
 } // game
 
 #endif // GAME_EVENT_HANDLER_HPP
\ No newline at end of file
@@ -0,0 +1,130 @@
+#ifndef GAME_EVENT_PAYLOAD_ARENA_HPP
+#define GAME_EVENT_PAYLOAD_ARENA_HPP
+
+#include "Setup.hpp"
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include "Utils/Logger.hpp"
+#include "Utils/Hash.hpp"
+
+
+namespace game
+{
+class EventHandler;
+
+/// Linear arena that holds payloads of custom events
+///
+/// Payloads are placement constructed by any thread and referenced by offset from the start of arena
+/// Arena is reset all at once without calling destructors, so payloads should be trivially destructible
+/// In debug builds each payload is prefixed with hash of it's type to check accesses
+class EventPayloadArena
+{
+  friend EventHandler;
+public:
+  static constexpr inline uint32_t kInvalidOffset = ~uint32_t{0};
+  /// Every payload is aligned to it
+  static constexpr inline std::size_t kAlignment = 16;
+
+  explicit EventPayloadArena(std::size_t capacity) noexcept;
+  EventPayloadArena(const EventPayloadArena &) = delete;
+  EventPayloadArena &operator=(const EventPayloadArena &) = delete;
+
+  /// Construct payload of type T, thread safe
+  /// return offset of payload or kInvalidOffset if arena is full
+  template<typename T, typename... Args>
+  [[nodiscard]] inline auto Construct(Args &&...args) noexcept -> uint32_t;
+  /// Get payload constructed with Construct
+  template<typename T>
+  [[nodiscard]] inline auto Get(uint32_t offset) const noexcept -> const T&;
+
+  /// Release all payloads at once
+  /// Shouldn't be called while other threads construct payloads or payloads are accessed
+  inline void Reset() noexcept { used_.store(0, std::memory_order_relaxed); }
+
+  [[nodiscard]] constexpr inline auto GetCapacity() const noexcept -> std::size_t { return capacity_; }
+  /// Might be greater than capacity after failed Construct
+  [[nodiscard]] inline auto GetUsed() const noexcept -> std::size_t { return used_.load(std::memory_order_relaxed); }
+
+private:
+  struct alignas(kAlignment) Block
+  {
+    std::byte data[kAlignment];
+  };
+
+  #ifndef NDEBUG
+  struct alignas(kAlignment) Header
+  {
+    std::size_t type_hash;
+  };
+  static constexpr inline std::size_t kHeaderSize = sizeof(Header);
+  #else
+  static constexpr inline std::size_t kHeaderSize = 0;
+  #endif
+
+  template<typename T>
+  static constexpr inline std::size_t kAllocationSize = (kHeaderSize + sizeof(T) + kAlignment - 1) / kAlignment * kAlignment;
+
+  const std::size_t capacity_;
+  std::unique_ptr<Block[]> memory_;
+  std::atomic<std::size_t> used_{0};
+
+  // Used by EventHandler to know when arena can be reset
+  /// Amount of producers that are writing to the arena right now
+  std::atomic<uint32_t> writer_count_{0};
+  /// Amount of events that reference the arena and were pushed in queue
+  std::atomic<uint64_t> pushed_count_{0};
+  /// Amount of events that reference the arena and were taken from queue
+  /// Mutable, because it is counted through const pointer that event holds
+  mutable uint64_t popped_count_ = 0;
+};
+
+
+
+inline EventPayloadArena::EventPayloadArena(std::size_t capacity) noexcept
+: capacity_((capacity + kAlignment - 1) / kAlignment * kAlignment)
+, memory_(new Block[capacity_ / kAlignment])
+{
+  GAME_ASSERT(capacity_ < kInvalidOffset) << "Event payload arena capacity should fit in offset: " << capacity;
+}
+
+template<typename T, typename... Args>
+inline auto EventPayloadArena::Construct(Args &&...args) noexcept -> uint32_t
+{
+  static_assert(std::is_trivially_destructible_v<T>, "Payload destructor is never called");
+  static_assert(alignof(T) <= kAlignment, "Payload is overaligned");
+
+  const std::size_t offset = used_.fetch_add(kAllocationSize<T>, std::memory_order_relaxed);
+  if(GAME_IS_UNLIKELY(offset + kAllocationSize<T> > capacity_))
+    return kInvalidOffset;
+
+  std::byte *allocation = reinterpret_cast<std::byte*>(memory_.get()) + offset;
+  #ifndef NDEBUG
+  constexpr std::size_t kTypeHash = HeshType<T>();
+  new(allocation) Header{kTypeHash};
+  #endif
+  new(allocation + kHeaderSize) T(std::forward<Args>(args)...);
+
+  return static_cast<uint32_t>(offset);
+}
+
+template<typename T>
+inline auto EventPayloadArena::Get(uint32_t offset) const noexcept -> const T&
+{
+  GAME_ASSERT_STD(offset + kAllocationSize<T> <= capacity_, "Event payload offset is out of arena");
+
+  const std::byte *allocation = reinterpret_cast<const std::byte*>(memory_.get()) + offset;
+  #ifndef NDEBUG
+  constexpr std::size_t kTypeHash = HeshType<T>();
+  GAME_ASSERT_STD(std::launder(reinterpret_cast<const Header*>(allocation))->type_hash == kTypeHash, "Event payload is accessed with wrong type");
+  #endif
+  return *std::launder(reinterpret_cast<const T*>(allocation + kHeaderSize));
+}
+} // game
+
+#endif // GAME_EVENT_PAYLOAD_ARENA_HPP
@@ -2,6 +2,11 @@
 
 #include "Setup.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
 #include <SDL2/SDL_keycode.h>
 
 #include "Utils/Logger.hpp"
@@ -9,22 +14,44 @@
 #include "Core/Renderer.hpp"
 #include "Core/Window.hpp"
 #include "Core/EventHandler.hpp"
+#include "Core/GameLoop.hpp"
 #include "Utils/Logger.hpp"
+#include "Utils/Time.hpp"
+#include "Platform/CrashHandler.hpp"
 
 
 namespace game
 {
 Game::Game(const int argc, const char * const *argv) noexcept
-: running_(([]{
-    
+: start_time_(ClockType::now())
+, running_(([]{
+    // Only the game archives and prunes its logs, tools and tests just overwrite theirs
+    Logger::EnableArchive();
   }(), false)) // pre initialization functions
 , flags_(argc, argv) // args are UTF8 encoded because we use SDL2main
 , event_cleaner_(events_)
-, renderer_(Renderer::CreateRenderer())
+, renderer_(Renderer::CreateRenderer(flags_))
 , window_(*this)
+, timestep_(flags_.GetPositiveNumber("-tick-rate", FixedTimestep::kDefTickRate))
+, max_ticks_(static_cast<uint64_t>(flags_.GetPositiveNumber("-max-ticks", 0.0)))
 {
   ZoneScopedC(0xb3041b);
 
+  // Logger creates log directory, crash file is written next to log
+  (void)Logger::Get();
+  if(!InstallCrashHandler((Logger::kDefLogPath / Logger::kDefCrashFileName).string()))
+    GAME_LOG(LogType::Warning) << "Couldn't install crash handler";
+  if(flags_.Contains("-log-level") && !Logger::SetModuleTypes(flags_.Get("-log-level")))
+    GAME_LOG(LogType::Warning) << "Unknown module or log type in -log-level=" << flags_.Get("-log-level");
+  if(flags_.Contains("-binlog"))
+    Logger::Get().SetBinaryOutput(true);
+  LogRotationPolicy rotation;
+  // Size is in MiB like -texture-memory
+  rotation.size = static_cast<std::size_t>(flags_.GetPositiveNumber("-log-size", static_cast<double>(rotation.size >> 20)) * static_cast<double>(1 << 20));
+  rotation.interval = std::chrono::minutes(static_cast<int64_t>(flags_.GetPositiveNumber("-log-interval", 0.0)));
+  rotation.file_count = static_cast<std::size_t>(flags_.GetPositiveNumber("-log-files", static_cast<double>(rotation.file_count)));
+  Logger::Get().SetRotationPolicy(rotation);
+
   #if defined(GAME_WIN_OS)
     GAME_LOG(LogType::Info) << "OS: Windows";
   #elif defined(GAME_LINUX_OS)
@@ -33,7 +60,34 @@ Game::Game(const int argc, const char * const *argv) noexcept
     GAME_LOG(LogType::Info) << "OS: Mac OS X";
   #endif
 
+  if(IsHeadless())
+    GAME_LOG(LogType::Info) << "Running headless";
+
+  // Uncapped loop burns whole core and GPU on frames display can't show
+  // Headless game shows nothing, so it runs at full speed unless cap is given explicitly
+  if(!flags_.Contains("-no-fps-cap") && (!IsHeadless() || flags_.Contains("-fps-cap")))
+  {
+    const int refresh_rate = window_.GetRefreshRate();
+    const double frame_rate_cap = flags_.GetPositiveNumber("-fps-cap", refresh_rate > 0 ? static_cast<double>(refresh_rate) : kDefFrameRateCap);
+    min_frame_time_ = 1.0 / frame_rate_cap;
+    GAME_LOG(LogType::Info) << "Frame rate cap: " << frame_rate_cap;
+  }
+
+  jobs_.Init(static_cast<std::size_t>(flags_.GetPositiveNumber("-workers", 0.0)));
+
+  const std::string archive_path = flags_.Contains("-archive") ? flags_.Get("-archive") : kDefArchivePath;
+  if(archive_.Open(archive_path))
+    renderer_.GetTextureCache().SetArchive(&archive_);
+  else
+    GAME_LOG(LogType::Info) << "Archive " << archive_path << " isn't available, assets are read from files";
+
   renderer_.Init(*this);
+  assets_.Init(renderer_.GetTextureCache(), events_,
+    static_cast<std::size_t>(flags_.GetPositiveNumber("-loader-threads", static_cast<double>(AssetLoader::kDefThreadCount))),
+    static_cast<int64_t>(flags_.GetPositiveNumber("-texture-memory", static_cast<double>(AssetLoader::kDefMemoryLimit >> 20))) << 20);
+
+  if(flags_.Contains("-hot-reload"))
+    StartHotReload();
 
   events_.AddListener(event_cleaner_, EventType::Quit, this,
     [](__attribute__((unused)) const Event &event, void *data) -> bool
@@ -49,6 +103,33 @@ Game::Game(const int argc, const char * const *argv) noexcept
       reinterpret_cast<Game*>(data)->QuitEvent();
       return true;
     });
+
+  GAME_LOG(LogType::Info) << "Startup took " << SecondsType(ClockType::now() - start_time_).count() * 1000.0 << " ms";
+}
+
+void Game::StartHotReload() noexcept
+{
+  ZoneScopedC(0xb3041b);
+
+  std::vector<std::string> directories;
+  for(auto [it, end] = flags_.GetRange("-hot-reload"); it != end; ++it)
+    if(!it->second.empty())
+      directories.push_back(it->second);
+  if(directories.empty())
+    directories.emplace_back(kDefHotReloadDirectory);
+
+  const double debounce_ms = flags_.GetPositiveNumber("-hot-reload-debounce", FileWatcher::kDefDebounceMs);
+  if(!watcher_.Init(events_, directories, SecondsType(debounce_ms / 1000.0)))
+    return;
+
+  events_.AddListener(event_cleaner_, kAssetChangedEventType, this,
+    [](const Event &event, void *data) -> bool
+    {
+      const AssetChangedEvent &changed = event.GetCustomData<AssetChangedEvent>();
+      GAME_LOG(LogType::Info) << "Reloading " << changed.GetPath();
+      reinterpret_cast<Game*>(data)->assets_.Reload(changed.GetPath());
+      return true;
+    });
 }
 
 void Game::Run() noexcept
@@ -57,20 +138,42 @@ void Game::Run() noexcept
   ZoneScopedC(0xb3041b);
 
   running_ = true;
-  while(running_)
+  ClockType::time_point frame_start = ClockType::now();
+  for(uint64_t frame = 0; running_; ++frame)
   {
+    SetCrashFrame(frame);
     events_.DispatchSDLEvents();
+    // Before enqued events, so load events are dispatched in the same frame
+    assets_.Update();
     events_.DispatchEnquedEvents();
 
-    renderer_.Render();
+    const ClockType::time_point now = ClockType::now();
+    const uint32_t steps = timestep_.Advance(SecondsType(now - frame_start).count());
+    frame_start = now;
+    for(uint32_t i = 0; i < steps && running_; ++i)
+      Update(timestep_.GetStep());
+    if(max_ticks_ != 0 && timestep_.GetTick() >= max_ticks_)
+      running_ = false;
+
+    renderer_.Render(static_cast<float>(timestep_.GetAlpha()));
 
     FrameMark;
+
+    // Nothing is visible while minimized, so don't waste CPU on it
+    const double min_frame_time = window_.IsMinimized() ? std::max(min_frame_time_, 1.0 / kMinimizedFrameRate) : min_frame_time_;
+    if(min_frame_time > 0.0)
+      PreciseSleepUntil(frame_start + std::chrono::duration_cast<ClockType::duration>(SecondsType(min_frame_time)));
   }
   }
 
   Exit();
 }
 
+void Game::Update(__attribute__((unused)) double step) noexcept
+{
+  ZoneScopedC(0xb3041b);
+}
+
 void Game::QuitEvent()
 {
   ZoneScopedC(0xb3041b);
@@ -82,6 +185,9 @@ void Game::Exit() noexcept
 {
   ZoneScopedC(0xb3041b);
 
+  jobs_.Exit();
+  watcher_.Exit();
+  assets_.Exit();
   renderer_.Exit();
   window_.Exit();
 }
@@ -7,6 +7,12 @@
 #include "Core/Renderer.hpp"
 #include "Core/Window.hpp"
 #include "Core/EventHandler.hpp"
+#include "Core/GameLoop.hpp"
+#include "Utils/Time.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/AssetLoader.hpp"
+#include "Core/Archive.hpp"
+#include "Platform/FileWatcher.hpp"
 
 
 class SDL_Window;
@@ -26,25 +32,58 @@ public:
   [[nodiscard]] constexpr inline auto GetWindow() const noexcept -> const Window& { return window_; }
   [[nodiscard]] constexpr inline auto GetRenderer() noexcept -> Renderer& { return renderer_; }
   [[nodiscard]] constexpr inline auto GetRenderer() const noexcept -> const Renderer& { return renderer_; }
+  [[nodiscard]] constexpr inline auto GetTimestep() const noexcept -> const FixedTimestep& { return timestep_; }
+  [[nodiscard]] constexpr inline auto GetJobs() noexcept -> JobSystem& { return jobs_; }
+  [[nodiscard]] constexpr inline auto GetAssets() noexcept -> AssetLoader& { return assets_; }
+  [[nodiscard]] constexpr inline auto GetEvents() noexcept -> EventHandler& { return events_; }
+  /// Game runs without window and rendering, renderer made from -headless flag decides it
+  [[nodiscard]] inline auto IsHeadless() const noexcept -> bool { return renderer_.IsHeadless(); }
+
+  /// Frame rate used while window is minimized
+  static constexpr inline double kMinimizedFrameRate = 10.0;
+  /// Frame rate cap if display refresh rate is unknown, -fps-cap=N sets other one and -no-fps-cap removes it
+  static constexpr inline double kDefFrameRateCap = 240.0;
+  /// Archive that is opened when -archive flag isn't given, built by AssetPacker target
+  static constexpr inline const char *kDefArchivePath = "res.pak";
+  /// Directory that is watched when -hot-reload flag has no value
+  static constexpr inline const char *kDefHotReloadDirectory = "res";
 
 private:
   /// Initializes game
   Game(const int argc, const char * const *argv) noexcept;
 
   /// Main game loop
+  /// Simulation runs with fixed step, rendering as fast as allowed by frame cap
   void Run() noexcept;
+  /// Single simulation step
+  void Update(double step) noexcept;
+  /// Watch resource directories and reload assets that change
+  void StartHotReload() noexcept;
   /// Call back of SDL_QuitEvent
   void QuitEvent();
   /// Close application
   void Exit() noexcept;
 
+  /// Startup time is measured from construction of the first member
+  ClockType::time_point start_time_;
   bool running_ = false;
   Flags flags_;
+  JobSystem jobs_;
   EventHandler events_;
   EventCleaner event_cleaner_;
   // In this case I use reference just because it's handy and the class surely shouldn't be moved or copied
   Renderer &renderer_;
   Window window_;
+  /// Packed assets, textures are read from files if it isn't open
+  Archive archive_;
+  AssetLoader assets_;
+  /// Started only with -hot-reload flag
+  FileWatcher watcher_;
+  FixedTimestep timestep_;
+  /// 0 if frame rate isn't capped
+  double min_frame_time_ = 0.0;
+  /// Game exits after simulating that many ticks, 0 to run until quit
+  uint64_t max_ticks_ = 0;
 };
 } // game
 
@@ -0,0 +1,80 @@
+#ifndef GAME_GAME_LOOP_HPP
+#define GAME_GAME_LOOP_HPP
+
+#include "Setup.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+/// Accumulator for fixed rate simulation
+///
+/// Real frame time is added every frame and consumed in fixed steps,
+/// leftover is used as interpolation factor between the last two simulation states
+class FixedTimestep
+{
+public:
+  static constexpr inline double kDefTickRate = 60.0;
+  /// Longest frame that is simulated, slower frames make game run slower instead of
+  /// taking even longer to catch up (spiral of death)
+  static constexpr inline double kDefMaxFrameTime = 0.25;
+
+  explicit inline FixedTimestep(double tick_rate = kDefTickRate, double max_frame_time = kDefMaxFrameTime) noexcept;
+
+  /// Add frame time in seconds
+  /// return amount of steps that should be simulated this frame
+  inline auto Advance(double frame_time) noexcept -> uint32_t;
+
+  /// Simulation step in seconds
+  [[nodiscard]] constexpr inline auto GetStep() const noexcept -> double { return step_; }
+  /// Part of step that is accumulated but not simulated yet, in range [0, 1)
+  /// Used to interpolate between previous and current simulation state
+  [[nodiscard]] constexpr inline auto GetAlpha() const noexcept -> double { return accumulator_ / step_; }
+  /// Total simulated time in seconds
+  [[nodiscard]] constexpr inline auto GetTime() const noexcept -> double { return static_cast<double>(tick_) * step_; }
+  [[nodiscard]] constexpr inline auto GetTick() const noexcept -> uint64_t { return tick_; }
+  /// Amount of time that was dropped by max frame time clamp
+  [[nodiscard]] constexpr inline auto GetDroppedTime() const noexcept -> double { return dropped_time_; }
+
+private:
+  double step_;
+  double max_frame_time_;
+  double accumulator_ = 0.0;
+  double dropped_time_ = 0.0;
+  uint64_t tick_ = 0;
+};
+
+
+
+inline FixedTimestep::FixedTimestep(double tick_rate, double max_frame_time) noexcept
+: step_(1.0 / tick_rate)
+, max_frame_time_(max_frame_time)
+{
+  GAME_ASSERT(tick_rate > 0.0) << "Tick rate should be positive, got: " << tick_rate;
+  GAME_ASSERT(max_frame_time >= step_) << "Max frame time: " << max_frame_time << " should be at least one step: " << step_;
+}
+
+inline auto FixedTimestep::Advance(double frame_time) noexcept -> uint32_t
+{
+  frame_time = std::max(frame_time, 0.0);
+  if(GAME_IS_UNLIKELY(frame_time > max_frame_time_))
+  {
+    dropped_time_ += frame_time - max_frame_time_;
+    frame_time = max_frame_time_;
+  }
+
+  accumulator_ += frame_time;
+  const uint32_t steps = static_cast<uint32_t>(accumulator_ / step_);
+  accumulator_ -= static_cast<double>(steps) * step_;
+  // Rounding might leave accumulator a bit out of range
+  accumulator_ = std::clamp(accumulator_, 0.0, std::nextafter(step_, 0.0));
+  tick_ += steps;
+  return steps;
+}
+} // game
+
+#endif // GAME_GAME_LOOP_HPP
@@ -0,0 +1,106 @@
+#include "Image.hpp"
+
+#include "Setup.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "Core/Archive.hpp"
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+namespace
+{
+/// Convert decoded surface to RGBA and copy it into image, surface is freed
+auto CopySurface(SDL_Surface *decoded, std::string_view name, Image &image) noexcept -> bool
+{
+  if(decoded == nullptr)
+  {
+    GAME_LOG(LogType::Warning) << "Couldn't decode image " << name << ": " << IMG_GetError();
+    return false;
+  }
+
+  // Palette and RGB images are expanded, so every image has same layout
+  SDL_Surface *converted = SDL_ConvertSurfaceFormat(decoded, SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(decoded);
+  if(converted == nullptr)
+  {
+    GAME_LOG(LogType::Warning) << "Couldn't convert image " << name << " to RGBA: " << SDL_GetError();
+    return false;
+  }
+
+  image.width = converted->w;
+  image.height = converted->h;
+  image.pixels.resize(static_cast<std::size_t>(converted->w) * static_cast<std::size_t>(converted->h));
+  // Rows can be padded
+  for(int y = 0; y < converted->h; ++y)
+    std::memcpy(image.pixels.data() + static_cast<std::size_t>(y) * converted->w, static_cast<const std::byte*>(converted->pixels) + static_cast<std::size_t>(y) * converted->pitch, static_cast<std::size_t>(converted->w) * sizeof(uint32_t));
+  SDL_FreeSurface(converted);
+  return true;
+}
+} // namespace
+
+auto LoadImage(const std::string &path, Image &image) noexcept -> bool
+{
+  ZoneScopedC(0x07dbd4);
+  ZoneText(path.data(), path.size());
+
+  return CopySurface(IMG_Load(path.c_str()), path, image);
+}
+
+auto LoadImage(const std::byte *data, std::size_t size, std::string_view name, Image &image) noexcept -> bool
+{
+  ZoneScopedC(0x07dbd4);
+  ZoneText(name.data(), name.size());
+
+  SDL_RWops *stream = SDL_RWFromConstMem(data, static_cast<int>(size));
+  if(stream == nullptr)
+  {
+    GAME_LOG(LogType::Warning) << "Couldn't open image " << name << " from memory: " << SDL_GetError();
+    return false;
+  }
+  // Stream is closed by SDL_image
+  return CopySurface(IMG_Load_RW(stream, 1), name, image);
+}
+
+auto LoadImage(const Archive *archive, const std::string &path, Image &image) noexcept -> bool
+{
+  const Archive::Entry *entry = archive != nullptr ? archive->Find(path) : nullptr;
+  if(entry == nullptr)
+    return LoadImage(path, image);
+
+  // Stored entry is decoded straight from mapped archive
+  if(!(entry->flags & Archive::Entry::kCompressed))
+  {
+    const ByteSpan stored = archive->GetStored(*entry);
+    return LoadImage(stored.data, stored.size, path, image);
+  }
+
+  std::vector<std::byte> data;
+  return archive->Read(*entry, data) && LoadImage(data.data(), data.size(), path, image);
+}
+
+auto SaveImage(const std::string &path, const Image &image) noexcept -> bool
+{
+  ZoneScopedC(0x07dbd4);
+  ZoneText(path.data(), path.size());
+
+  // Surface only points to pixels, SDL doesn't write to them
+  SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint32_t*>(image.pixels.data()), image.width, image.height, 32, image.width * static_cast<int>(sizeof(uint32_t)), SDL_PIXELFORMAT_RGBA32);
+  if(surface == nullptr)
+  {
+    GAME_LOG(LogType::Warning) << "Couldn't wrap image " << path << ": " << SDL_GetError();
+    return false;
+  }
+  const bool saved = IMG_SavePNG(surface, path.c_str()) == 0;
+  SDL_FreeSurface(surface);
+  if(!saved)
+    GAME_LOG(LogType::Warning) << "Couldn't save image " << path << ": " << IMG_GetError();
+  return saved;
+}
+} // game
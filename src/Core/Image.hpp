@@ -0,0 +1,38 @@
+#ifndef GAME_IMAGE_HPP
+#define GAME_IMAGE_HPP
+
+#include "Setup.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+
+namespace game
+{
+class Archive;
+
+/// Decoded image in memory
+struct Image
+{
+  int32_t width = 0;
+  int32_t height = 0;
+  /// RGBA, red in the lowest byte, rows from top to bottom
+  std::vector<uint32_t> pixels;
+};
+
+/// Decode PNG (or any other format SDL_image was built with) into RGBA
+/// Thread safe, so it can run on worker threads
+/// return false if file can't be read or decoded, image is unchanged then
+[[nodiscard]] auto LoadImage(const std::string &path, Image &image) noexcept -> bool;
+/// Decode image file that is already in memory, name is used only in log messages
+[[nodiscard]] auto LoadImage(const std::byte *data, std::size_t size, std::string_view name, Image &image) noexcept -> bool;
+/// Decode image stored in archive under path, file on disk is used if archive is null or doesn't have it
+[[nodiscard]] auto LoadImage(const Archive *archive, const std::string &path, Image &image) noexcept -> bool;
+/// Encode image as PNG
+/// return false if file can't be written
+[[nodiscard]] auto SaveImage(const std::string &path, const Image &image) noexcept -> bool;
+} // game
+
+#endif // GAME_IMAGE_HPP
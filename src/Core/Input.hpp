@@ -0,0 +1,112 @@
+#ifndef GAME_INPUT_HPP
+#define GAME_INPUT_HPP
+
+#include "Setup.hpp"
+
+#include <array>
+#include <cstddef>
+
+
+namespace game
+{
+class EventHandler;
+
+/// Snapshot of keyboard and mouse state for the current frame
+///
+/// Filled by EventHandler::DispatchSDLEvents, so any key can be polled with a single bit test instead of listening for events
+/// Keys are indexed by scancode, mouse buttons by SDL button index
+class InputState
+{
+  friend EventHandler;
+public:
+  /// Same as SDL_NUM_SCANCODES
+  static constexpr inline std::size_t kScancodeCount = 512;
+  static constexpr inline std::size_t kMouseButtonCount = 32;
+
+  /// Is key held down right now
+  [[nodiscard]] constexpr inline auto IsKeyDown(uint16_t scancode) const noexcept -> bool { return TestBit(keys_down_, scancode); }
+  /// Was key pressed during the last DispatchSDLEvents
+  [[nodiscard]] constexpr inline auto WasKeyPressed(uint16_t scancode) const noexcept -> bool { return TestBit(keys_pressed_, scancode); }
+  /// Was key released during the last DispatchSDLEvents
+  [[nodiscard]] constexpr inline auto WasKeyReleased(uint16_t scancode) const noexcept -> bool { return TestBit(keys_released_, scancode); }
+
+  [[nodiscard]] constexpr inline auto IsMouseButtonDown(uint8_t button) const noexcept -> bool { return mouse_buttons_down_ & MouseButtonMask(button); }
+  [[nodiscard]] constexpr inline auto WasMouseButtonPressed(uint8_t button) const noexcept -> bool { return mouse_buttons_pressed_ & MouseButtonMask(button); }
+  [[nodiscard]] constexpr inline auto WasMouseButtonReleased(uint8_t button) const noexcept -> bool { return mouse_buttons_released_ & MouseButtonMask(button); }
+
+  /// Mouse position relative to window
+  [[nodiscard]] constexpr inline auto GetMouseX() const noexcept -> int32_t { return mouse_x_; }
+  [[nodiscard]] constexpr inline auto GetMouseY() const noexcept -> int32_t { return mouse_y_; }
+  /// Mouse movement accumulated during the last DispatchSDLEvents
+  [[nodiscard]] constexpr inline auto GetMouseDeltaX() const noexcept -> int32_t { return mouse_delta_x_; }
+  [[nodiscard]] constexpr inline auto GetMouseDeltaY() const noexcept -> int32_t { return mouse_delta_y_; }
+  /// Wheel scroll accumulated during the last DispatchSDLEvents
+  [[nodiscard]] constexpr inline auto GetWheelX() const noexcept -> float { return wheel_x_; }
+  [[nodiscard]] constexpr inline auto GetWheelY() const noexcept -> float { return wheel_y_; }
+
+  [[nodiscard]] constexpr inline auto HasFocus() const noexcept -> bool { return has_focus_; }
+
+private:
+  using WordType = uint64_t;
+  static constexpr inline std::size_t kWordBits = sizeof(WordType) * 8;
+  using KeyBitsType = std::array<WordType, kScancodeCount / kWordBits>;
+
+  [[nodiscard]] static constexpr inline auto TestBit(const KeyBitsType &bits, uint16_t scancode) noexcept -> bool
+  { return scancode < kScancodeCount && (bits[scancode / kWordBits] >> (scancode % kWordBits)) & 1; }
+  static constexpr inline void SetBit(KeyBitsType &bits, uint16_t scancode) noexcept
+  { if(scancode < kScancodeCount) bits[scancode / kWordBits] |= WordType{1} << (scancode % kWordBits); }
+  static constexpr inline void ClearBit(KeyBitsType &bits, uint16_t scancode) noexcept
+  { if(scancode < kScancodeCount) bits[scancode / kWordBits] &= ~(WordType{1} << (scancode % kWordBits)); }
+  [[nodiscard]] static constexpr inline auto MouseButtonMask(uint8_t button) noexcept -> uint32_t
+  { return button < kMouseButtonCount ? uint32_t{1} << button : 0; }
+
+  /// Clear per frame edges and deltas
+  inline void BeginFrame() noexcept;
+  inline void KeyDown(uint16_t scancode) noexcept { SetBit(keys_down_, scancode); SetBit(keys_pressed_, scancode); }
+  inline void KeyUp(uint16_t scancode) noexcept { ClearBit(keys_down_, scancode); SetBit(keys_released_, scancode); }
+  inline void MouseButtonDown(uint8_t button) noexcept { mouse_buttons_down_ |= MouseButtonMask(button); mouse_buttons_pressed_ |= MouseButtonMask(button); }
+  inline void MouseButtonUp(uint8_t button) noexcept { mouse_buttons_down_ &= ~MouseButtonMask(button); mouse_buttons_released_ |= MouseButtonMask(button); }
+  /// Release everything that is held, window won't receive key up events for them
+  inline void LoseFocus() noexcept;
+
+  KeyBitsType keys_down_{};
+  KeyBitsType keys_pressed_{};
+  KeyBitsType keys_released_{};
+  uint32_t mouse_buttons_down_ = 0;
+  uint32_t mouse_buttons_pressed_ = 0;
+  uint32_t mouse_buttons_released_ = 0;
+  int32_t mouse_x_ = 0;
+  int32_t mouse_y_ = 0;
+  int32_t mouse_delta_x_ = 0;
+  int32_t mouse_delta_y_ = 0;
+  float wheel_x_ = 0.0f;
+  float wheel_y_ = 0.0f;
+  bool has_focus_ = true;
+};
+
+
+
+inline void InputState::BeginFrame() noexcept
+{
+  keys_pressed_ = {};
+  keys_released_ = {};
+  mouse_buttons_pressed_ = 0;
+  mouse_buttons_released_ = 0;
+  mouse_delta_x_ = 0;
+  mouse_delta_y_ = 0;
+  wheel_x_ = 0.0f;
+  wheel_y_ = 0.0f;
+}
+
+inline void InputState::LoseFocus() noexcept
+{
+  has_focus_ = false;
+  for(std::size_t i = 0; i < keys_down_.size(); ++i)
+    keys_released_[i] |= keys_down_[i];
+  keys_down_ = {};
+  mouse_buttons_released_ |= mouse_buttons_down_;
+  mouse_buttons_down_ = 0;
+}
+} // game
+
+#endif // GAME_INPUT_HPP
@@ -0,0 +1,290 @@
+#include "JobSystem.hpp"
+
+#include "Setup.hpp"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <string>
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+namespace
+{
+struct ThreadIdentity
+{
+  const JobSystem *system = nullptr;
+  std::size_t index = 0;
+};
+
+thread_local ThreadIdentity thread_identity;
+
+/// xorshift32, used to pick random victim for stealing
+inline auto NextRandom(uint32_t &state) noexcept -> uint32_t
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+} // namespace
+
+JobSystem::ThreadData::ThreadData(uint32_t seed) noexcept
+: deque(kJobsPerThread)
+, jobs(new Job[kJobsPerThread])
+, free_jobs(kJobsPerThread)
+, random_state(seed)
+{
+  for(std::size_t i = 0; i < kJobsPerThread; ++i)
+    (void)free_jobs.TryPush(&jobs[i]);
+}
+
+void JobSystem::Init(std::size_t worker_count) noexcept
+{
+  ZoneScopedC(0x9c5ce0);
+
+  GAME_ASSERT(!IsRunning()) << "Job system is already running";
+
+  if(worker_count == 0)
+  {
+    const std::size_t cores = std::thread::hardware_concurrency();
+    worker_count = cores > 1 ? cores - 1 : 1;
+  }
+
+  threads_.reserve(worker_count + 1);
+  for(std::size_t i = 0; i < worker_count + 1; ++i)
+    threads_.emplace_back(std::make_unique<ThreadData>(static_cast<uint32_t>(i) * 2654435761u + 1));
+
+  thread_identity = ThreadIdentity{this, 0};
+  running_.store(true, std::memory_order_release);
+
+  workers_.reserve(worker_count);
+  for(std::size_t i = 1; i < worker_count + 1; ++i)
+    workers_.emplace_back(&JobSystem::WorkerLoop, this, i);
+
+  GAME_LOG(LogType::Info) << "Job system started with " << worker_count << " workers";
+}
+
+void JobSystem::Exit() noexcept
+{
+  ZoneScopedC(0x9c5ce0);
+
+  if(!IsRunning())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    running_.store(false, std::memory_order_release);
+  }
+  sleep_condition_.notify_all();
+
+  // Workers leave only when they can't find any job
+  for(std::thread &worker : workers_)
+    worker.join();
+  ThreadData &thread = *threads_[0];
+  while(Job *job = FindJob(thread))
+    Process(*job);
+  GAME_ASSERT(parked_count_.load(std::memory_order_relaxed) == 0) << parked_count_.load(std::memory_order_relaxed) << " jobs are left with dependency that never finished";
+
+  workers_.clear();
+  threads_.clear();
+  thread_identity = ThreadIdentity{};
+}
+
+void JobSystem::Run(JobFunctionType function, void *data, JobCounter *counter, const char *name, const JobCounter *dependency) noexcept
+{
+  ThreadData &thread = GetCurrentThread();
+
+  // Every slot has unfinished job, so help finish some of them
+  Job *slot;
+  while(GAME_IS_UNLIKELY(!thread.free_jobs.TryPop(slot)))
+  {
+    if(Job *other = FindJob(thread))
+      Process(*other);
+    else
+      std::this_thread::yield();
+  }
+
+  Job &job = *slot;
+  job = Job{function, data, counter, dependency, name, thread_identity.index, 0};
+  if(counter != nullptr)
+    counter->state_.fetch_add(1, std::memory_order_relaxed);
+
+  // Job of free slot always fits, unless deque holds jobs of other threads that were queued after their dependency
+  while(GAME_IS_UNLIKELY(!Queue(thread, job)))
+  {
+    if(Job *other = FindJob(thread))
+      Process(*other);
+    else
+      std::this_thread::yield();
+  }
+}
+
+auto JobSystem::Queue(ThreadData &thread, Job &job) noexcept -> bool
+{
+  if(!thread.deque.Push(&job))
+    return false;
+
+  queued_jobs_.fetch_add(1, std::memory_order_seq_cst);
+  if(sleeping_workers_.load(std::memory_order_seq_cst) != 0)
+  {
+    // Lock so notification can't be sent between worker checking for jobs and going to sleep
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    sleep_condition_.notify_one();
+  }
+  return true;
+}
+
+void JobSystem::Wait(const JobCounter &counter) noexcept
+{
+  ZoneScopedC(0x9c5ce0);
+
+  ThreadData &thread = GetCurrentThread();
+  while(!counter.IsDone())
+  {
+    if(Job *job = FindJob(thread))
+      Process(*job);
+    else
+      std::this_thread::yield();
+  }
+}
+
+auto JobSystem::GetThreadIndex() const noexcept -> std::size_t
+{
+  GAME_ASSERT_STD(thread_identity.system == this, "Thread doesn't belong to the job system");
+  return thread_identity.index;
+}
+
+void JobSystem::WorkerLoop(std::size_t index) noexcept
+{
+  thread_identity = ThreadIdentity{this, index};
+  #ifdef TRACY_ENABLE
+  const std::string thread_name = "Worker " + std::to_string(index);
+  tracy::SetThreadName(thread_name.c_str());
+  #endif
+
+  ThreadData &thread = *threads_[index];
+  int idle_count = 0;
+  while(true)
+  {
+    if(Job *job = FindJob(thread))
+    {
+      idle_count = 0;
+      Process(*job);
+      continue;
+    }
+
+    if(!IsRunning())
+      break;
+
+    if(++idle_count < kSpinCount)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    idle_count = 0;
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleeping_workers_.fetch_add(1, std::memory_order_seq_cst);
+    sleep_condition_.wait(lock, [this]{ return queued_jobs_.load(std::memory_order_seq_cst) != 0 || !IsRunning(); });
+    sleeping_workers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+auto JobSystem::FindJob(ThreadData &thread) noexcept -> Job*
+{
+  Job *job;
+  if(thread.deque.Pop(job))
+  {
+    queued_jobs_.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+  }
+
+  const std::size_t thread_count = threads_.size();
+  const std::size_t first_victim = NextRandom(thread.random_state) % thread_count;
+  for(std::size_t i = 0; i < thread_count; ++i)
+  {
+    ThreadData &victim = *threads_[(first_victim + i) % thread_count];
+    if(&victim != &thread && victim.deque.Steal(job))
+    {
+      queued_jobs_.fetch_sub(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+
+  return nullptr;
+}
+
+void JobSystem::Process(Job &job) noexcept
+{
+  if(job.dependency == nullptr)
+  {
+    Execute(job);
+    return;
+  }
+
+  // Waiting here could wait for thread that waits for this one, so job is linked to dependency and thread moves on
+  const uint64_t parked = static_cast<uint64_t>(GetJobIndex(job) + 1) << JobCounter::kDependentShift;
+  uint64_t state = job.dependency->state_.load(std::memory_order_acquire);
+  do
+  {
+    if((state & JobCounter::kCountMask) == 0)
+    {
+      Execute(job);
+      return;
+    }
+    job.next_dependent = static_cast<uint32_t>(state >> JobCounter::kDependentShift);
+  }
+  while(!job.dependency->state_.compare_exchange_weak(state, parked | (state & JobCounter::kCountMask), std::memory_order_release, std::memory_order_acquire));
+  parked_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobSystem::Execute(Job &job) noexcept
+{
+  // Copy, so job slot can be returned before job runs
+  const Job current = job;
+  (void)threads_[current.owner]->free_jobs.TryPush(&job);
+
+  {
+    ZoneScopedC(0x9c5ce0);
+    ZoneName(current.name, std::char_traits<char>::length(current.name));
+
+    current.function(current.data);
+  }
+
+  if(current.counter == nullptr)
+    return;
+
+  // The last job clears dependents together with count, counter can be destroyed right after that
+  uint64_t state = current.counter->state_.load(std::memory_order_relaxed);
+  while(!current.counter->state_.compare_exchange_weak(state, (state & JobCounter::kCountMask) == 1 ? 0 : state - 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+  if((state & JobCounter::kCountMask) != 1)
+    return;
+
+  ThreadData &thread = GetCurrentThread();
+  uint32_t next = static_cast<uint32_t>(state >> JobCounter::kDependentShift);
+  while(next != 0)
+  {
+    Job &ready = threads_[(next - 1) / kJobsPerThread]->jobs[(next - 1) % kJobsPerThread];
+    // Job can be taken by other thread as soon as it is queued
+    next = ready.next_dependent;
+    parked_count_.fetch_sub(1, std::memory_order_relaxed);
+    if(!Queue(thread, ready))
+      Process(ready);
+  }
+}
+
+auto JobSystem::GetJobIndex(const Job &job) const noexcept -> uint32_t
+{
+  return static_cast<uint32_t>(job.owner * kJobsPerThread + static_cast<std::size_t>(&job - threads_[job.owner]->jobs.get()));
+}
+
+auto JobSystem::GetCurrentThread() noexcept -> ThreadData&
+{
+  GAME_ASSERT(thread_identity.system == this) << "Jobs can be used only from thread that initialized job system or from other jobs";
+  return *threads_[thread_identity.index];
+}
+} // game
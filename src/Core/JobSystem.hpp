@@ -0,0 +1,190 @@
+#ifndef GAME_JOB_SYSTEM_HPP
+#define GAME_JOB_SYSTEM_HPP
+
+#include "Setup.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#include "Utils/Logger.hpp"
+#include "Utils/MPSCQueue.hpp"
+#include "Utils/WorkStealingDeque.hpp"
+
+
+namespace game
+{
+class JobSystem;
+
+/// Amount of unfinished jobs
+/// Job system can wait for it to reach zero while executing other jobs
+/// Jobs that depend on it are linked to it until it reaches zero
+class JobCounter
+{
+  friend JobSystem;
+public:
+  JobCounter() noexcept = default;
+  JobCounter(const JobCounter &) = delete;
+  JobCounter &operator=(const JobCounter &) = delete;
+
+  [[nodiscard]] inline auto IsDone() const noexcept -> bool { return (state_.load(std::memory_order_acquire) & kCountMask) == 0; }
+
+private:
+  static constexpr inline uint64_t kCountMask = 0xffffffff;
+  static constexpr inline int kDependentShift = 32;
+
+  /// Amount of unfinished jobs in low bits, index + 1 of the first parked dependent job in high bits
+  /// Thread that finishes the last job takes dependents and marks counter done with one exchange, so it doesn't touch counter after that
+  mutable std::atomic<uint64_t> state_{0};
+};
+
+/// Work stealing job scheduler
+///
+/// Each thread has it's own deque of jobs, new jobs are pushed to deque of thread that created them
+/// Idle threads steal jobs from random other threads, so work spreads without shared queue
+/// Job whose dependency isn't done is parked on the dependency counter and queued again when counter is done, threads never block on it
+/// Thread that called Init takes part in execution only while it waits for a counter
+class JobSystem
+{
+public:
+  using JobFunctionType = void(*)(void *data);
+
+  /// Size of job deque and job pool of each thread
+  /// Thread that has that many unfinished jobs executes other jobs until one of its jobs is finished
+  static constexpr inline std::size_t kJobsPerThread = 4096;
+  static constexpr inline const char *kDefJobName = "Job";
+
+  JobSystem() noexcept = default;
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+  inline ~JobSystem() noexcept { Exit(); }
+
+  /// Start worker threads, calling thread becomes thread 0
+  /// worker_count 0 means one worker per core except the one of calling thread
+  void Init(std::size_t worker_count = 0) noexcept;
+  /// Finish all queued jobs and join workers
+  void Exit() noexcept;
+
+  /// Queue job
+  /// counter (optional) is incremented right away and decremented when job is finished
+  /// dependency (optional) job isn't started until counter is done
+  /// name should be static string, it is shown in profiler
+  /// Should be called from thread that called Init or from other job
+  void Run(JobFunctionType function, void *data, JobCounter *counter = nullptr, const char *name = kDefJobName, const JobCounter *dependency = nullptr) noexcept;
+  /// Execute other jobs until counter is done
+  void Wait(const JobCounter &counter) noexcept;
+
+  /// Call function(begin, end) for subranges of [0, count) on all threads and wait for them
+  /// grain is the size of subrange, last one might be smaller
+  template<typename F>
+  void ParallelFor(uint32_t count, uint32_t grain, F &&function, const char *name = "ParallelFor") noexcept;
+
+  [[nodiscard]] inline auto IsRunning() const noexcept -> bool { return running_.load(std::memory_order_relaxed); }
+  /// Amount of threads that execute jobs, including thread that called Init
+  [[nodiscard]] inline auto GetThreadCount() const noexcept -> std::size_t { return threads_.size(); }
+  /// Index of calling thread, 0 for thread that called Init
+  [[nodiscard]] auto GetThreadIndex() const noexcept -> std::size_t;
+
+private:
+  struct Job
+  {
+    JobFunctionType function;
+    void *data;
+    JobCounter *counter;
+    const JobCounter *dependency;
+    const char *name;
+    /// Index of thread whose pool job slot belongs to
+    std::size_t owner;
+    /// Index + 1 of the next job parked on the same counter, 0 for the last one
+    uint32_t next_dependent;
+  };
+
+  struct alignas(kCacheLineSize) ThreadData
+  {
+    ThreadData(uint32_t seed) noexcept;
+
+    WorkStealingDeque<Job*> deque;
+    /// Pool of job slots, slot is used again only after its job was executed
+    std::unique_ptr<Job[]> jobs;
+    /// Slots that are free, any thread that executed job returns its slot here
+    MPSCQueue<Job*> free_jobs;
+    uint32_t random_state;
+  };
+
+  /// Attempts to find job before worker goes to sleep
+  static constexpr inline int kSpinCount = 64;
+
+  void WorkerLoop(std::size_t index) noexcept;
+  /// Take job from own deque or steal from other thread
+  /// return nullptr if there are no jobs
+  auto FindJob(ThreadData &thread) noexcept -> Job*;
+  /// Push job to deque of thread and wake up sleeping worker
+  /// return false if deque is full
+  auto Queue(ThreadData &thread, Job &job) noexcept -> bool;
+  /// Execute job if its dependency is done, otherwise park it on dependency
+  void Process(Job &job) noexcept;
+  /// Execute job, return its slot to the pool and queue jobs parked on its counter once counter is done
+  void Execute(Job &job) noexcept;
+  /// Index of job among slots of all threads
+  auto GetJobIndex(const Job &job) const noexcept -> uint32_t;
+  auto GetCurrentThread() noexcept -> ThreadData&;
+
+  std::vector<std::unique_ptr<ThreadData>> threads_;
+  std::vector<std::thread> workers_;
+  std::atomic<bool> running_{false};
+  /// Jobs that are pushed but not taken yet, used to wake up workers
+  std::atomic<uint32_t> queued_jobs_{0};
+  std::atomic<uint32_t> sleeping_workers_{0};
+  /// Jobs whose dependency wasn't done when they were taken, they aren't queued, so workers can sleep
+  std::atomic<uint32_t> parked_count_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+};
+
+
+
+template<typename F>
+void JobSystem::ParallelFor(uint32_t count, uint32_t grain, F &&function, const char *name) noexcept
+{
+  GAME_ASSERT(grain > 0) << "ParallelFor grain should be positive";
+
+  // Threads grab subranges one by one, so faster threads take more of them
+  struct Shared
+  {
+    std::remove_reference_t<F> *function;
+    std::atomic<uint32_t> next;
+    uint32_t count;
+    uint32_t grain;
+
+    static void Process(void *data)
+    {
+      Shared &shared = *reinterpret_cast<Shared*>(data);
+      uint32_t begin;
+      while((begin = shared.next.fetch_add(shared.grain, std::memory_order_relaxed)) < shared.count)
+        (*shared.function)(begin, std::min(shared.count - begin, shared.grain) + begin);
+    }
+  };
+
+  if(count == 0)
+    return;
+
+  Shared shared{&function, {0}, count, grain};
+  const std::size_t ranges = (static_cast<std::size_t>(count) + grain - 1) / grain;
+  const std::size_t helpers = std::min(ranges, std::max<std::size_t>(GetThreadCount(), 1)) - 1;
+
+  JobCounter counter;
+  for(std::size_t i = 0; i < helpers; ++i)
+    Run(&Shared::Process, &shared, &counter, name);
+  Shared::Process(&shared);
+  if(helpers != 0)
+    Wait(counter);
+}
+} // game
+
+#endif // GAME_JOB_SYSTEM_HPP
@@ -0,0 +1,54 @@
+#include "RenderQueue.hpp"
+
+#include "Setup.hpp"
+
+#include <array>
+#include <vector>
+#include <utility>
+
+
+namespace game
+{
+void RenderQueue::Sort() noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  constexpr int kDigitBits = 8;
+  constexpr std::size_t kBucketCount = std::size_t{1} << kDigitBits;
+  constexpr int kPassCount = 64 / kDigitBits;
+
+  const std::size_t size = entries_.size();
+  if(size < 2)
+    return;
+
+  // Count all digits in one read of keys
+  std::array<std::array<uint32_t, kBucketCount>, kPassCount> histograms{};
+  for(const Entry &entry : entries_)
+    for(int pass = 0; pass < kPassCount; ++pass)
+      histograms[pass][(entry.key >> (pass * kDigitBits)) & (kBucketCount - 1)]++;
+
+  scratch_.resize(size);
+  for(int pass = 0; pass < kPassCount; ++pass)
+  {
+    std::array<uint32_t, kBucketCount> &histogram = histograms[pass];
+
+    // All keys have same digit, so pass wouldn't change anything
+    // Common for unused bits, like depth of 2D sprites or high layers
+    const uint64_t digit = (entries_[0].key >> (pass * kDigitBits)) & (kBucketCount - 1);
+    if(histogram[digit] == size)
+      continue;
+
+    uint32_t sum = 0;
+    for(uint32_t &count : histogram)
+    {
+      const uint32_t count_copy = count;
+      count = sum;
+      sum += count_copy;
+    }
+
+    for(const Entry &entry : entries_)
+      scratch_[histogram[(entry.key >> (pass * kDigitBits)) & (kBucketCount - 1)]++] = entry;
+    std::swap(entries_, scratch_);
+  }
+}
+} // game
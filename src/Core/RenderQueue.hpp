@@ -0,0 +1,192 @@
+#ifndef GAME_RENDER_QUEUE_HPP
+#define GAME_RENDER_QUEUE_HPP
+
+#include "Setup.hpp"
+
+#include <vector>
+#include <cstring>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+enum class RenderCommandType : uint32_t
+{
+  Clear,
+  Viewport,
+  Draw,
+  Sprite
+};
+
+/// Clear currently bound framebuffer
+struct ClearCommand
+{
+  static constexpr inline RenderCommandType kType = RenderCommandType::Clear;
+  enum : uint32_t { kColor = 1, kDepth = 2 };
+
+  float color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+  float depth = 1.0f;
+  uint32_t mask = kColor | kDepth;
+};
+
+struct ViewportCommand
+{
+  static constexpr inline RenderCommandType kType = RenderCommandType::Viewport;
+
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+};
+
+/// Draw vertices of vertex array with shader and texture
+/// vertex_array is backend object, shader is id from backend's shader cache, texture is id from TextureCache, 0 means none
+struct DrawCommand
+{
+  static constexpr inline RenderCommandType kType = RenderCommandType::Draw;
+  enum Primitive : uint32_t { kTriangles, kTriangleStrip, kLines, kPoints };
+
+  uint32_t vertex_array;
+  uint32_t shader;
+  uint32_t texture;
+  Primitive primitive;
+  uint32_t first;
+  uint32_t count;
+  /// 1 for non instanced draw
+  uint32_t instance_count = 1;
+};
+
+/// Per instance data of a textured quad
+struct SpriteInstance
+{
+  /// Center of sprite in pixels, origin is top left corner of the screen
+  float position[2];
+  float size[2];
+  /// Radians clockwise
+  float rotation = 0.0f;
+  /// Texture coordinates of top left and bottom right corners
+  float uv[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+  /// RGBA, red in the lowest byte
+  uint32_t color = 0xffffffff;
+};
+
+/// Sprites with same shader and texture that come one after another are drawn with single instanced draw
+/// shader is id from backend's shader cache, 0 means default sprite shader, texture is id from TextureCache, 0 means white texture
+struct SpriteCommand
+{
+  static constexpr inline RenderCommandType kType = RenderCommandType::Sprite;
+
+  uint32_t shader;
+  uint32_t texture;
+  SpriteInstance instance;
+};
+
+/// Linear buffer of render commands with sort keys
+///
+/// Commands are copied into one byte buffer and referenced by offset, so recording is a couple of stores
+/// Sort orders commands by key with radix sort, commands with equal keys keep recording order
+/// Key layout from high to low bits: layer (8), shader (12), texture (20), depth (24)
+/// So commands are grouped by layer, then by state that is the most expensive to change
+class RenderQueue
+{
+public:
+  struct Entry
+  {
+    uint64_t key;
+    uint32_t offset;
+  };
+
+  static constexpr inline int kLayerBits = 8;
+  static constexpr inline int kShaderBits = 12;
+  static constexpr inline int kTextureBits = 20;
+  static constexpr inline int kDepthBits = 24;
+  static_assert(kLayerBits + kShaderBits + kTextureBits + kDepthBits == 64, "Sort key should use all 64 bits");
+
+  /// Every command is aligned to it
+  static constexpr inline std::size_t kAlignment = 8;
+
+  /// Make sort key, values that don't fit are cut
+  /// depth should be in range [0, 1], commands with smaller depth are replayed first
+  /// Depth out of range is clamped, NaN is replayed as 0
+  [[nodiscard]] static constexpr inline auto MakeKey(uint32_t layer, uint32_t shader, uint32_t texture, float depth) noexcept -> uint64_t;
+
+  RenderQueue() noexcept = default;
+  RenderQueue(const RenderQueue &) = delete;
+  RenderQueue &operator=(const RenderQueue &) = delete;
+  RenderQueue(RenderQueue &&) noexcept = default;
+  RenderQueue &operator=(RenderQueue &&) noexcept = default;
+
+  /// Reserve memory, so recording doesn't allocate
+  inline void Reserve(std::size_t command_count, std::size_t byte_count) noexcept { entries_.reserve(command_count); scratch_.reserve(command_count); data_.reserve(byte_count); }
+
+  /// Record command of type T (ClearCommand, DrawCommand, ...)
+  template<typename T>
+  inline void Add(uint64_t key, const T &command) noexcept;
+
+  /// Sort commands by key
+  void Sort() noexcept;
+
+  /// Remove all commands, memory is kept
+  inline void Clear() noexcept { entries_.clear(); data_.clear(); }
+
+  [[nodiscard]] inline auto GetType(const Entry &entry) const noexcept -> RenderCommandType { RenderCommandType type; std::memcpy(&type, data_.data() + entry.offset, sizeof(type)); return type; }
+  template<typename T>
+  [[nodiscard]] inline auto Get(const Entry &entry) const noexcept -> const T&;
+
+  [[nodiscard]] inline auto begin() const noexcept -> std::vector<Entry>::const_iterator { return entries_.cbegin(); }
+  [[nodiscard]] inline auto end() const noexcept -> std::vector<Entry>::const_iterator { return entries_.cend(); }
+  [[nodiscard]] inline auto GetSize() const noexcept -> std::size_t { return entries_.size(); }
+  [[nodiscard]] inline auto IsEmpty() const noexcept -> bool { return entries_.empty(); }
+
+private:
+  /// Type is stored before every command
+  static constexpr inline std::size_t kHeaderSize = kAlignment;
+
+  template<typename T>
+  static constexpr inline std::size_t kCommandSize = (kHeaderSize + sizeof(T) + kAlignment - 1) / kAlignment * kAlignment;
+
+  std::vector<Entry> entries_;
+  std::vector<Entry> scratch_;
+  std::vector<std::byte> data_;
+};
+
+
+
+constexpr inline auto RenderQueue::MakeKey(uint32_t layer, uint32_t shader, uint32_t texture, float depth) noexcept -> uint64_t
+{
+  constexpr uint64_t kMaxDepth = (uint64_t{1} << kDepthBits) - 1;
+  // Comparisons with NaN are false, so it ends up as 0 instead of being converted to integer
+  const float clamped_depth = depth >= 0.0f ? (depth <= 1.0f ? depth : 1.0f) : 0.0f;
+  return (static_cast<uint64_t>(layer) & ((uint64_t{1} << kLayerBits) - 1)) << (kShaderBits + kTextureBits + kDepthBits)
+       | (static_cast<uint64_t>(shader) & ((uint64_t{1} << kShaderBits) - 1)) << (kTextureBits + kDepthBits)
+       | (static_cast<uint64_t>(texture) & ((uint64_t{1} << kTextureBits) - 1)) << kDepthBits
+       | static_cast<uint64_t>(clamped_depth * static_cast<float>(kMaxDepth));
+}
+
+template<typename T>
+inline void RenderQueue::Add(uint64_t key, const T &command) noexcept
+{
+  static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Commands should be POD");
+  static_assert(alignof(T) <= kAlignment, "Command is overaligned");
+  static_assert(std::is_same_v<std::remove_cv_t<decltype(T::kType)>, RenderCommandType>, "Command should have kType");
+
+  const std::size_t offset = data_.size();
+  data_.resize(offset + kCommandSize<T>);
+  std::memcpy(data_.data() + offset, &T::kType, sizeof(RenderCommandType));
+  std::memcpy(data_.data() + offset + kHeaderSize, &command, sizeof(T));
+  entries_.push_back(Entry{key, static_cast<uint32_t>(offset)});
+}
+
+template<typename T>
+inline auto RenderQueue::Get(const Entry &entry) const noexcept -> const T&
+{
+  GAME_ASSERT_STD(GetType(entry) == T::kType, "Render command is accessed with wrong type");
+  return *std::launder(reinterpret_cast<const T*>(data_.data() + entry.offset + kHeaderSize));
+}
+} // game
+
+#endif // GAME_RENDER_QUEUE_HPP
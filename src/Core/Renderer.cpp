@@ -2,16 +2,26 @@
 
 #include "Setup.hpp"
 
+#include "Utils/FlagParser.hpp"
 #include "Platform/OpenGL/OpenGLRenderer.hpp"
+#include "Platform/Null/NullRenderer.hpp"
 
 
 namespace game
 {
-Renderer &Renderer::CreateRenderer() noexcept
+Renderer &Renderer::CreateRenderer(const Flags &flags) noexcept
 {
   ZoneScopedC(0x07dbd4);
 
+  if(flags.Contains("-headless"))
+  {
+    static NullRenderer null_renderer;
+    return null_renderer;
+  }
+
   static OpenGLRenderer opengl_renderer;
+  // Window is created before renderer Init, so it has to know about hidden window earlier
+  opengl_renderer.offscreen_ = flags.Contains("-offscreen");
   return opengl_renderer;
 }
 } // game
\ No newline at end of file
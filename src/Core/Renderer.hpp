@@ -3,29 +3,78 @@
 
 #include "Setup.hpp"
 
+#include <string_view>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "Core/RenderQueue.hpp"
+#include "Core/Image.hpp"
+#include "Core/TextureCache.hpp"
+
 
 namespace game
 {
 class Game;
+class Flags;
+
+/// GPU time of render pass in milliseconds over last frames that were measured
+struct GpuPassStats
+{
+  /// Name pass was measured with, string literal
+  const char *name = nullptr;
+  double last_ms = 0.0;
+  double average_ms = 0.0;
+  double min_ms = 0.0;
+  double max_ms = 0.0;
+  std::size_t sample_count = 0;
+};
 
 class Renderer
 {
 public:
   /// Function factory to create only one renderer
-  /// return Renderer according to current best fit
-  static Renderer &CreateRenderer() noexcept;
+  /// return Renderer according to current best fit, NullRenderer if -headless flag is present
+  static Renderer &CreateRenderer(const Flags &flags) noexcept;
   /// Initialize renderer with window
   virtual void Init(Game &game) noexcept = 0;
-  /// Add mesh to a rendering queue
-  /// First added meshes are rendered first
-  virtual void AddToQueue() noexcept = 0;
-  /// Render meshes from queue
-  virtual void Render() noexcept = 0;
+  /// Record command (ClearCommand, DrawCommand, ...) for the current frame
+  /// Commands are replayed in order of keys made with RenderQueue::MakeKey, equal keys in order they were added
+  template<typename T>
+  inline void AddToQueue(uint64_t key, const T &command) noexcept { queue_.Add(key, command); }
+  /// Record sprite, sprites on higher layers are drawn on top
+  inline void AddSprite(uint32_t layer, uint32_t texture, const SpriteInstance &sprite, uint32_t shader = 0) noexcept
+  { queue_.Add(RenderQueue::MakeKey(layer, shader, texture, 0.0f), SpriteCommand{shader, texture, sprite}); }
+  /// Record sprite that shows texture region, sprite uv is replaced with region one
+  inline void AddSprite(uint32_t layer, const TextureRegion &region, SpriteInstance sprite, uint32_t shader = 0) noexcept
+  { std::copy(std::begin(region.uv), std::end(region.uv), std::begin(sprite.uv)); AddSprite(layer, region.texture, sprite, shader); }
+  /// Load image file into texture, images are cached by path
+  /// Can be called before Init, texture appears on screen from the next rendered frame
+  [[nodiscard]] inline auto LoadTexture(std::string_view path) noexcept -> TextureRegion { return textures_.Load(path); }
+  [[nodiscard]] constexpr inline auto GetTextureCache() noexcept -> TextureCache& { return textures_; }
+  /// Sort and replay commands from queue, queue is empty afterwards
+  /// alpha is a part of simulation step passed since last update, used to interpolate between states
+  virtual void Render(float alpha) noexcept = 0;
   /// Deinit renderer and clear memory
   virtual void Exit() noexcept = 0;
+  /// Rolling GPU time of render passes, results lag a few frames behind rendering
+  /// Thread safe, stats are empty if renderer can't measure GPU time
+  virtual void GetGpuStats(std::vector<GpuPassStats> &stats) const noexcept { stats.clear(); }
+  /// Ask for pixels of the next rendered frame, they can be taken with TakeCapture a few frames later
+  /// Thread safe, requests are ignored if renderer has no pixels
+  virtual void RequestCapture() noexcept {}
+  /// Move the oldest finished capture into image, rows from top to bottom
+  /// return false if there is none yet
+  virtual auto TakeCapture(__attribute__((unused)) Image &image) noexcept -> bool { return false; }
 
+  /// Renderer that draws nothing and needs no window, picked with -headless flag
+  [[nodiscard]] virtual auto IsHeadless() const noexcept -> bool { return false; }
   /// Used to get SDL_WINDOW_OPENGL or SDL_WINDOW_VUKAN or ...
   virtual auto GetSDLWindowFlags() const noexcept -> int = 0;
+
+protected:
+  RenderQueue queue_;
+  TextureCache textures_;
 };
 } // game
 
@@ -0,0 +1,289 @@
+#include "TextureCache.hpp"
+
+#include "Setup.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include "Utils/Hash.hpp"
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+namespace
+{
+/// Copy with edges extruded into padding
+auto PadImage(const Image &image, int32_t padding) noexcept -> std::vector<uint32_t>
+{
+  const int32_t padded_width = image.width + padding * 2;
+  const int32_t padded_height = image.height + padding * 2;
+  std::vector<uint32_t> pixels(static_cast<std::size_t>(padded_width) * padded_height);
+  for(int32_t row = 0; row < padded_height; ++row)
+  {
+    const int32_t source_row = std::clamp(row - padding, 0, image.height - 1);
+    for(int32_t column = 0; column < padded_width; ++column)
+    {
+      const int32_t source_column = std::clamp(column - padding, 0, image.width - 1);
+      pixels[row * padded_width + column] = image.pixels[source_row * image.width + source_column];
+    }
+  }
+  return pixels;
+}
+} // namespace
+
+auto TextureCache::Load(std::string_view path) noexcept -> TextureRegion
+{
+  ZoneScopedC(0x07dbd4);
+
+  const uint32_t hash = HashString(path);
+  if(const auto it = regions_.find(hash); it != regions_.end())
+  {
+    // Caller keeps region without reference, so texture can't be evicted anymore
+    infos_[it->second.texture].pinned = true;
+    return it->second;
+  }
+
+  Image image;
+  // Failed path is cached too, so missing file isn't read every time it is asked for
+  const TextureRegion region = LoadImage(archive_, std::string(path), image) ? Insert(image) : GetFallback();
+  infos_[region.texture].pinned = true;
+  regions_.emplace(hash, region);
+  return region;
+}
+
+auto TextureCache::Add(std::string_view name, const Image &image, bool evictable) noexcept -> TextureRegion
+{
+  ZoneScopedC(0x07dbd4);
+
+  const uint32_t hash = HashString(name);
+  const auto it = regions_.find(hash);
+  const TextureRegion region = it != regions_.end() ? it->second : Insert(image);
+  if(!evictable)
+    infos_[region.texture].pinned = true;
+  regions_.emplace(hash, region);
+  return region;
+}
+
+auto TextureCache::Reload(std::string_view path, const Image &image) noexcept -> const TextureRegion*
+{
+  ZoneScopedC(0x07dbd4);
+
+  const uint32_t hash = HashString(path);
+  const auto it = regions_.find(hash);
+  if(it == regions_.end())
+    return nullptr;
+
+  TextureRegion &region = it->second;
+  const bool is_fallback_path = hash == HashString(fallback_path_);
+  // Failed load caches fallback under its path, fallback itself shouldn't be overwritten then
+  const bool is_fallback = !is_fallback_path && region.texture == fallback_.texture && region.uv[0] == fallback_.uv[0] && region.uv[1] == fallback_.uv[1];
+  // Same place is overwritten, so every copy of region stays valid
+  if(!is_fallback && region.width == image.width && region.height == image.height)
+  {
+    if(image.width > kMaxAtlasedSize || image.height > kMaxAtlasedSize)
+      QueueUpload(TextureUpload{region.texture, image.width, image.height, 0, 0, image.width, image.height, image.pixels});
+    else
+    {
+      const int32_t x = static_cast<int32_t>(region.uv[0] * kPageSize + 0.5f) - kPadding;
+      const int32_t y = static_cast<int32_t>(region.uv[1] * kPageSize + 0.5f) - kPadding;
+      QueueUpload(TextureUpload{region.texture, kPageSize, kPageSize, x, y, image.width + kPadding * 2, image.height + kPadding * 2, PadImage(image, kPadding)});
+    }
+    return &region;
+  }
+
+  // Size changed, image is placed anew and its old place in atlas stays unused
+  // Image that had its own texture or used fallback isn't pinned to it anymore
+  const TextureRegion old = region;
+  region = Insert(image);
+  infos_[region.texture].pinned = infos_[old.texture].pinned;
+  if(!is_fallback && old.texture != region.texture && std::none_of(pages_.begin(), pages_.end(), [&](const Page &page){ return page.texture == old.texture; }))
+    infos_[old.texture].pinned = false;
+  if(is_fallback_path && fallback_.texture != 0)
+    fallback_ = region;
+  GAME_LOG(LogType::Info) << "Reloaded " << path << " with new size " << image.width << "x" << image.height;
+  return &region;
+}
+
+auto TextureCache::Find(std::string_view path) const noexcept -> const TextureRegion*
+{
+  const auto it = regions_.find(HashString(path));
+  return it == regions_.end() ? nullptr : &it->second;
+}
+
+auto TextureCache::GetFallback() noexcept -> TextureRegion
+{
+  if(fallback_.texture != 0)
+    return fallback_;
+
+  ZoneScopedC(0x07dbd4);
+
+  if(const TextureRegion *loaded = Find(fallback_path_); loaded != nullptr)
+  {
+    fallback_ = *loaded;
+    infos_[fallback_.texture].pinned = true;
+    return fallback_;
+  }
+
+  Image image;
+  if(!LoadImage(archive_, fallback_path_, image))
+  {
+    GAME_LOG(LogType::Warning) << "Couldn't load fallback texture " << fallback_path_ << ", using generated one";
+    constexpr int32_t kSize = 64;
+    constexpr int32_t kCell = 8;
+    constexpr uint32_t kMagenta = 0xffff00ff;
+    constexpr uint32_t kBlack = 0xff000000;
+    image.width = kSize;
+    image.height = kSize;
+    image.pixels.resize(kSize * kSize);
+    for(int32_t y = 0; y < kSize; ++y)
+      for(int32_t x = 0; x < kSize; ++x)
+        image.pixels[y * kSize + x] = ((x / kCell + y / kCell) & 1) ? kBlack : kMagenta;
+  }
+
+  fallback_ = Insert(image);
+  infos_[fallback_.texture].pinned = true;
+  regions_.emplace(HashString(fallback_path_), fallback_);
+  return fallback_;
+}
+
+auto TextureCache::Insert(const Image &image) noexcept -> TextureRegion
+{
+  ZoneScopedC(0x07dbd4);
+  GAME_ASSERT(image.width > 0 && image.height > 0 && image.pixels.size() == static_cast<std::size_t>(image.width) * image.height) << "Image is empty or its size doesn't match pixels";
+
+  TextureRegion region;
+  region.width = image.width;
+  region.height = image.height;
+
+  if(image.width > kMaxAtlasedSize || image.height > kMaxAtlasedSize)
+  {
+    region.texture = NewTexture(static_cast<int64_t>(image.width) * image.height * sizeof(uint32_t));
+    QueueUpload(TextureUpload{region.texture, image.width, image.height, 0, 0, image.width, image.height, image.pixels});
+    return region;
+  }
+
+  const int32_t padded_width = image.width + kPadding * 2;
+  const int32_t padded_height = image.height + kPadding * 2;
+  int32_t x;
+  int32_t y;
+  // Pages that are almost full are checked too, so small images fill gaps left by big ones
+  auto page = std::find_if(pages_.begin(), pages_.end(), [&](Page &candidate){ return candidate.packer.Pack(padded_width, padded_height, x, y); });
+  if(page == pages_.end())
+  {
+    GAME_LOG(LogType::Info) << "Creating texture atlas page " << pages_.size();
+    pages_.push_back(Page{NewTexture(int64_t{kPageSize} * kPageSize * sizeof(uint32_t)), SkylinePacker(kPageSize, kPageSize)});
+    page = std::prev(pages_.end());
+    QueueUpload(TextureUpload{page->texture, kPageSize, kPageSize, 0, 0, 0, 0, {}});
+    __attribute__((unused)) const bool packed = page->packer.Pack(padded_width, padded_height, x, y);
+    GAME_ASSERT(packed) << "Image should fit into empty atlas page";
+  }
+
+  QueueUpload(TextureUpload{page->texture, kPageSize, kPageSize, x, y, padded_width, padded_height, PadImage(image, kPadding)});
+
+  constexpr float kTexel = 1.0f / static_cast<float>(kPageSize);
+  region.texture = page->texture;
+  region.uv[0] = static_cast<float>(x + kPadding) * kTexel;
+  region.uv[1] = static_cast<float>(y + kPadding) * kTexel;
+  region.uv[2] = static_cast<float>(x + kPadding + image.width) * kTexel;
+  region.uv[3] = static_cast<float>(y + kPadding + image.height) * kTexel;
+  TracyPlot("Atlas occupancy", page->packer.GetOccupancy());
+  return region;
+}
+
+auto TextureCache::NewTexture(int64_t bytes) noexcept -> uint32_t
+{
+  TextureInfo info;
+  info.bytes = bytes;
+  info.alive = true;
+  memory_usage_ += bytes;
+  TracyPlot("Texture memory", memory_usage_);
+  if(free_textures_.empty())
+  {
+    infos_.push_back(info);
+    return static_cast<uint32_t>(infos_.size() - 1);
+  }
+  const uint32_t texture = free_textures_.back();
+  free_textures_.pop_back();
+  infos_[texture] = info;
+  return texture;
+}
+
+void TextureCache::Retain(uint32_t texture) noexcept
+{
+  GAME_ASSERT(texture < infos_.size() && infos_[texture].alive) << "Retaining texture that doesn't exist: " << texture;
+  ++infos_[texture].references;
+}
+
+void TextureCache::Release(uint32_t texture) noexcept
+{
+  GAME_ASSERT(texture < infos_.size() && infos_[texture].references != 0) << "Releasing texture that isn't retained: " << texture;
+  TextureInfo &info = infos_[texture];
+  if(--info.references == 0)
+    info.last_release = ++release_counter_;
+}
+
+auto TextureCache::Evict(int64_t max_bytes) noexcept -> int64_t
+{
+  if(memory_usage_ <= max_bytes)
+    return 0;
+
+  ZoneScopedC(0x07dbd4);
+
+  std::vector<uint32_t> candidates;
+  for(uint32_t texture = 1; texture < infos_.size(); ++texture)
+    if(infos_[texture].alive && !infos_[texture].pinned && infos_[texture].references == 0)
+      candidates.push_back(texture);
+  std::sort(candidates.begin(), candidates.end(), [this](uint32_t lhs, uint32_t rhs){ return infos_[lhs].last_release < infos_[rhs].last_release; });
+
+  int64_t freed = 0;
+  std::size_t evicted = 0;
+  for(; evicted < candidates.size() && memory_usage_ > max_bytes; ++evicted)
+  {
+    const uint32_t texture = candidates[evicted];
+    TextureInfo &info = infos_[texture];
+    info.alive = false;
+    memory_usage_ -= info.bytes;
+    freed += info.bytes;
+    pages_.erase(std::remove_if(pages_.begin(), pages_.end(), [texture](const Page &page){ return page.texture == texture; }), pages_.end());
+    free_textures_.push_back(texture);
+    TextureUpload upload{};
+    upload.texture = texture;
+    upload.release = true;
+    QueueUpload(std::move(upload));
+  }
+  if(evicted == 0)
+    return 0;
+
+  // Regions of freed textures are forgotten, so they are loaded again when asked for
+  for(auto it = regions_.begin(); it != regions_.end();)
+  {
+    if(infos_[it->second.texture].alive)
+      ++it;
+    else
+      it = regions_.erase(it);
+  }
+
+  GAME_LOG(LogType::Info) << "Evicted " << evicted << " textures, freed " << freed << " bytes";
+  TracyPlot("Texture memory", memory_usage_);
+  return freed;
+}
+
+void TextureCache::QueueUpload(TextureUpload &&upload) noexcept
+{
+  std::lock_guard<std::mutex> lock(upload_mutex_);
+  uploads_.push_back(std::move(upload));
+}
+
+void TextureCache::TakeUploads(std::vector<TextureUpload> &uploads) noexcept
+{
+  std::lock_guard<std::mutex> lock(upload_mutex_);
+  if(uploads.empty())
+  {
+    std::swap(uploads, uploads_);
+    return;
+  }
+  std::move(uploads_.begin(), uploads_.end(), std::back_inserter(uploads));
+  uploads_.clear();
+}
+} // game
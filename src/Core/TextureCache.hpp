@@ -0,0 +1,150 @@
+#ifndef GAME_TEXTURE_CACHE_HPP
+#define GAME_TEXTURE_CACHE_HPP
+
+#include "Setup.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <utility>
+
+#include "Core/Image.hpp"
+#include "Utils/SkylinePacker.hpp"
+
+
+namespace game
+{
+/// Part of a texture that holds one image
+/// texture is an id for render commands, uv can be copied to SpriteInstance::uv as is
+struct TextureRegion
+{
+  uint32_t texture = 0;
+  float uv[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+  int32_t width = 0;
+  int32_t height = 0;
+};
+
+/// Pixels that backend should copy into texture
+/// Texture of texture_width x texture_height is created first if id wasn't seen before
+struct TextureUpload
+{
+  uint32_t texture;
+  int32_t texture_width;
+  int32_t texture_height;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  /// Same layout as Image::pixels, empty if only texture should be created
+  std::vector<uint32_t> pixels;
+  /// Texture should be deleted, other fields are unused then
+  /// Released id is given to the next new texture, so uploads should be applied in order
+  bool release = false;
+};
+
+/// Backend independent part of texture loading
+///
+/// Images are cached by hash of their path, so every file is decoded and uploaded once
+/// Small images are packed into shared atlas pages, so sprites with different images can be drawn in one batch
+/// Texture ids are given out right away and backend creates its objects for them later from uploads,
+/// that way loading doesn't need graphics context and works with render thread
+/// Textures are pinned by Load, evictable ones are kept alive by Retain and freed by Evict when nothing references them
+/// Everything except TakeUploads should be called from one thread
+class TextureCache
+{
+public:
+  static constexpr inline int32_t kPageSize = 2048;
+  /// Images with bigger side get their own texture
+  static constexpr inline int32_t kMaxAtlasedSize = 256;
+  /// Edge pixels are repeated around every atlased image, so filtering doesn't pick up neighbours
+  static constexpr inline int32_t kPadding = 1;
+  static constexpr inline const char *kDefaultFallbackPath = "res/NoTexture64.png";
+
+  TextureCache() noexcept = default;
+  TextureCache(const TextureCache &) = delete;
+  TextureCache &operator=(const TextureCache &) = delete;
+
+  /// Decode image file, or return cached region if it was loaded before
+  /// Fallback texture is returned if file can't be loaded
+  [[nodiscard]] auto Load(std::string_view path) noexcept -> TextureRegion;
+  /// Add image made at runtime or decoded elsewhere, name is used as a path for caching
+  /// Texture isn't pinned if evictable is true, so caller should Retain it
+  [[nodiscard]] auto Add(std::string_view name, const Image &image, bool evictable = false) noexcept -> TextureRegion;
+  /// Replace pixels of image that was loaded or added with this path, used for hot reload
+  /// Image of the same size is overwritten in place, so regions that were handed out stay valid,
+  /// otherwise it is placed anew and returned region should replace old copies
+  /// return nullptr if nothing was loaded with this path
+  [[nodiscard]] auto Reload(std::string_view path, const Image &image) noexcept -> const TextureRegion*;
+  /// return nullptr if nothing was loaded with this path
+  [[nodiscard]] auto Find(std::string_view path) const noexcept -> const TextureRegion*;
+  /// Texture that is used when load fails
+  /// It is loaded from fallback path on first use, checkerboard is generated if even that fails
+  [[nodiscard]] auto GetFallback() noexcept -> TextureRegion;
+  /// Should be set before first failed load
+  inline void SetFallbackPath(std::string path) noexcept { fallback_path_ = std::move(path); }
+  /// Images are looked up in archive before files on disk, null to use only files
+  /// Archive should outlive cache and be set before loading starts
+  constexpr inline void SetArchive(const Archive *archive) noexcept { archive_ = archive; }
+  [[nodiscard]] constexpr inline auto GetArchive() const noexcept -> const Archive* { return archive_; }
+
+  /// Reference counting of evictable textures
+  /// Region shares its atlas page with other images, so whole page stays while any of them is retained
+  void Retain(uint32_t texture) noexcept;
+  void Release(uint32_t texture) noexcept;
+  /// Free least recently released textures until memory usage is not greater than max_bytes
+  /// Only textures that are neither pinned nor retained are freed, their regions are forgotten
+  /// return amount of bytes freed
+  auto Evict(int64_t max_bytes) noexcept -> int64_t;
+  /// Bytes of pixel memory of all textures
+  [[nodiscard]] constexpr inline auto GetMemoryUsage() const noexcept -> int64_t { return memory_usage_; }
+
+  /// Move pending uploads to the end of uploads, thread safe
+  void TakeUploads(std::vector<TextureUpload> &uploads) noexcept;
+
+  [[nodiscard]] inline auto GetPageCount() const noexcept -> std::size_t { return pages_.size(); }
+  /// Amount of texture ids given out, ids are in range [1, count], ids of evicted textures are given out again
+  [[nodiscard]] inline auto GetTextureCount() const noexcept -> uint32_t { return static_cast<uint32_t>(infos_.size() - 1); }
+  [[nodiscard]] inline auto GetImageCount() const noexcept -> std::size_t { return regions_.size(); }
+
+private:
+  struct Page
+  {
+    uint32_t texture;
+    SkylinePacker packer;
+  };
+
+  /// State of texture id, index 0 is unused
+  struct TextureInfo
+  {
+    int64_t bytes = 0;
+    uint32_t references = 0;
+    /// Value of release_counter_ when texture was released last time, used to evict the oldest first
+    uint64_t last_release = 0;
+    bool pinned = false;
+    bool alive = false;
+  };
+
+  /// Place image into atlas page or its own texture and queue upload
+  auto Insert(const Image &image) noexcept -> TextureRegion;
+  void QueueUpload(TextureUpload &&upload) noexcept;
+  auto NewTexture(int64_t bytes) noexcept -> uint32_t;
+
+  std::unordered_map<uint32_t, TextureRegion> regions_;
+  std::vector<Page> pages_;
+  std::vector<TextureInfo> infos_ = std::vector<TextureInfo>(1);
+  /// Ids of evicted textures, reused before infos_ grows
+  std::vector<uint32_t> free_textures_;
+  int64_t memory_usage_ = 0;
+  uint64_t release_counter_ = 0;
+  std::string fallback_path_ = kDefaultFallbackPath;
+  const Archive *archive_ = nullptr;
+  TextureRegion fallback_;
+
+  std::mutex upload_mutex_;
+  std::vector<TextureUpload> uploads_;
+};
+} // game
+
+#endif // GAME_TEXTURE_CACHE_HPP
@@ -13,6 +13,14 @@ namespace game
 {
 Window::Window(Game &game) noexcept : game_(game)
 {
+  if(game_.IsHeadless())
+  {
+    // Events are still used for quit requests
+    __attribute__((unused)) const int result = SDL_Init(SDL_INIT_EVENTS);
+    GAME_ASSERT(result == 0) << "Couldn't initialize sdl events: " << SDL_GetError();
+    return;
+  }
+
   SDL_Init(SDL_INIT_EVERYTHING);
 
   SDL_DisplayMode display_mode;
@@ -32,10 +40,24 @@ Window::Window(Game &game) noexcept : game_(game)
 
 void Window::Exit() noexcept
 {
-  SDL_DestroyWindow(sdl_window_);
+  if(sdl_window_ != nullptr)
+    SDL_DestroyWindow(sdl_window_);
   SDL_Quit();
 }
 
+auto Window::IsMinimized() const noexcept -> bool
+{
+  return sdl_window_ != nullptr && (SDL_GetWindowFlags(sdl_window_) & SDL_WINDOW_MINIMIZED);
+}
+
+auto Window::GetRefreshRate() const noexcept -> int
+{
+  SDL_DisplayMode display_mode;
+  if(sdl_window_ == nullptr || SDL_GetWindowDisplayMode(sdl_window_, &display_mode) != 0)
+    return 0;
+  return display_mode.refresh_rate;
+}
+
 void Window::SetResolution(const Eigen::Vector2i &resolution) noexcept
 {
   width_ = resolution(0);
@@ -43,13 +65,15 @@ void Window::SetResolution(const Eigen::Vector2i &resolution) noexcept
 
   GAME_ASSERT(width_ > 0 && height_ > 0) << "Widht: " << width_ << " and height: " << height_ << " of a window must be positive intagers";
 
-  SDL_SetWindowSize(sdl_window_, width_, height_);
+  if(sdl_window_ != nullptr)
+    SDL_SetWindowSize(sdl_window_, width_, height_);
 }
 
 void Window::SetTitle(const std::string &title) noexcept
 {  
   title_ = title;
 
-  SDL_SetWindowTitle(sdl_window_, title_.c_str());
+  if(sdl_window_ != nullptr)
+    SDL_SetWindowTitle(sdl_window_, title_.c_str());
 }
 }
\ No newline at end of file
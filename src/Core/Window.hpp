@@ -17,6 +17,7 @@ class Game;
 class Window
 {
 public:
+  /// Window isn't created if game is headless, only SDL event subsystem is initialized then
   Window(Game &game) noexcept;
 
   void Exit() noexcept;
@@ -26,8 +27,13 @@ public:
   [[nodiscard]] inline auto GetResolution() noexcept -> Eigen::Vector2i { return Eigen::Vector2i{width_, height_}; }
   void SetResolution(const Eigen::Vector2i &resolution) noexcept;
   
+  /// return nullptr if game is headless
   [[nodiscard]] constexpr inline auto GetSDLWindow() noexcept -> SDL_Window* { return sdl_window_; }
 
+  [[nodiscard]] auto IsMinimized() const noexcept -> bool;
+  /// Refresh rate of display window is on, 0 if it is unknown or game is headless
+  [[nodiscard]] auto GetRefreshRate() const noexcept -> int;
+
   [[nodiscard]] inline auto GetTitle() noexcept -> const std::string & { return title_; }
   void SetTitle(const std::string &title) noexcept;
 
@@ -35,11 +41,11 @@ private:
   Game &game_;
 
   static constexpr inline int kStartupResDivFactor = 3;
-  int width_;
-  int height_;
+  int width_ = 0;
+  int height_ = 0;
   std::string title_ = "Game";
 
-  SDL_Window *sdl_window_;
+  SDL_Window *sdl_window_ = nullptr;
 };
 }
 
@@ -0,0 +1,276 @@
+#include "CrashHandler.hpp"
+
+#include "Setup.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <csignal>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+
+#include "Platform/Platform.hpp"
+#include "Utils/Logger.hpp"
+
+#if defined(GAME_OS_WIN)
+  #include <windows.h>
+#elif defined(GAME_OS_LINUX)
+  #include <execinfo.h>
+  #include <fcntl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+
+namespace game
+{
+#if defined(GAME_OS_WIN) || defined(GAME_OS_LINUX)
+namespace
+{
+constexpr std::size_t kMaxPathSize = 4096;
+constexpr int kMaxFrames = 64;
+/// Handler runs on its own stack, so stack overflow can be reported too
+constexpr std::size_t kStackSize = 64 * 1024;
+
+/// Everything handler needs is here before crash, std::string could live in broken heap
+char crash_path[kMaxPathSize];
+void *crash_frames[kMaxFrames];
+
+/// Writes to crash file, data points to platform handle of it
+void WriteCrashText(const char *text, std::size_t size, void *data) noexcept;
+
+void WriteText(std::string_view text, void *file) noexcept
+{
+  WriteCrashText(text.data(), text.size(), file);
+}
+
+void WriteNumber(uint64_t value, int base, void *file) noexcept
+{
+  char text[24];
+  const std::to_chars_result result = std::to_chars(std::begin(text), std::end(text), value, base);
+  WriteCrashText(text, static_cast<std::size_t>(result.ptr - text), file);
+}
+
+/// Address is written only for faults, null one is what crashed then
+void WriteHeader(std::string_view reason, bool fault, const void *address, void *file) noexcept
+{
+  WriteText("Crash: ", file);
+  WriteText(reason, file);
+  if(fault)
+  {
+    WriteText(" at 0x", file);
+    WriteNumber(reinterpret_cast<uintptr_t>(address), 16, file);
+  }
+  WriteText("\nFrame: ", file);
+  WriteNumber(detail::crash_frame.load(std::memory_order_relaxed), 10, file);
+  WriteText("\n\nBacktrace:\n", file);
+}
+
+void WriteLogLines(void *file) noexcept
+{
+  WriteText("\nLast log lines:\n", file);
+  Logger::WriteCrashLines(WriteCrashText, file);
+}
+
+void CopyPath(const std::string &path) noexcept
+{
+  std::memcpy(crash_path, path.c_str(), path.size() + 1);
+}
+} // namespace
+#endif
+
+#if defined(GAME_OS_WIN)
+namespace
+{
+/// File name of module that frame is in
+char module_path[kMaxPathSize];
+std::atomic<bool> crashing{false};
+
+void WriteCrashText(const char *text, std::size_t size, void *data) noexcept
+{
+  const HANDLE file = *static_cast<HANDLE*>(data);
+  while(size != 0)
+  {
+    DWORD written;
+    if(!WriteFile(file, text, static_cast<DWORD>(std::min<std::size_t>(size, MAXDWORD)), &written, nullptr) || written == 0)
+      return;
+    text += written;
+    size -= written;
+  }
+}
+
+auto GetExceptionName(DWORD code) noexcept -> const char*
+{
+  switch(code)
+  {
+  case EXCEPTION_ACCESS_VIOLATION: return "Access violation";
+  case EXCEPTION_IN_PAGE_ERROR: return "In page error";
+  case EXCEPTION_STACK_OVERFLOW: return "Stack overflow";
+  case EXCEPTION_INT_DIVIDE_BY_ZERO: return "Integer divide by zero";
+  case EXCEPTION_FLT_DIVIDE_BY_ZERO: return "Float divide by zero";
+  case EXCEPTION_ILLEGAL_INSTRUCTION: return "Illegal instruction";
+  default: return "Unhandled exception";
+  }
+}
+
+/// dbghelp allocates, so frames are written as module and offset that are symbolized with pdb later
+void WriteCrashReport(std::string_view reason, bool fault, const void *address) noexcept
+{
+  HANDLE file = CreateFileA(crash_path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(file == INVALID_HANDLE_VALUE)
+    return;
+
+  WriteHeader(reason, fault, address, &file);
+  const USHORT count = CaptureStackBackTrace(0, kMaxFrames, crash_frames, nullptr);
+  for(USHORT i = 0; i < count; ++i)
+  {
+    HMODULE module = nullptr;
+    if(GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, static_cast<LPCSTR>(crash_frames[i]), &module)
+      && GetModuleFileNameA(module, module_path, kMaxPathSize) != 0)
+    {
+      WriteText(module_path, &file);
+      WriteText("+0x", &file);
+      WriteNumber(reinterpret_cast<uintptr_t>(crash_frames[i]) - reinterpret_cast<uintptr_t>(module), 16, &file);
+    }
+    else
+    {
+      WriteText("0x", &file);
+      WriteNumber(reinterpret_cast<uintptr_t>(crash_frames[i]), 16, &file);
+    }
+    WriteText("\n", &file);
+  }
+  WriteLogLines(&file);
+  CloseHandle(file);
+}
+
+LONG WINAPI HandleException(EXCEPTION_POINTERS *exception) noexcept
+{
+  if(!crashing.exchange(true))
+    WriteCrashReport(GetExceptionName(exception->ExceptionRecord->ExceptionCode), true, exception->ExceptionRecord->ExceptionAddress);
+  return EXCEPTION_CONTINUE_SEARCH;
+}
+
+/// abort doesn't raise exception, CRT ends program once handler returns
+void HandleAbort(int) noexcept
+{
+  if(!crashing.exchange(true))
+    WriteCrashReport("SIGABRT", false, nullptr);
+}
+} // namespace
+
+auto InstallCrashHandler(const std::string &path) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  if(path.size() >= kMaxPathSize)
+    return false;
+  CopyPath(path);
+
+  // Stack overflow exception gets that much stack for handler
+  ULONG stack_size = kStackSize;
+  SetThreadStackGuarantee(&stack_size);
+  SetUnhandledExceptionFilter(HandleException);
+  return std::signal(SIGABRT, HandleAbort) != SIG_ERR;
+}
+#elif defined(GAME_OS_LINUX)
+namespace
+{
+constexpr int kSignals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGBUS };
+
+alignas(16) std::byte crash_stack[kStackSize];
+/// Thread that writes crash file, 0 before crash
+std::atomic<pid_t> crashed_thread{0};
+
+void WriteCrashText(const char *text, std::size_t size, void *data) noexcept
+{
+  const int file = *static_cast<int*>(data);
+  while(size != 0)
+  {
+    const ssize_t written = write(file, text, size);
+    if(written <= 0)
+      return;
+    text += written;
+    size -= static_cast<std::size_t>(written);
+  }
+}
+
+auto GetSignalName(int signal) noexcept -> const char*
+{
+  switch(signal)
+  {
+  case SIGSEGV: return "SIGSEGV";
+  case SIGABRT: return "SIGABRT";
+  case SIGFPE: return "SIGFPE";
+  case SIGBUS: return "SIGBUS";
+  default: return "Unknown signal";
+  }
+}
+
+void HandleSignal(int signal, siginfo_t *info, __attribute__((unused)) void *context) noexcept
+{
+  const pid_t thread = static_cast<pid_t>(syscall(SYS_gettid));
+  pid_t expected = 0;
+  if(crashed_thread.compare_exchange_strong(expected, thread))
+  {
+    int file = open(crash_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(file >= 0)
+    {
+      // Abort has sender in place of address
+      WriteHeader(GetSignalName(signal), signal != SIGABRT, info->si_addr, &file);
+      // It was called once at install, so it doesn't load libgcc now
+      const int count = backtrace(crash_frames, kMaxFrames);
+      backtrace_symbols_fd(crash_frames, count, file);
+      WriteLogLines(&file);
+      close(file);
+
+      int error = STDERR_FILENO;
+      WriteText("Crash file was written to ", &error);
+      WriteText(crash_path, &error);
+      WriteText("\n", &error);
+    }
+  }
+  else if(expected != thread)
+  {
+    // Other thread is writing crash file, it ends program once it is done
+    sleep(10);
+  }
+
+  // Handler that crashed itself dies right away, signal is blocked during handler so raised one comes after return
+  std::signal(signal, SIG_DFL);
+  raise(signal);
+}
+} // namespace
+
+auto InstallCrashHandler(const std::string &path) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  if(path.size() >= kMaxPathSize)
+    return false;
+  CopyPath(path);
+  // The first call loads libgcc, which allocates
+  (void)backtrace(crash_frames, kMaxFrames);
+
+  stack_t stack{};
+  stack.ss_sp = crash_stack;
+  stack.ss_size = kStackSize;
+  if(sigaltstack(&stack, nullptr) != 0)
+    return false;
+
+  struct sigaction action{};
+  action.sa_sigaction = HandleSignal;
+  action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+  sigemptyset(&action.sa_mask);
+  bool result = true;
+  for(const int signal : kSignals)
+    result = sigaction(signal, &action, nullptr) == 0 && result;
+  return result;
+}
+#else
+auto InstallCrashHandler(__attribute__((unused)) const std::string &path) noexcept -> bool
+{
+  return false;
+}
+#endif
+} // game
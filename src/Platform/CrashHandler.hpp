@@ -0,0 +1,29 @@
+#ifndef GAME_CRASH_HANDLER_HPP
+#define GAME_CRASH_HANDLER_HPP
+
+#include "Setup.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+
+namespace game
+{
+namespace detail
+{
+/// Global, so frame is set with one relaxed store
+inline std::atomic<uint64_t> crash_frame{0};
+} // detail
+
+/// Write crash file at path when program gets SIGSEGV, SIGABRT, SIGFPE or SIGBUS, then let it die as it would
+/// File has the signal, frame of SetCrashFrame, backtrace and last log lines of Logger::WriteCrashLines
+/// Handler only uses memory that is allocated here, so it works when heap is broken too
+/// Stack overflow is reported only on thread that installed handler, it is the one with alternate stack
+/// return false if path is too long or some handler couldn't be installed
+auto InstallCrashHandler(const std::string &path) noexcept -> bool;
+/// Frame that is written to crash file
+inline void SetCrashFrame(uint64_t frame) noexcept { detail::crash_frame.store(frame, std::memory_order_relaxed); }
+} // game
+
+#endif // GAME_CRASH_HANDLER_HPP
@@ -0,0 +1,53 @@
+#include "FileAllocation.hpp"
+
+#include "Setup.hpp"
+
+#include "Platform/Platform.hpp"
+
+#if defined(GAME_OS_WIN)
+  #include <windows.h>
+#elif defined(GAME_OS_LINUX)
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+
+namespace game
+{
+#if defined(GAME_OS_WIN)
+auto PreallocateFile(const std::string &path, std::size_t size) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  // File is shared, because the one who writes it has it open too
+  const HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(file == INVALID_HANDLE_VALUE)
+    return false;
+
+  FILE_ALLOCATION_INFO info;
+  info.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+  const bool result = SetFileInformationByHandle(file, FileAllocationInfo, &info, sizeof(info));
+  CloseHandle(file);
+  return result;
+}
+#elif defined(GAME_OS_LINUX)
+auto PreallocateFile(const std::string &path, std::size_t size) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  const int file = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  if(file < 0)
+    return false;
+
+  // Unlike posix_fallocate size stays the same, so reader doesn't see zeros at the end
+  const bool result = fallocate(file, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) == 0;
+  close(file);
+  return result;
+}
+#else
+auto PreallocateFile(__attribute__((unused)) const std::string &path, __attribute__((unused)) std::size_t size) noexcept -> bool
+{
+  return false;
+}
+#endif
+} // game
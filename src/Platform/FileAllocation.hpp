@@ -0,0 +1,18 @@
+#ifndef GAME_FILE_ALLOCATION_HPP
+#define GAME_FILE_ALLOCATION_HPP
+
+#include "Setup.hpp"
+
+#include <cstddef>
+#include <string>
+
+
+namespace game
+{
+/// Reserve disk blocks for first size bytes of file without changing its size
+/// Appends then fill blocks that are already there, so file that grows slowly doesn't get fragmented
+/// return false if platform or file system can't do it, file is fine to use either way
+auto PreallocateFile(const std::string &path, std::size_t size) noexcept -> bool;
+} // game
+
+#endif // GAME_FILE_ALLOCATION_HPP
@@ -0,0 +1,207 @@
+#include "FileWatcher.hpp"
+
+#include "Setup.hpp"
+
+#include "Platform/Platform.hpp"
+
+#ifdef GAME_OS_LINUX
+  #include <filesystem>
+  #include <unordered_map>
+  #include <chrono>
+  #include <climits>
+  #include <cerrno>
+  #include <cstring>
+
+  #include <sys/inotify.h>
+  #include <sys/eventfd.h>
+  #include <poll.h>
+  #include <unistd.h>
+#endif
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+#ifdef GAME_OS_LINUX
+namespace
+{
+constexpr uint32_t kFileMask = IN_CLOSE_WRITE | IN_MOVED_TO;
+constexpr uint32_t kDirectoryMask = kFileMask | IN_CREATE | IN_ONLYDIR;
+
+/// Reported paths start with directory, so it is spelled the way assets are loaded, "./res/" becomes "res"
+auto NormalizeDirectory(const std::string &directory) noexcept -> std::string
+{
+  std::string normal = std::filesystem::path(directory).lexically_normal().generic_string();
+  while(normal.size() > 1 && normal.back() == '/')
+    normal.pop_back();
+  return normal;
+}
+} // namespace
+
+auto FileWatcher::Init(EventHandler &events, const std::vector<std::string> &directories, SecondsType debounce) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  Exit();
+  events_ = &events;
+  debounce_ = std::chrono::duration_cast<ClockType::duration>(debounce);
+  watch_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if(watch_fd_ < 0 || wake_fd_ < 0)
+  {
+    GAME_LOG(LogType::Warning) << "Couldn't start file watcher: " << std::strerror(errno);
+    Exit();
+    return false;
+  }
+
+  for(const std::string &directory : directories)
+    AddWatch(NormalizeDirectory(directory));
+  if(directories_.empty())
+  {
+    GAME_LOG(LogType::Warning) << "File watcher has nothing to watch";
+    Exit();
+    return false;
+  }
+
+  RegisterEventTypeName(kAssetChangedEventType, "Asset Changed");
+  thread_ = std::thread(&FileWatcher::ThreadLoop, this);
+  return true;
+}
+
+void FileWatcher::Exit() noexcept
+{
+  if(thread_.joinable())
+  {
+    const uint64_t wake = 1;
+    __attribute__((unused)) const ssize_t written = write(wake_fd_, &wake, sizeof(wake));
+    thread_.join();
+  }
+  if(watch_fd_ >= 0)
+    close(watch_fd_);
+  if(wake_fd_ >= 0)
+    close(wake_fd_);
+  watch_fd_ = -1;
+  wake_fd_ = -1;
+  directories_.clear();
+}
+
+void FileWatcher::AddWatch(const std::string &directory) noexcept
+{
+  const int descriptor = inotify_add_watch(watch_fd_, directory.c_str(), kDirectoryMask);
+  if(descriptor < 0)
+  {
+    GAME_LOG(LogType::Warning) << "Couldn't watch directory " << directory << ": " << std::strerror(errno);
+    return;
+  }
+  if(directories_.size() <= static_cast<std::size_t>(descriptor))
+    directories_.resize(static_cast<std::size_t>(descriptor) + 1);
+  directories_[descriptor] = directory;
+  GAME_LOG(LogType::Info) << "Watching " << directory << " for changes";
+
+  std::error_code error;
+  for(const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory, error))
+    if(entry.is_directory(error))
+      AddWatch(directory + '/' + entry.path().filename().string());
+}
+
+void FileWatcher::ThreadLoop() noexcept
+{
+  #ifdef TRACY_ENABLE
+  tracy::SetThreadName("File Watcher");
+  #endif
+
+  /// Changed paths and time they should be reported at
+  std::unordered_map<std::string, ClockType::time_point> pending;
+  alignas(inotify_event) char buffer[4096];
+  pollfd descriptors[2] = { {watch_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0} };
+  while(true)
+  {
+    // Sleep until the earliest debounced change is due or something happens
+    int timeout = -1;
+    if(!pending.empty())
+    {
+      ClockType::time_point earliest = ClockType::time_point::max();
+      for(const auto &[path, deadline] : pending)
+        earliest = std::min(earliest, deadline);
+      const auto left = std::chrono::ceil<std::chrono::milliseconds>(earliest - ClockType::now()).count();
+      timeout = static_cast<int>(std::clamp<decltype(left)>(left, 0, INT_MAX));
+    }
+    if(poll(descriptors, 2, timeout) < 0 && errno != EINTR)
+    {
+      GAME_LOG(LogType::Error) << "File watcher failed: " << std::strerror(errno);
+      return;
+    }
+    if(descriptors[1].revents & POLLIN)
+      return;
+
+    if(descriptors[0].revents & POLLIN)
+    {
+      ZoneScopedC(0x3e2ed1);
+
+      ssize_t size;
+      while((size = read(watch_fd_, buffer, sizeof(buffer))) > 0)
+      {
+        for(ssize_t offset = 0; offset < size;)
+        {
+          const inotify_event *event = reinterpret_cast<const inotify_event*>(buffer + offset);
+          offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+          if(event->mask & IN_Q_OVERFLOW)
+          {
+            GAME_LOG(LogType::Warning) << "File watcher queue overflowed, some changes are lost";
+            continue;
+          }
+          if(event->len == 0 || event->wd < 0 || static_cast<std::size_t>(event->wd) >= directories_.size())
+            continue;
+
+          std::string path = directories_[event->wd] + '/' + event->name;
+          if(event->mask & IN_ISDIR)
+          {
+            if(event->mask & (IN_CREATE | IN_MOVED_TO))
+              AddWatch(path);
+            continue;
+          }
+          // Created file is reported when it is closed
+          if(event->mask & kFileMask)
+            pending[std::move(path)] = ClockType::now() + debounce_;
+        }
+      }
+    }
+
+    const ClockType::time_point now = ClockType::now();
+    for(auto it = pending.begin(); it != pending.end();)
+    {
+      if(it->second > now)
+      {
+        ++it;
+        continue;
+      }
+      if(it->first.size() > AssetChangedEvent::kMaxPathSize)
+        GAME_LOG(LogType::Warning) << "Changed file path is too long to report: " << it->first;
+      else if(!events_->EnqueCustomEvent<AssetChangedEvent>(kAssetChangedEventType, it->first))
+        GAME_LOG(LogType::Warning) << "Event queue is full, asset changed event is dropped: " << it->first;
+      it = pending.erase(it);
+    }
+  }
+}
+#else
+auto FileWatcher::Init(__attribute__((unused)) EventHandler &events, __attribute__((unused)) const std::vector<std::string> &directories, __attribute__((unused)) SecondsType debounce) noexcept -> bool
+{
+  GAME_LOG(LogType::Warning) << "Watching files is supported only on Linux";
+  return false;
+}
+
+void FileWatcher::Exit() noexcept
+{
+}
+
+void FileWatcher::AddWatch(__attribute__((unused)) const std::string &directory) noexcept
+{
+}
+
+void FileWatcher::ThreadLoop() noexcept
+{
+}
+#endif
+} // game
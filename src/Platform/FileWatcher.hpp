@@ -0,0 +1,83 @@
+#ifndef GAME_FILE_WATCHER_HPP
+#define GAME_FILE_WATCHER_HPP
+
+#include "Setup.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "Core/EventHandler.hpp"
+#include "Utils/Hash.hpp"
+#include "Utils/Time.hpp"
+
+
+namespace game
+{
+/// Custom event that is enqued when watched file was changed on disk, payload is AssetChangedEvent
+constexpr inline EventType kAssetChangedEventType = static_cast<EventType>(Event::kCustomTypeBitMask | 0x101);
+
+struct AssetChangedEvent
+{
+  static constexpr inline std::size_t kMaxPathSize = 256;
+
+  inline explicit AssetChangedEvent(std::string_view changed_path) noexcept
+  : path_hash(HashString(changed_path))
+  , path_size(static_cast<uint32_t>(std::min(changed_path.size(), kMaxPathSize)))
+  { std::copy_n(changed_path.data(), path_size, path); }
+
+  [[nodiscard]] inline auto GetPath() const noexcept -> std::string_view { return std::string_view(path, path_size); }
+
+  /// HashString of path, same as the one asset was loaded with
+  uint32_t path_hash;
+  uint32_t path_size;
+  /// Path in form watched directory / relative path with '/' separators, not null terminated
+  char path[kMaxPathSize];
+};
+
+/// Watches directories for changed files on background thread
+///
+/// Change is reported once writes to file stop for debounce time, so editors that save in several steps
+/// or tools that write file in chunks cause one reload
+/// Files are reported when they are closed after writing or moved into watched directory
+/// Only Linux is supported for now, Init fails on other platforms
+/// Nothing is started unless Init is called, so disabled watcher costs nothing
+class FileWatcher
+{
+public:
+  static constexpr inline double kDefDebounceMs = 100.0;
+
+  FileWatcher() noexcept = default;
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+  inline ~FileWatcher() noexcept { Exit(); }
+
+  /// Watch directories recursively and start watcher thread
+  /// Directories are normalized, so "./res/" reports same paths as "res"
+  /// return false if watching isn't supported or none of directories can be watched
+  [[nodiscard]] auto Init(EventHandler &events, const std::vector<std::string> &directories, SecondsType debounce = SecondsType(kDefDebounceMs / 1000.0)) noexcept -> bool;
+  /// Stop watcher thread, changes that are still debounced are dropped
+  void Exit() noexcept;
+
+  [[nodiscard]] inline auto IsRunning() const noexcept -> bool { return thread_.joinable(); }
+
+private:
+  /// Watch directory and every directory inside it
+  void AddWatch(const std::string &directory) noexcept;
+  void ThreadLoop() noexcept;
+
+  EventHandler *events_ = nullptr;
+  ClockType::duration debounce_ = ClockType::duration::zero();
+  /// inotify descriptor
+  int watch_fd_ = -1;
+  /// Written by Exit to wake the thread
+  int wake_fd_ = -1;
+  /// Path of each watched directory indexed by watch descriptor, used only by watcher thread after Init
+  std::vector<std::string> directories_;
+  std::thread thread_;
+};
+} // game
+
+#endif // GAME_FILE_WATCHER_HPP
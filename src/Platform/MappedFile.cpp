@@ -0,0 +1,102 @@
+#include "MappedFile.hpp"
+
+#include "Setup.hpp"
+
+#include "Platform/Platform.hpp"
+
+#ifdef GAME_OS_WIN
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+
+namespace game
+{
+#ifdef GAME_OS_WIN
+auto MappedFile::Open(const std::string &path) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  Close();
+  const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+  if(file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  // Mapping keeps file open, so its handle isn't needed anymore
+  const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if(mapping == nullptr)
+    return false;
+
+  const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if(view == nullptr)
+  {
+    CloseHandle(mapping);
+    return false;
+  }
+
+  mapping_ = mapping;
+  data_ = static_cast<const std::byte*>(view);
+  size_ = static_cast<std::size_t>(size.QuadPart);
+  return true;
+}
+
+void MappedFile::Close() noexcept
+{
+  if(data_ == nullptr)
+    return;
+  UnmapViewOfFile(data_);
+  CloseHandle(mapping_);
+  data_ = nullptr;
+  size_ = 0;
+  mapping_ = nullptr;
+}
+#else
+auto MappedFile::Open(const std::string &path) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  Close();
+  const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if(file < 0)
+    return false;
+
+  struct stat status;
+  if(fstat(file, &status) != 0 || status.st_size == 0)
+  {
+    close(file);
+    return false;
+  }
+
+  // Mapping keeps file open, so descriptor isn't needed anymore
+  void *view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if(view == MAP_FAILED)
+    return false;
+
+  data_ = static_cast<const std::byte*>(view);
+  size_ = static_cast<std::size_t>(status.st_size);
+  return true;
+}
+
+void MappedFile::Close() noexcept
+{
+  if(data_ == nullptr)
+    return;
+  munmap(const_cast<std::byte*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+#endif
+} // game
@@ -0,0 +1,39 @@
+#ifndef GAME_MAPPED_FILE_HPP
+#define GAME_MAPPED_FILE_HPP
+
+#include "Setup.hpp"
+
+#include <string>
+#include <cstddef>
+
+
+namespace game
+{
+/// Read only memory mapping of a whole file
+/// Pages are loaded by OS on first access, so opening doesn't read the file
+class MappedFile
+{
+public:
+  MappedFile() noexcept = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  inline ~MappedFile() noexcept { Close(); }
+
+  /// Map file, mapping that was opened before is closed
+  /// return false if file can't be opened or mapped
+  [[nodiscard]] auto Open(const std::string &path) noexcept -> bool;
+  void Close() noexcept;
+
+  [[nodiscard]] constexpr inline auto IsOpen() const noexcept -> bool { return data_ != nullptr; }
+  [[nodiscard]] constexpr inline auto GetData() const noexcept -> const std::byte* { return data_; }
+  [[nodiscard]] constexpr inline auto GetSize() const noexcept -> std::size_t { return size_; }
+
+private:
+  const std::byte *data_ = nullptr;
+  std::size_t size_ = 0;
+  /// File mapping object, only used on Windows
+  void *mapping_ = nullptr;
+};
+} // game
+
+#endif // GAME_MAPPED_FILE_HPP
@@ -0,0 +1,37 @@
+#ifndef GAME_NULL_RENDERER
+#define GAME_NULL_RENDERER
+
+#include "Setup.hpp"
+
+#include <vector>
+
+#include "Core/Renderer.hpp"
+
+
+namespace game
+{
+class Game;
+
+/// Renderer that draws nothing
+/// Used in headless mode, where there is no window and no graphics context
+class NullRenderer : public Renderer
+{
+  friend Renderer;
+public:
+  void Init(__attribute__((unused)) Game &game) noexcept override {}
+  /// Textures are never uploaded, so their pixels are dropped
+  void Render(__attribute__((unused)) float alpha) noexcept override { queue_.Clear(); textures_.TakeUploads(uploads_); uploads_.clear(); }
+  void Exit() noexcept override {}
+
+  auto IsHeadless() const noexcept -> bool override { return true; }
+  int GetSDLWindowFlags() const noexcept override { return 0; }
+
+private:
+  NullRenderer() noexcept = default;
+
+  /// Kept between frames, so dropping uploads doesn't allocate
+  std::vector<TextureUpload> uploads_;
+};
+} // game
+
+#endif
@@ -0,0 +1,65 @@
+#include "Framebuffer.hpp"
+
+#include "Setup.hpp"
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+auto Framebuffer::Init(GLState &state, int width, int height) noexcept -> bool
+{
+  ZoneScopedC(0x07dbd4);
+
+  state_ = &state;
+  GL_CALL(glCreateFramebuffers(1, &framebuffer_));
+  return Resize(width, height);
+}
+
+void Framebuffer::Exit() noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  if(framebuffer_ == 0)
+    return;
+  // Deleted framebuffer is unbound by driver, shadow should follow
+  state_->BindFramebuffer(0);
+  GL_CALL(glDeleteFramebuffers(1, &framebuffer_));
+  GL_CALL(glDeleteRenderbuffers(1, &color_));
+  GL_CALL(glDeleteRenderbuffers(1, &depth_));
+  framebuffer_ = 0;
+  color_ = 0;
+  depth_ = 0;
+  width_ = 0;
+  height_ = 0;
+}
+
+auto Framebuffer::Resize(int width, int height) noexcept -> bool
+{
+  // Minimized window has no pixels, old attachments are kept until it has them again
+  if(width <= 0 || height <= 0 || (width == width_ && height == height_))
+    return true;
+
+  ZoneScopedC(0x07dbd4);
+
+  // Immutable storage can't be resized, so attachments are created anew
+  GL_CALL(glDeleteRenderbuffers(1, &color_));
+  GL_CALL(glDeleteRenderbuffers(1, &depth_));
+  GL_CALL(glCreateRenderbuffers(1, &color_));
+  GL_CALL(glCreateRenderbuffers(1, &depth_));
+  GL_CALL(glNamedRenderbufferStorage(color_, GL_RGBA8, width, height));
+  GL_CALL(glNamedRenderbufferStorage(depth_, GL_DEPTH_COMPONENT24, width, height));
+  GL_CALL(glNamedFramebufferRenderbuffer(framebuffer_, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_));
+  GL_CALL(glNamedFramebufferRenderbuffer(framebuffer_, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_));
+  width_ = width;
+  height_ = height;
+
+  const GLenum status = glCheckNamedFramebufferStatus(framebuffer_, GL_FRAMEBUFFER);
+  if(status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    GAME_LOG(LogType::Error) << "Offscreen framebuffer " << width << "x" << height << " isn't complete: " << status;
+    return false;
+  }
+  return true;
+}
+} // game
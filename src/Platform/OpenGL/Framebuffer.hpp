@@ -0,0 +1,44 @@
+#ifndef GAME_FRAMEBUFFER_HPP
+#define GAME_FRAMEBUFFER_HPP
+
+#include "Setup.hpp"
+
+#include "Platform/OpenGL/OpenGL.hpp"
+#include "Platform/OpenGL/GLState.hpp"
+
+
+namespace game
+{
+/// Offscreen render target with RGBA8 color and 24 bit depth
+///
+/// Used instead of window back buffer when there is no display to show frames on
+class Framebuffer
+{
+public:
+  Framebuffer() noexcept = default;
+  Framebuffer(const Framebuffer &) = delete;
+  Framebuffer &operator=(const Framebuffer &) = delete;
+
+  /// return false if driver can't make complete framebuffer of this size
+  auto Init(GLState &state, int width, int height) noexcept -> bool;
+  void Exit() noexcept;
+  /// Recreate attachments if size is different, contents are lost then
+  /// Empty size is ignored, so framebuffer of minimized window keeps its last size
+  auto Resize(int width, int height) noexcept -> bool;
+
+  /// Handle for GLState::BindFramebuffer, 0 before Init
+  [[nodiscard]] constexpr inline auto GetHandle() const noexcept -> GLuint { return framebuffer_; }
+  [[nodiscard]] constexpr inline auto GetWidth() const noexcept -> int { return width_; }
+  [[nodiscard]] constexpr inline auto GetHeight() const noexcept -> int { return height_; }
+
+private:
+  GLState *state_ = nullptr;
+  GLuint framebuffer_ = 0;
+  GLuint color_ = 0;
+  GLuint depth_ = 0;
+  int width_ = 0;
+  int height_ = 0;
+};
+} // game
+
+#endif // GAME_FRAMEBUFFER_HPP
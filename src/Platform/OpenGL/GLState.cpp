@@ -0,0 +1,70 @@
+#include "GLState.hpp"
+
+#include "Setup.hpp"
+
+#include <string_view>
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+namespace
+{
+void APIENTRY DebugCallback(__attribute__((unused)) GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, __attribute__((unused)) const void *data)
+{
+  if(severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+    return;
+  const std::string_view text(message, length < 0 ? std::char_traits<char>::length(message) : static_cast<std::size_t>(length));
+  // Log types are compile time constants, so they can be compiled out
+  if(type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH)
+    GAME_LOG(LogType::Error) << "OpenGL " << id << ": " << text;
+  else
+    GAME_LOG(LogType::Warning) << "OpenGL " << id << ": " << text;
+}
+} // namespace
+
+auto GLState::Init(bool debug_output) noexcept -> bool
+{
+  ZoneScopedC(0x07dbd4);
+
+  Invalidate();
+  if(!debug_output || !GLAD_GL_KHR_debug)
+    return false;
+
+  GL_CALL(glEnable(GL_DEBUG_OUTPUT));
+  // Synchronous output reports error on the stack of the call that caused it, which is what polling gave
+  #ifndef NDEBUG
+  GL_CALL(glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS));
+  #endif
+  GL_CALL(glDebugMessageCallback(DebugCallback, nullptr));
+  detail::gl_poll_errors = false;
+  GAME_LOG(LogType::Info) << "OpenGL errors are reported by debug callback";
+  return true;
+}
+
+void GLState::Invalidate() noexcept
+{
+  program_ = kUnknown;
+  active_unit_ = kUnknown;
+  textures_ = MakeUnknownTextures();
+  vertex_array_ = kUnknown;
+  array_buffer_ = kUnknown;
+  pixel_pack_buffer_ = kUnknown;
+  framebuffer_ = kUnknown;
+  blend_ = kUnknown;
+  blend_source_ = kUnknown;
+  blend_destination_ = kUnknown;
+  depth_test_ = kUnknown;
+  depth_func_ = kUnknown;
+  viewport_known_ = false;
+}
+
+void GLState::EndFrame() noexcept
+{
+  TracyPlot("GL state calls issued", static_cast<int64_t>(issued_));
+  TracyPlot("GL state calls skipped", static_cast<int64_t>(skipped_));
+  issued_ = 0;
+  skipped_ = 0;
+}
+} // game
@@ -0,0 +1,204 @@
+#ifndef GAME_GL_STATE_HPP
+#define GAME_GL_STATE_HPP
+
+#include "Setup.hpp"
+
+#include <array>
+
+#include "Platform/OpenGL/OpenGL.hpp"
+
+
+namespace game
+{
+/// Shadow copy of GL bindings and fixed function state
+///
+/// Calls that would set state to the value it already has are skipped
+/// Code that changes tracked state with plain GL calls should call Invalidate afterwards
+/// Should be used only on thread with current GL context
+class GLState
+{
+public:
+  static constexpr inline std::size_t kTextureUnitCount = 8;
+
+  /// Install KHR_debug callback when debug_output is true and driver has it, errors aren't polled after every call then
+  /// return true if callback is installed
+  auto Init(bool debug_output) noexcept -> bool;
+  /// Forget every shadowed value, so next call of each setter reaches the driver
+  void Invalidate() noexcept;
+  /// Plot issued and skipped calls of the frame and reset counters
+  void EndFrame() noexcept;
+
+  inline void UseProgram(GLuint program) noexcept;
+  /// Bind 2D texture to unit
+  inline void BindTexture(GLuint unit, GLuint texture) noexcept;
+  /// Delete texture, bindings to it are reset the same way driver resets them
+  inline void DeleteTexture(GLuint texture) noexcept;
+  inline void BindVertexArray(GLuint vertex_array) noexcept;
+  inline void BindArrayBuffer(GLuint buffer) noexcept;
+  inline void BindPixelPackBuffer(GLuint buffer) noexcept;
+  /// Bind framebuffer for both drawing and reading, 0 is window
+  inline void BindFramebuffer(GLuint framebuffer) noexcept;
+  inline void SetBlend(bool enabled) noexcept;
+  inline void SetBlendFunc(GLenum source, GLenum destination) noexcept;
+  inline void SetDepthTest(bool enabled) noexcept;
+  inline void SetDepthFunc(GLenum function) noexcept;
+  inline void SetViewport(GLint x, GLint y, GLsizei width, GLsizei height) noexcept;
+
+  /// Calls since last EndFrame
+  [[nodiscard]] constexpr inline auto GetIssuedCount() const noexcept -> uint32_t { return issued_; }
+  [[nodiscard]] constexpr inline auto GetSkippedCount() const noexcept -> uint32_t { return skipped_; }
+
+private:
+  static constexpr inline GLuint kUnknown = ~GLuint{0};
+
+  /// Count call and return true if it should be issued
+  inline auto Changed(GLuint &shadow, GLuint value) noexcept -> bool;
+  [[nodiscard]] static constexpr inline auto MakeUnknownTextures() noexcept -> std::array<GLuint, kTextureUnitCount>
+  {
+    std::array<GLuint, kTextureUnitCount> textures{};
+    for(GLuint &texture : textures)
+      texture = kUnknown;
+    return textures;
+  }
+
+  GLuint program_ = kUnknown;
+  GLuint active_unit_ = kUnknown;
+  std::array<GLuint, kTextureUnitCount> textures_ = MakeUnknownTextures();
+  GLuint vertex_array_ = kUnknown;
+  GLuint array_buffer_ = kUnknown;
+  GLuint pixel_pack_buffer_ = kUnknown;
+  GLuint framebuffer_ = kUnknown;
+  GLuint blend_ = kUnknown;
+  GLuint blend_source_ = kUnknown;
+  GLuint blend_destination_ = kUnknown;
+  GLuint depth_test_ = kUnknown;
+  GLuint depth_func_ = kUnknown;
+  std::array<GLint, 4> viewport_{};
+  bool viewport_known_ = false;
+
+  uint32_t issued_ = 0;
+  uint32_t skipped_ = 0;
+};
+
+
+
+inline auto GLState::Changed(GLuint &shadow, GLuint value) noexcept -> bool
+{
+  if(shadow == value)
+  {
+    ++skipped_;
+    return false;
+  }
+  shadow = value;
+  ++issued_;
+  return true;
+}
+
+inline void GLState::UseProgram(GLuint program) noexcept
+{
+  if(Changed(program_, program))
+    GL_CALL(glUseProgram(program));
+}
+
+inline void GLState::BindTexture(GLuint unit, GLuint texture) noexcept
+{
+  GAME_ASSERT(unit < kTextureUnitCount) << "Texture unit " << unit << " isn't tracked";
+  if(textures_[unit] == texture)
+  {
+    ++skipped_;
+    return;
+  }
+  if(Changed(active_unit_, unit))
+    GL_CALL(glActiveTexture(GL_TEXTURE0 + unit));
+  textures_[unit] = texture;
+  ++issued_;
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
+}
+
+inline void GLState::DeleteTexture(GLuint texture) noexcept
+{
+  GL_CALL(glDeleteTextures(1, &texture));
+  for(GLuint &bound : textures_)
+    if(bound == texture)
+      bound = 0;
+}
+
+inline void GLState::BindVertexArray(GLuint vertex_array) noexcept
+{
+  if(Changed(vertex_array_, vertex_array))
+    GL_CALL(glBindVertexArray(vertex_array));
+}
+
+inline void GLState::BindArrayBuffer(GLuint buffer) noexcept
+{
+  if(Changed(array_buffer_, buffer))
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+}
+
+inline void GLState::BindPixelPackBuffer(GLuint buffer) noexcept
+{
+  if(Changed(pixel_pack_buffer_, buffer))
+    GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer));
+}
+
+inline void GLState::BindFramebuffer(GLuint framebuffer) noexcept
+{
+  if(Changed(framebuffer_, framebuffer))
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+}
+
+inline void GLState::SetBlend(bool enabled) noexcept
+{
+  if(!Changed(blend_, enabled))
+    return;
+  if(enabled)
+    GL_CALL(glEnable(GL_BLEND));
+  else
+    GL_CALL(glDisable(GL_BLEND));
+}
+
+inline void GLState::SetBlendFunc(GLenum source, GLenum destination) noexcept
+{
+  if(blend_source_ == source && blend_destination_ == destination)
+  {
+    ++skipped_;
+    return;
+  }
+  blend_source_ = source;
+  blend_destination_ = destination;
+  ++issued_;
+  GL_CALL(glBlendFunc(source, destination));
+}
+
+inline void GLState::SetDepthTest(bool enabled) noexcept
+{
+  if(!Changed(depth_test_, enabled))
+    return;
+  if(enabled)
+    GL_CALL(glEnable(GL_DEPTH_TEST));
+  else
+    GL_CALL(glDisable(GL_DEPTH_TEST));
+}
+
+inline void GLState::SetDepthFunc(GLenum function) noexcept
+{
+  if(Changed(depth_func_, function))
+    GL_CALL(glDepthFunc(function));
+}
+
+inline void GLState::SetViewport(GLint x, GLint y, GLsizei width, GLsizei height) noexcept
+{
+  const std::array<GLint, 4> viewport = { x, y, width, height };
+  if(viewport_known_ && viewport_ == viewport)
+  {
+    ++skipped_;
+    return;
+  }
+  viewport_ = viewport;
+  viewport_known_ = true;
+  ++issued_;
+  GL_CALL(glViewport(x, y, width, height));
+}
+} // game
+
+#endif // GAME_GL_STATE_HPP
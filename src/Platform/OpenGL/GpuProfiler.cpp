@@ -0,0 +1,183 @@
+#include "GpuProfiler.hpp"
+
+#include "Setup.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+auto GpuProfiler::Init() noexcept -> bool
+{
+  ZoneScopedC(0x07dbd4);
+
+  supported_ = false;
+  GLint bits = 0;
+  if(GLAD_GL_ARB_timer_query)
+    GL_CALL(glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits));
+  // Zero bits is how drivers without real timer say that timestamps are meaningless
+  if(bits == 0)
+  {
+    GAME_LOG(LogType::Info) << "GPU timer queries aren't supported, GPU time of passes isn't measured";
+    return false;
+  }
+
+  queries_.resize(kFrameCount * kMaxScopeCount * 2);
+  GL_CALL(glGenQueries(static_cast<GLsizei>(queries_.size()), queries_.data()));
+  frames_ = {};
+  frame_ = 0;
+  collected_ = 0;
+  dropped_frames_ = 0;
+  supported_ = true;
+  return true;
+}
+
+void GpuProfiler::Exit() noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  if(!queries_.empty())
+    GL_CALL(glDeleteQueries(static_cast<GLsizei>(queries_.size()), queries_.data()));
+  queries_.clear();
+  supported_ = false;
+}
+
+void GpuProfiler::BeginFrame() noexcept
+{
+  if(!supported_)
+    return;
+
+  ZoneScopedC(0x07dbd4);
+
+  // Tracy keeps GPU context per thread, so it is created on thread that renders
+  if(!tracy_context_)
+  {
+    TracyGpuContext;
+    tracy_context_ = true;
+  }
+
+  Collect();
+  if(frame_ - collected_ >= kFrameCount)
+  {
+    // GPU is more than kFrameCount frames behind, waiting for it would stall the frame
+    ++dropped_frames_;
+    collected_ = frame_ - kFrameCount + 1;
+  }
+  frames_[frame_ % kFrameCount].scope_count = 0;
+}
+
+void GpuProfiler::EndFrame() noexcept
+{
+  if(!supported_)
+    return;
+
+  ++frame_;
+  TracyGpuCollect;
+}
+
+auto GpuProfiler::BeginPass(const char *name) noexcept -> uint32_t
+{
+  if(!supported_)
+    return kNoScope;
+
+  Frame &frame = frames_[frame_ % kFrameCount];
+  const uint32_t pass = FindPass(name);
+  if(frame.scope_count == kMaxScopeCount || pass == kNoScope)
+    return kNoScope;
+
+  const uint32_t scope = frame.scope_count++;
+  frame.passes[scope] = pass;
+  frame.last_query = GetQuery(frame_, scope, false);
+  GL_CALL(glQueryCounter(frame.last_query, GL_TIMESTAMP));
+  return scope;
+}
+
+void GpuProfiler::EndPass(uint32_t scope) noexcept
+{
+  if(scope == kNoScope)
+    return;
+
+  Frame &frame = frames_[frame_ % kFrameCount];
+  frame.last_query = GetQuery(frame_, scope, true);
+  GL_CALL(glQueryCounter(frame.last_query, GL_TIMESTAMP));
+}
+
+auto GpuProfiler::FindPass(const char *name) noexcept -> uint32_t
+{
+  for(uint32_t pass = 0; pass < pass_count_; ++pass)
+    if(passes_[pass].name == name || std::strcmp(passes_[pass].name, name) == 0)
+      return pass;
+  if(pass_count_ == kMaxPassCount)
+    return kNoScope;
+
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  passes_[pass_count_].name = name;
+  return static_cast<uint32_t>(pass_count_++);
+}
+
+void GpuProfiler::Collect() noexcept
+{
+  for(; collected_ < frame_; ++collected_)
+  {
+    const Frame &frame = frames_[collected_ % kFrameCount];
+    if(frame.scope_count == 0)
+      continue;
+
+    GLint available = GL_FALSE;
+    GL_CALL(glGetQueryObjectiv(frame.last_query, GL_QUERY_RESULT_AVAILABLE, &available));
+    if(!available)
+      return;
+
+    std::array<uint64_t, kMaxPassCount> durations{};
+    std::array<bool, kMaxPassCount> measured{};
+    for(uint32_t scope = 0; scope < frame.scope_count; ++scope)
+    {
+      GLuint64 begin;
+      GLuint64 end;
+      GL_CALL(glGetQueryObjectui64v(GetQuery(collected_, scope, false), GL_QUERY_RESULT, &begin));
+      GL_CALL(glGetQueryObjectui64v(GetQuery(collected_, scope, true), GL_QUERY_RESULT, &end));
+      durations[frame.passes[scope]] += end > begin ? end - begin : 0;
+      measured[frame.passes[scope]] = true;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    for(std::size_t pass = 0; pass < pass_count_; ++pass)
+    {
+      if(!measured[pass])
+        continue;
+      Pass &stats = passes_[pass];
+      stats.history[stats.sample_count % kHistorySize] = static_cast<float>(static_cast<double>(durations[pass]) / 1'000'000.0);
+      ++stats.sample_count;
+    }
+  }
+}
+
+void GpuProfiler::GetStats(std::vector<GpuPassStats> &stats) const noexcept
+{
+  stats.clear();
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  for(std::size_t pass = 0; pass < pass_count_; ++pass)
+  {
+    const Pass &source = passes_[pass];
+    if(source.sample_count == 0)
+      continue;
+
+    const std::size_t count = std::min(source.sample_count, kHistorySize);
+    const auto [min, max] = std::minmax_element(source.history.begin(), source.history.begin() + count);
+    double sum = 0.0;
+    for(std::size_t i = 0; i < count; ++i)
+      sum += source.history[i];
+
+    GpuPassStats &result = stats.emplace_back();
+    result.name = source.name;
+    result.last_ms = source.history[(source.sample_count - 1) % kHistorySize];
+    result.average_ms = sum / static_cast<double>(count);
+    result.min_ms = *min;
+    result.max_ms = *max;
+    result.sample_count = count;
+  }
+}
+} // game
@@ -0,0 +1,121 @@
+#ifndef GAME_GPU_PROFILER_HPP
+#define GAME_GPU_PROFILER_HPP
+
+#include "Setup.hpp"
+
+#include <array>
+#include <vector>
+#include <mutex>
+
+#include "Core/Renderer.hpp"
+#include "Platform/OpenGL/OpenGL.hpp"
+
+#include <tracy/TracyOpenGL.hpp>
+
+
+#define GAME_GPU_ZONE_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define GAME_GPU_ZONE_CONCAT(lhs, rhs) GAME_GPU_ZONE_CONCAT_IMPL(lhs, rhs)
+/// Time GPU commands until end of scope in Tracy and in profiler stats, name should be string literal
+/// Zones can be nested, names of their variables are unique per line
+#define GAME_GPU_ZONE(profiler, name) \
+  TracyGpuNamedZone(GAME_GPU_ZONE_CONCAT(game_gpu_tracy_zone_, __LINE__), name, (profiler).IsSupported()); \
+  const ::game::GpuProfiler::Scope GAME_GPU_ZONE_CONCAT(game_gpu_zone_, __LINE__)((profiler), name)
+
+namespace game
+{
+/// Measures GPU time of render passes with GL_TIMESTAMP queries
+///
+/// Queries of each frame are kept in a ring and read only when driver says they are available,
+/// so measuring never waits for GPU. Frame that is still pending when its queries are needed again is dropped
+/// Without timer queries (some software rasterizers) every call does nothing and stats stay empty
+/// Should be used only on thread with current GL context, except GetStats
+class GpuProfiler
+{
+public:
+  /// Frames that can have queries in flight
+  static constexpr inline std::size_t kFrameCount = 4;
+  /// Scopes measured per frame, scopes over it are ignored
+  static constexpr inline std::size_t kMaxScopeCount = 32;
+  /// Different pass names, passes over it are ignored
+  static constexpr inline std::size_t kMaxPassCount = 16;
+  /// Frames rolling stats are computed over
+  static constexpr inline std::size_t kHistorySize = 120;
+  static constexpr inline uint32_t kNoScope = ~uint32_t{0};
+
+  /// Measures commands between its construction and destruction
+  class Scope
+  {
+  public:
+    inline Scope(GpuProfiler &profiler, const char *name) noexcept : profiler_(profiler), scope_(profiler.BeginPass(name)) {}
+    inline ~Scope() noexcept { profiler_.EndPass(scope_); }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    GpuProfiler &profiler_;
+    uint32_t scope_;
+  };
+
+  /// Create queries if driver has timer queries with nonzero counter bits
+  /// return false if GPU time can't be measured
+  auto Init() noexcept -> bool;
+  void Exit() noexcept;
+
+  /// Read results of frames that GPU has finished, should be called before passes of the frame
+  void BeginFrame() noexcept;
+  /// Should be called after last pass of the frame, usually after swap
+  void EndFrame() noexcept;
+  /// Put timestamp before commands of pass, passes with the same name are summed in a frame and can be nested
+  /// return scope for EndPass, kNoScope if it isn't measured
+  auto BeginPass(const char *name) noexcept -> uint32_t;
+  void EndPass(uint32_t scope) noexcept;
+
+  /// Rolling stats of every pass that has results, thread safe
+  void GetStats(std::vector<GpuPassStats> &stats) const noexcept;
+
+  [[nodiscard]] constexpr inline auto IsSupported() const noexcept -> bool { return supported_; }
+  /// Frames whose results weren't ready before their queries were reused
+  [[nodiscard]] constexpr inline auto GetDroppedFrameCount() const noexcept -> uint64_t { return dropped_frames_; }
+
+private:
+  struct Frame
+  {
+    std::array<uint32_t, kMaxScopeCount> passes;
+    uint32_t scope_count = 0;
+    /// Query issued last, all other results are ready once it is
+    GLuint last_query = 0;
+  };
+
+  struct Pass
+  {
+    const char *name = nullptr;
+    std::array<float, kHistorySize> history{};
+    std::size_t sample_count = 0;
+  };
+
+  /// Query of scope begin or end in ring slot of frame
+  [[nodiscard]] inline auto GetQuery(uint64_t frame, uint32_t scope, bool end) const noexcept -> GLuint
+  { return queries_[((frame % kFrameCount) * kMaxScopeCount + scope) * 2 + end]; }
+  /// return kNoScope if there is no room for new pass
+  auto FindPass(const char *name) noexcept -> uint32_t;
+  /// Read finished frames in order, stops at the first one GPU is still working on
+  void Collect() noexcept;
+
+  bool supported_ = false;
+  bool tracy_context_ = false;
+  std::vector<GLuint> queries_;
+  std::array<Frame, kFrameCount> frames_;
+  /// Frame that is recorded now
+  uint64_t frame_ = 0;
+  /// First frame whose results weren't read yet
+  uint64_t collected_ = 0;
+  uint64_t dropped_frames_ = 0;
+
+  /// Written only by thread that renders, guarded for GetStats
+  mutable std::mutex stats_mutex_;
+  std::array<Pass, kMaxPassCount> passes_;
+  std::size_t pass_count_ = 0;
+};
+} // game
+
+#endif // GAME_GPU_PROFILER_HPP
@@ -0,0 +1,31 @@
+#ifndef GAME_OPEN_GL_HPP
+#define GAME_OPEN_GL_HPP
+
+#include "Setup.hpp"
+
+#include "glad/glad.h"
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+namespace detail
+{
+/// Errors are polled after every GL_CALL in debug builds until GLState::Init installs debug callback
+inline bool gl_poll_errors = true;
+} // detail
+} // game
+
+#ifndef NDEBUG
+#define GL_CALL(call) do { \
+    call; \
+    if(::game::detail::gl_poll_errors) \
+      while(int error = glGetError()) \
+        GAME_DLOG(LogType::Error) << "OpenGL error: " << error; \
+  } while(0)
+#else
+#define GL_CALL(call) call
+#endif
+
+#endif // GAME_OPEN_GL_HPP
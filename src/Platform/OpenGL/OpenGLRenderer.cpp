@@ -1,23 +1,20 @@
 #include "OpenGLRenderer.hpp"
 
-#include "glad/glad.h"
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <utility>
+#include <chrono>
+
 #include "SDL2/SDL.h"
 
 #include "Setup.hpp"
 #include "Core/Game.hpp"
+#include "Utils/FlagParser.hpp"
 #include "Core/Window.hpp"
 #include "Utils/Logger.hpp"
-
-
-#ifndef NDEBUG
-#define GL_CALL(call) do { \
-    call; \
-    while(int error = glGetError()) \
-      GAME_DLOG(LogType::Error) << "OpenGL error: " << error; \
-  } while(0)
-#else
-#define GL_CALL(call) call
-#endif
+#include "Utils/Time.hpp"
+#include "Platform/OpenGL/OpenGL.hpp"
 
 namespace game
 {
@@ -26,10 +23,13 @@ OpenGLRenderer::OpenGLRenderer() noexcept
   ZoneScopedC(0x07dbd4);
 
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 6);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_COMPATIBILITY);
   SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
   SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+  #ifndef NDEBUG
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+  #endif
 }
 
 void OpenGLRenderer::PrintDebugInfo() const noexcept
@@ -44,42 +44,392 @@ void OpenGLRenderer::Init(Game &game) noexcept
 {
   ZoneScopedC(0x07dbd4);
 
-  game_ = &game;
-  context_ = SDL_GL_CreateContext(game_->GetWindow().GetSDLWindow());
+  Init(game.GetWindow().GetSDLWindow(), game.GetFlags());
+}
+
+void OpenGLRenderer::Init(SDL_Window *window, const Flags &flags) noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  window_ = window;
+  context_ = SDL_GL_CreateContext(window_);
   GAME_ASSERT(context_ != nullptr) << "Couldn't initialize opengl context: " << SDL_GetError();
   if(!gladLoadGLLoader(SDL_GL_GetProcAddress))
     GAME_ASSERT(false) << "Failed to load GL loader";
 
   PrintDebugInfo();
 
+  #ifndef NDEBUG
+  const bool debug_output = !flags.Contains("-gl-error-polling");
+  #else
+  const bool debug_output = flags.Contains("-gl-debug") && !flags.Contains("-gl-error-polling");
+  #endif
+  gl_state_.Init(debug_output);
+  gpu_profiler_.Init();
+
   GL_CALL(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+  gl_state_.SetBlend(true);
+  gl_state_.SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  shaders_.Init(flags.Contains("-no-shader-cache") ? "" : flags.Contains("-shader-cache") ? flags.Get("-shader-cache") : ShaderCache::kDefCacheDirectory);
+  sprite_renderer_.Init(shaders_, gl_state_);
+  readback_.Init(gl_state_);
+  if(offscreen_)
+  {
+    int width;
+    int height;
+    SDL_GL_GetDrawableSize(window_, &width, &height);
+    offscreen_ = framebuffer_.Init(gl_state_, width, height);
+    GAME_LOG(LogType::Info) << (offscreen_ ? "Rendering offscreen" : "Couldn't create offscreen framebuffer, rendering into hidden window");
+  }
+  upload_budget_ = std::chrono::duration_cast<ClockType::duration>(SecondsType(flags.GetPositiveNumber("-upload-budget", kDefUploadBudgetMs) / 1000.0));
+
+  threaded_ = flags.Contains("-render-thread") && StartRenderThread();
+  if(threaded_)
+  {
+    frame_latency_ = std::clamp<std::size_t>(static_cast<std::size_t>(flags.GetPositiveNumber("-frame-latency", 1.0)), 1, kMaxFrameLatency);
+    GAME_LOG(LogType::Info) << "Rendering on separate thread with frame latency: " << frame_latency_;
+  }
+}
+
+auto OpenGLRenderer::StartRenderThread() noexcept -> bool
+{
+  ZoneScopedC(0x07dbd4);
+
+  // Context can be current only on one thread at a time
+  if(SDL_GL_MakeCurrent(window_, nullptr) != 0)
+  {
+    GAME_LOG(LogType::Error) << "Couldn't release GL context for render thread, rendering on main thread: " << SDL_GetError();
+    return false;
+  }
+
+  std::unique_lock<std::mutex> lock(frame_mutex_);
+  render_thread_running_ = true;
+  render_thread_started_ = false;
+  render_thread_ = std::thread(&OpenGLRenderer::RenderThreadLoop, this);
+  frame_condition_.wait(lock, [this]{ return render_thread_started_; });
+  if(render_thread_current_)
+    return true;
+  lock.unlock();
+
+  // Render thread has already returned, context goes back to main thread
+  render_thread_.join();
+  render_thread_running_ = false;
+  __attribute__((unused)) const bool current = SDL_GL_MakeCurrent(window_, context_) == 0;
+  GAME_ASSERT(current) << "Couldn't make GL context current again: " << SDL_GetError();
+  GAME_LOG(LogType::Error) << "Render thread has no GL context, rendering on main thread";
+  return false;
+}
+
+void OpenGLRenderer::Render(__attribute__((unused)) float alpha) noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  if(!threaded_)
+  {
+    RenderFrame(queue_);
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(frame_mutex_);
+  {
+    ZoneScopedNC("Wait for render thread", 0x07dbd4);
+    frame_condition_.wait(lock, [this]{ return submitted_frames_ - rendered_frames_ < frame_latency_; });
+  }
+
+  // Packet was cleared by render thread, so recording continues into memory that is already allocated
+  FramePacket &packet = packets_[submitted_frames_ % packets_.size()];
+  std::swap(packet.queue, queue_);
+  ++submitted_frames_;
+  lock.unlock();
+  frame_condition_.notify_all();
 }
 
-void OpenGLRenderer::Render() noexcept
+void OpenGLRenderer::RenderFrame(RenderQueue &queue) noexcept
 {
   ZoneScopedC(0x07dbd4);
 
-  static bool flip = true;
-  static int buffer = 1000;
-  buffer--;
-  if(buffer < 0)
+  gpu_profiler_.BeginFrame();
+  {
+  GAME_GPU_ZONE(gpu_profiler_, "Frame");
+
+  int width;
+  int height;
+  SDL_GL_GetDrawableSize(window_, &width, &height);
+  // Framebuffer follows window size, so resolution changes work the same way offscreen
+  if(offscreen_)
+    framebuffer_.Resize(width, height);
+  const GLuint framebuffer = offscreen_ ? framebuffer_.GetHandle() : 0;
+  gl_state_.BindFramebuffer(framebuffer);
+  gl_state_.SetViewport(0, 0, width, height);
+  GL_CALL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+  {
+    GAME_GPU_ZONE(gpu_profiler_, "Upload");
+    UploadTextures();
+  }
+
   {
-    flip = !flip;
-    buffer = 1000;
-    if(flip)
-      GL_CALL(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
-    else
-      GL_CALL(glClearColor(1.0f, 1.0f, 1.0f, 1.0f));
+    GAME_GPU_ZONE(gpu_profiler_, "Replay");
+    sprite_renderer_.Begin(width, height);
+    Replay(queue);
+    sprite_renderer_.End();
   }
+  TracyPlot("Sprite draw calls", static_cast<int64_t>(sprite_renderer_.GetDrawCallCount()));
 
-  GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
-  SDL_GL_SwapWindow(game_->GetWindow().GetSDLWindow());
+  {
+    GAME_GPU_ZONE(gpu_profiler_, "Readback");
+    ReadbackFrame(framebuffer, width, height);
+  }
+  }
+
+  // Nothing is shown offscreen, flush only makes sure GPU starts working on the frame
+  if(offscreen_)
+    GL_CALL(glFlush());
+  else
+    SDL_GL_SwapWindow(window_);
+  gl_state_.EndFrame();
+  gpu_profiler_.EndFrame();
+}
+
+void OpenGLRenderer::RenderThreadLoop() noexcept
+{
+  #ifdef TRACY_ENABLE
+  tracy::SetThreadName("Render");
+  #endif
+
+  // Init waits for the result, thread ends right away if it has no context
+  const bool current = SDL_GL_MakeCurrent(window_, context_) == 0;
+  if(!current)
+    GAME_LOG(LogType::Error) << "Couldn't make GL context current on render thread: " << SDL_GetError();
+  {
+    std::lock_guard<std::mutex> lock(frame_mutex_);
+    render_thread_started_ = true;
+    render_thread_current_ = current;
+  }
+  frame_condition_.notify_all();
+  if(!current)
+    return;
+
+  while(true)
+  {
+    std::unique_lock<std::mutex> lock(frame_mutex_);
+    frame_condition_.wait(lock, [this]{ return submitted_frames_ != rendered_frames_ || !render_thread_running_; });
+    if(submitted_frames_ == rendered_frames_)
+      break;
+    FramePacket &packet = packets_[rendered_frames_ % packets_.size()];
+    lock.unlock();
+
+    RenderFrame(packet.queue);
+    FrameMarkNamed("Render");
+
+    lock.lock();
+    ++rendered_frames_;
+    lock.unlock();
+    frame_condition_.notify_all();
+  }
+
+  SDL_GL_MakeCurrent(window_, nullptr);
+}
+
+void OpenGLRenderer::UploadTextures() noexcept
+{
+  textures_.TakeUploads(texture_uploads_);
+  if(texture_uploads_.empty())
+    return;
+
+  ZoneScopedC(0x07dbd4);
+
+  // Textures are created right away, so sprites that use them are invisible instead of white until their pixels arrive
+  // Id that is released can belong to other texture in later uploads, those are created once release is done
+  for(const TextureUpload &upload : texture_uploads_)
+  {
+    if(upload.release)
+      break;
+    CreateTexture(upload);
+  }
+
+  // Pixels are copied in bands until budget is spent, at least one band per frame so loading always progresses
+  const ClockType::time_point deadline = ClockType::now() + upload_budget_;
+  bool copied = false;
+  std::size_t done = 0;
+  GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+  for(; done < texture_uploads_.size(); ++done)
+  {
+    const TextureUpload &upload = texture_uploads_[done];
+    if(upload.release)
+    {
+      gl_state_.DeleteTexture(gl_textures_[upload.texture]);
+      gl_textures_[upload.texture] = 0;
+      continue;
+    }
+
+    CreateTexture(upload);
+    gl_state_.BindTexture(0, gl_textures_[upload.texture]);
+    const int32_t band_rows = std::max<int32_t>(1, static_cast<int32_t>(kUploadBandSize / (std::max<int32_t>(upload.width, 1) * sizeof(uint32_t))));
+    while(upload_row_ < upload.height)
+    {
+      if(copied && ClockType::now() >= deadline)
+        break;
+      const int32_t rows = std::min(band_rows, upload.height - upload_row_);
+      GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, upload.x, upload.y + upload_row_, upload.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, upload.pixels.data() + static_cast<std::size_t>(upload_row_) * upload.width));
+      upload_row_ += rows;
+      copied = true;
+    }
+    if(upload_row_ < upload.height)
+      break;
+    upload_row_ = 0;
+  }
+
+  texture_uploads_.erase(texture_uploads_.begin(), texture_uploads_.begin() + done);
+  TracyPlot("Pending texture uploads", static_cast<int64_t>(texture_uploads_.size()));
+}
+
+void OpenGLRenderer::CreateTexture(const TextureUpload &upload) noexcept
+{
+  if(upload.texture >= gl_textures_.size())
+    gl_textures_.resize(upload.texture + 1, 0);
+  GLuint &texture = gl_textures_[upload.texture];
+  if(texture != 0)
+    return;
+
+  GL_CALL(glGenTextures(1, &texture));
+  gl_state_.BindTexture(0, texture);
+  GL_CALL(glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, upload.texture_width, upload.texture_height));
+  GL_CALL(glClearTexImage(texture, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+}
+
+void OpenGLRenderer::ReadbackFrame(GLuint framebuffer, int width, int height) noexcept
+{
+  // Finished reads go first, so their buffers can take this frame
+  Image image;
+  while(readback_.Poll(image))
+  {
+    std::lock_guard<std::mutex> lock(capture_mutex_);
+    captures_.push_back(std::move(image));
+  }
+
+  std::lock_guard<std::mutex> lock(capture_mutex_);
+  if(capture_requests_ != 0 && readback_.Request(framebuffer, width, height))
+    --capture_requests_;
+}
+
+void OpenGLRenderer::RequestCapture() noexcept
+{
+  std::lock_guard<std::mutex> lock(capture_mutex_);
+  ++capture_requests_;
+}
+
+auto OpenGLRenderer::TakeCapture(Image &image) noexcept -> bool
+{
+  std::lock_guard<std::mutex> lock(capture_mutex_);
+  if(captures_.empty())
+    return false;
+  image = std::move(captures_.front());
+  captures_.erase(captures_.begin());
+  return true;
+}
+
+void OpenGLRenderer::Replay(RenderQueue &queue) noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  static constexpr GLenum kPrimitives[] = { GL_TRIANGLES, GL_TRIANGLE_STRIP, GL_LINES, GL_POINTS };
+
+  queue.Sort();
+
+  // Commands are sorted by shader and texture, so most of binds are skipped by state cache
+  for(const RenderQueue::Entry &entry : queue)
+  {
+    const RenderCommandType type = queue.GetType(entry);
+    if(type != RenderCommandType::Sprite)
+      sprite_renderer_.Flush();
+
+    switch(type)
+    {
+    case RenderCommandType::Clear:
+    {
+      const ClearCommand &clear = queue.Get<ClearCommand>(entry);
+      GLbitfield mask = 0;
+      if(clear.mask & ClearCommand::kColor)
+      {
+        GL_CALL(glClearColor(clear.color[0], clear.color[1], clear.color[2], clear.color[3]));
+        mask |= GL_COLOR_BUFFER_BIT;
+      }
+      if(clear.mask & ClearCommand::kDepth)
+      {
+        GL_CALL(glClearDepth(clear.depth));
+        mask |= GL_DEPTH_BUFFER_BIT;
+      }
+      GL_CALL(glClear(mask));
+      break;
+    }
+    case RenderCommandType::Viewport:
+    {
+      const ViewportCommand &viewport = queue.Get<ViewportCommand>(entry);
+      gl_state_.SetViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+      break;
+    }
+    case RenderCommandType::Draw:
+    {
+      const DrawCommand &draw = queue.Get<DrawCommand>(entry);
+      gl_state_.UseProgram(shaders_.GetProgram(draw.shader));
+      gl_state_.BindTexture(0, GetGLTexture(draw.texture));
+      gl_state_.BindVertexArray(draw.vertex_array);
+
+      if(draw.instance_count == 1)
+        GL_CALL(glDrawArrays(kPrimitives[draw.primitive], draw.first, draw.count));
+      else
+        GL_CALL(glDrawArraysInstanced(kPrimitives[draw.primitive], draw.first, draw.count, draw.instance_count));
+      break;
+    }
+    case RenderCommandType::Sprite:
+    {
+      const SpriteCommand &sprite = queue.Get<SpriteCommand>(entry);
+      sprite_renderer_.Draw(sprite.shader, GetGLTexture(sprite.texture), sprite.instance);
+      break;
+    }
+    }
+  }
+
+  queue.Clear();
 }
 
 void OpenGLRenderer::Exit() noexcept
 {
   ZoneScopedC(0x07dbd4);
 
+  if(threaded_)
+  {
+    // Render thread finishes submitted frames before it exits
+    {
+      std::lock_guard<std::mutex> lock(frame_mutex_);
+      render_thread_running_ = false;
+    }
+    frame_condition_.notify_all();
+    render_thread_.join();
+    SDL_GL_MakeCurrent(window_, context_);
+  }
+
+  sprite_renderer_.Exit();
+  shaders_.Exit();
+  gpu_profiler_.Exit();
+  readback_.Exit();
+  framebuffer_.Exit();
+  // Zeros are ignored
+  GL_CALL(glDeleteTextures(static_cast<GLsizei>(gl_textures_.size()), gl_textures_.data()));
+  gl_textures_.clear();
+  texture_uploads_.clear();
+  upload_row_ = 0;
+  {
+    std::lock_guard<std::mutex> lock(capture_mutex_);
+    capture_requests_ = 0;
+    captures_.clear();
+  }
+
   SDL_GL_DeleteContext(context_);
 }
 } // game
\ No newline at end of file
@@ -3,9 +3,22 @@
 
 #include "Setup.hpp"
 
+#include <array>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 #include <SDL2/SDL_video.h>
 
 #include "Core/Renderer.hpp"
+#include "Utils/Time.hpp"
+#include "Platform/OpenGL/SpriteRenderer.hpp"
+#include "Platform/OpenGL/ShaderCache.hpp"
+#include "Platform/OpenGL/GLState.hpp"
+#include "Platform/OpenGL/GpuProfiler.hpp"
+#include "Platform/OpenGL/Framebuffer.hpp"
+#include "Platform/OpenGL/PixelReadback.hpp"
 
 
 namespace game
@@ -17,22 +30,100 @@ class OpenGLRenderer : public Renderer
 {
   friend Renderer;
 public:
+  /// Maximum amount of frames main thread can be ahead of render thread
+  static constexpr inline std::size_t kMaxFrameLatency = 2;
+  /// Default time that can be spent copying texture pixels each frame
+  static constexpr inline double kDefUploadBudgetMs = 2.0;
+  /// Textures are copied in bands of about that many bytes, budget is checked between them
+  static constexpr inline std::size_t kUploadBandSize = 256 * 1024;
+
+  /// Render thread is started if -render-thread flag is present
+  /// Frames are rendered on calling thread if context can't be made current on render thread
+  /// -frame-latency=N sets how many frames main thread can be ahead of render thread, 1 by default
+  /// -upload-budget=MS sets time spent on texture uploads per frame, kDefUploadBudgetMs by default
+  /// -shader-cache=DIR sets where linked shaders are kept, ShaderCache::kDefCacheDirectory by default, -no-shader-cache disables it
+  /// -gl-debug reports errors with KHR_debug callback in release builds too, debug builds use it by default
+  /// -gl-error-polling polls glGetError after every call instead of using callback
+  /// -offscreen renders into framebuffer of hidden window, frames are never shown and only reach captures
+  /// With Mesa it works without display or GPU when SDL_VIDEODRIVER=offscreen and LIBGL_ALWAYS_SOFTWARE=1
   void Init(Game &game) noexcept override;
-  /// Add mesh to render queue
-  /// First added meshes will be rendered first
-  void AddToQueue() noexcept override {}
-  void Render() noexcept override;
+  /// Same as Init of game, renderer doesn't need anything else from it
+  /// Lets tests render offscreen without running whole game
+  void Init(SDL_Window *window, const Flags &flags) noexcept;
+  /// Without render thread frame is rendered right away, otherwise it is handed to render thread
+  /// and call blocks only if render thread is more than frame latency behind
+  void Render(float alpha) noexcept override;
   void Exit() noexcept override;
+  /// Passes are "Frame", "Upload", "Replay" and "Readback"
+  void GetGpuStats(std::vector<GpuPassStats> &stats) const noexcept override { gpu_profiler_.GetStats(stats); }
+  /// Pixels are read asynchronously, capture is postponed if PixelReadback::kBufferCount captures are in flight
+  void RequestCapture() noexcept override;
+  auto TakeCapture(Image &image) noexcept -> bool override;
 
-  int GetSDLWindowFlags() const noexcept override { return SDL_WINDOW_OPENGL; }
+  int GetSDLWindowFlags() const noexcept override { return SDL_WINDOW_OPENGL | (offscreen_ ? SDL_WINDOW_HIDDEN : 0); }
 
 private:
   OpenGLRenderer() noexcept;
 
+  /// Recorded frame waiting for render thread
+  struct FramePacket
+  {
+    RenderQueue queue;
+  };
+
   void PrintDebugInfo() const noexcept;
+  /// Clear, replay queue and swap buffers
+  void RenderFrame(RenderQueue &queue) noexcept;
+  /// Execute sorted commands, state cache skips binds that don't change anything
+  void Replay(RenderQueue &queue) noexcept;
+  /// Hand context over to render thread
+  /// return false if render thread can't make it current, context stays on calling thread then
+  auto StartRenderThread() noexcept -> bool;
+  void RenderThreadLoop() noexcept;
+  /// Create textures and copy pixels loaded by texture cache, copying stops when upload budget is spent
+  void UploadTextures() noexcept;
+  /// Create texture of upload cleared to transparent if its id has none yet
+  void CreateTexture(const TextureUpload &upload) noexcept;
+  /// Start requested reads of framebuffer and hand over the finished ones
+  void ReadbackFrame(GLuint framebuffer, int width, int height) noexcept;
+  /// GL texture of TextureCache id, 0 for unknown ids
+  [[nodiscard]] inline auto GetGLTexture(uint32_t texture) const noexcept -> GLuint { return texture < gl_textures_.size() ? gl_textures_[texture] : 0; }
 
-  Game *game_ = nullptr;
+  SDL_Window *window_ = nullptr;
   void *context_; // even in implementation SDL_GLContext is just typedef to void* 
+  GLState gl_state_;
+  GpuProfiler gpu_profiler_;
+  ShaderCache shaders_;
+  SpriteRenderer sprite_renderer_;
+  /// Indexed by TextureCache id, used only by thread that renders
+  std::vector<GLuint> gl_textures_;
+  /// Uploads that weren't finished in previous frames go first
+  std::vector<TextureUpload> texture_uploads_;
+  /// Rows of the first upload that are already copied
+  int32_t upload_row_ = 0;
+  ClockType::duration upload_budget_{};
+
+  bool offscreen_ = false;
+  Framebuffer framebuffer_;
+  PixelReadback readback_;
+  std::mutex capture_mutex_;
+  // Guarded by capture_mutex_
+  std::size_t capture_requests_ = 0;
+  std::vector<Image> captures_;
+
+  bool threaded_ = false;
+  std::size_t frame_latency_ = 1;
+  std::array<FramePacket, kMaxFrameLatency + 1> packets_;
+  // Guarded by frame_mutex_
+  uint64_t submitted_frames_ = 0;
+  uint64_t rendered_frames_ = 0;
+  bool render_thread_running_ = false;
+  /// Render thread tried to make context current, render_thread_current_ is the result
+  bool render_thread_started_ = false;
+  bool render_thread_current_ = false;
+  std::mutex frame_mutex_;
+  std::condition_variable frame_condition_;
+  std::thread render_thread_;
 };
 } // game
 
@@ -0,0 +1,120 @@
+#include "PixelReadback.hpp"
+
+#include "Setup.hpp"
+
+#include <cstring>
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+void PixelReadback::Init(GLState &state) noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  state_ = &state;
+  for(Slot &slot : slots_)
+    GL_CALL(glCreateBuffers(1, &slot.buffer));
+}
+
+void PixelReadback::Exit() noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  state_->BindPixelPackBuffer(0);
+  for(Slot &slot : slots_)
+  {
+    if(slot.fence != nullptr)
+      GL_CALL(glDeleteSync(slot.fence));
+    GL_CALL(glDeleteBuffers(1, &slot.buffer));
+    slot = Slot{};
+  }
+  first_ = 0;
+  pending_ = 0;
+}
+
+auto PixelReadback::Request(GLuint framebuffer, int width, int height) noexcept -> bool
+{
+  if(pending_ == kBufferCount)
+    return false;
+
+  ZoneScopedC(0x07dbd4);
+
+  Slot &slot = slots_[(first_ + pending_) % kBufferCount];
+  const std::size_t size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * sizeof(uint32_t);
+  if(slot.capacity < size)
+  {
+    GL_CALL(glNamedBufferData(slot.buffer, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ));
+    slot.capacity = size;
+  }
+  slot.width = width;
+  slot.height = height;
+
+  state_->BindFramebuffer(framebuffer);
+  state_->BindPixelPackBuffer(slot.buffer);
+  GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+  GL_CALL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+  state_->BindPixelPackBuffer(0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  ++pending_;
+  return true;
+}
+
+auto PixelReadback::Poll(Image &image) noexcept -> bool
+{
+  if(pending_ == 0)
+    return false;
+
+  // Zero timeout only asks, flush makes sure fence reaches GPU at all
+  const GLenum result = glClientWaitSync(slots_[first_].fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  if(result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+    return false;
+  Take(image);
+  return true;
+}
+
+auto PixelReadback::Wait(Image &image) noexcept -> bool
+{
+  if(pending_ == 0)
+    return false;
+
+  ZoneScopedC(0x07dbd4);
+
+  constexpr GLuint64 kTimeout = 1'000'000'000;
+  GLenum result;
+  while((result = glClientWaitSync(slots_[first_].fence, GL_SYNC_FLUSH_COMMANDS_BIT, kTimeout)) == GL_TIMEOUT_EXPIRED)
+    GAME_LOG(LogType::Warning) << "Waiting for pixel readback for more than a second";
+  GAME_ASSERT(result != GL_WAIT_FAILED) << "Couldn't wait for pixel readback fence";
+  Take(image);
+  return true;
+}
+
+void PixelReadback::Take(Image &image) noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  Slot &slot = slots_[first_];
+  const std::size_t row_size = static_cast<std::size_t>(slot.width) * sizeof(uint32_t);
+  const std::size_t size = row_size * static_cast<std::size_t>(slot.height);
+  image.width = slot.width;
+  image.height = slot.height;
+  image.pixels.resize(static_cast<std::size_t>(slot.width) * static_cast<std::size_t>(slot.height));
+
+  const std::byte *mapped = static_cast<const std::byte*>(glMapNamedBufferRange(slot.buffer, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT));
+  if(mapped != nullptr)
+  {
+    // GL rows go from bottom to top
+    for(int y = 0; y < slot.height; ++y)
+      std::memcpy(image.pixels.data() + static_cast<std::size_t>(y) * slot.width, mapped + static_cast<std::size_t>(slot.height - 1 - y) * row_size, row_size);
+    GL_CALL(glUnmapNamedBuffer(slot.buffer));
+  }
+  else
+    GAME_LOG(LogType::Error) << "Couldn't map pixel readback buffer";
+
+  GL_CALL(glDeleteSync(slot.fence));
+  slot.fence = nullptr;
+  first_ = (first_ + 1) % kBufferCount;
+  --pending_;
+}
+} // game
@@ -0,0 +1,66 @@
+#ifndef GAME_PIXEL_READBACK_HPP
+#define GAME_PIXEL_READBACK_HPP
+
+#include "Setup.hpp"
+
+#include <array>
+#include <cstddef>
+
+#include "Core/Image.hpp"
+#include "Platform/OpenGL/OpenGL.hpp"
+#include "Platform/OpenGL/GLState.hpp"
+
+
+namespace game
+{
+/// Asynchronous copy of framebuffer pixels to CPU memory
+///
+/// glReadPixels writes into pixel pack buffer, so it returns without waiting for GPU
+/// Each read is fenced and taken out frames later, once GPU has finished it
+/// Buffers form a ring, read is refused instead of waiting when all of them are busy
+class PixelReadback
+{
+public:
+  static constexpr inline std::size_t kBufferCount = 3;
+
+  PixelReadback() noexcept = default;
+  PixelReadback(const PixelReadback &) = delete;
+  PixelReadback &operator=(const PixelReadback &) = delete;
+
+  void Init(GLState &state) noexcept;
+  void Exit() noexcept;
+
+  /// Start reading whole framebuffer of this size, 0 is window back buffer
+  /// Framebuffer stays bound afterwards
+  /// return false if every buffer is waiting to be taken
+  auto Request(GLuint framebuffer, int width, int height) noexcept -> bool;
+  /// Take the oldest read if GPU has finished it, never waits
+  auto Poll(Image &image) noexcept -> bool;
+  /// Take the oldest read, waiting for GPU if needed
+  /// return false if nothing was requested
+  auto Wait(Image &image) noexcept -> bool;
+
+  [[nodiscard]] constexpr inline auto GetPendingCount() const noexcept -> std::size_t { return pending_; }
+
+private:
+  struct Slot
+  {
+    GLuint buffer = 0;
+    GLsync fence = nullptr;
+    std::size_t capacity = 0;
+    int width = 0;
+    int height = 0;
+  };
+
+  /// Copy pixels of the oldest slot into image with rows from top to bottom
+  void Take(Image &image) noexcept;
+
+  GLState *state_ = nullptr;
+  std::array<Slot, kBufferCount> slots_;
+  /// Oldest slot that is waiting
+  std::size_t first_ = 0;
+  std::size_t pending_ = 0;
+};
+} // game
+
+#endif // GAME_PIXEL_READBACK_HPP
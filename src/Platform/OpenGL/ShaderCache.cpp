@@ -0,0 +1,310 @@
+#include "ShaderCache.hpp"
+
+#include "Setup.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+
+#include "Utils/Hash.hpp"
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+namespace
+{
+constexpr char kBinaryMagic[4] = { 'G', 'S', 'H', 'B' };
+
+auto CompileShader(GLenum type, std::string_view name, std::string_view source) noexcept -> GLuint
+{
+  const GLuint shader = glCreateShader(type);
+  const char *data = source.data();
+  const GLint size = static_cast<GLint>(source.size());
+  GL_CALL(glShaderSource(shader, 1, &data, &size));
+  GL_CALL(glCompileShader(shader));
+
+  GLint status;
+  GL_CALL(glGetShaderiv(shader, GL_COMPILE_STATUS, &status));
+  if(GAME_IS_UNLIKELY(!status))
+  {
+    GLint length;
+    GL_CALL(glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length));
+    std::string log(length, '\0');
+    GL_CALL(glGetShaderInfoLog(shader, length, nullptr, log.data()));
+    GAME_LOG(LogType::Error) << "Couldn't compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader of " << name << ": " << log;
+    GL_CALL(glDeleteShader(shader));
+    return 0;
+  }
+  return shader;
+}
+
+auto IsLinked(GLuint program) noexcept -> bool
+{
+  GLint status;
+  GL_CALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+  return status;
+}
+} // namespace
+
+ShaderCache::ShaderCache() noexcept
+{
+  // Well known uniforms get fixed slots
+  __attribute__((unused)) const uint32_t screen_size = GetUniformSlot("u_screen_size");
+  __attribute__((unused)) const uint32_t texture = GetUniformSlot("u_texture");
+  GAME_ASSERT(screen_size == kScreenSizeSlot && texture == kTextureSlot) << "Well known uniform slots don't match";
+}
+
+void ShaderCache::Init(std::string directory) noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  // Binary is valid only for the exact driver it was made by, so same strings as PrintDebugInfo are hashed
+  std::string driver;
+  for(const GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION })
+  {
+    const GLubyte *value = glGetString(name);
+    driver += value != nullptr ? reinterpret_cast<const char*>(value) : "";
+    driver += '\n';
+  }
+  driver_hash_ = HashString(driver);
+
+  GLint format_count = 0;
+  GL_CALL(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count));
+  binaries_supported_ = format_count > 0;
+  if(!binaries_supported_)
+    GAME_LOG(LogType::Info) << "Driver doesn't support program binaries, shaders are always compiled";
+
+  directory_ = std::move(directory);
+  if(binaries_supported_ && !directory_.empty())
+  {
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if(error)
+    {
+      GAME_LOG(LogType::Warning) << "Couldn't create shader cache directory " << directory_ << ": " << error.message();
+      directory_.clear();
+    }
+  }
+}
+
+void ShaderCache::Exit() noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  for(Program &program : programs_)
+    if(program.program != 0)
+      GL_CALL(glDeleteProgram(program.program));
+  programs_.resize(1);
+  program_by_hash_.clear();
+}
+
+auto ShaderCache::Load(std::string_view name, std::string_view vertex_source, std::string_view fragment_source) noexcept -> uint32_t
+{
+  ZoneScopedC(0x07dbd4);
+  ZoneText(name.data(), name.size());
+
+  std::string sources;
+  sources.reserve(vertex_source.size() + fragment_source.size() + 1);
+  sources.append(vertex_source).append(1, '\0').append(fragment_source);
+  const uint32_t source_hash = HashString(sources);
+  if(const auto it = program_by_hash_.find(source_hash); it != program_by_hash_.end())
+  {
+    #ifndef NDEBUG
+    GAME_ASSERT(it->second.key == sources) << "Sources of shader " << name << " have the same hash as other program: " << source_hash;
+    #endif
+    return it->second.value;
+  }
+  if(programs_.size() >= kMaxPrograms)
+  {
+    GAME_LOG(LogType::Error) << "Couldn't load shader " << name << ", ids of " << kMaxPrograms << " programs are used up";
+    return 0;
+  }
+
+  BinaryHeader header{};
+  std::memcpy(header.magic, kBinaryMagic, sizeof(header.magic));
+  header.source_hash = source_hash;
+  header.source_size = static_cast<uint32_t>(sources.size());
+  header.driver_hash = driver_hash_;
+
+  std::string path;
+  if(binaries_supported_ && !directory_.empty())
+  {
+    std::ostringstream stream;
+    stream << directory_ << '/' << std::hex << std::setfill('0') << std::setw(8) << source_hash << '-' << std::setw(8) << driver_hash_ << ".bin";
+    path = stream.str();
+  }
+
+  Program program;
+  if(!path.empty())
+    program.program = LoadBinary(path, header);
+  if(program.program != 0)
+  {
+    ++cached_count_;
+    GAME_LOG(LogType::Info) << "Loaded shader " << name << " from cache";
+  }
+  else
+  {
+    program.program = Compile(name, vertex_source, fragment_source);
+    if(program.program == 0)
+      return 0;
+    ++compiled_count_;
+    if(!path.empty())
+      SaveBinary(path, header, program.program);
+  }
+
+  Reflect(program);
+  const uint32_t id = static_cast<uint32_t>(programs_.size());
+  programs_.push_back(std::move(program));
+  HashEntry entry;
+  entry.value = id;
+  #ifndef NDEBUG
+  entry.key = std::move(sources);
+  #endif
+  program_by_hash_.emplace(source_hash, std::move(entry));
+  return id;
+}
+
+auto ShaderCache::GetUniformSlot(std::string_view name) noexcept -> uint32_t
+{
+  HashEntry entry;
+  entry.value = slot_count_;
+  #ifndef NDEBUG
+  entry.key = name;
+  #endif
+  const auto [it, inserted] = slot_by_name_.emplace(HashString(name), std::move(entry));
+  if(inserted)
+    ++slot_count_;
+  #ifndef NDEBUG
+  GAME_ASSERT(it->second.key == name) << "Uniform " << name << " has the same hash as uniform " << it->second.key;
+  #endif
+  return it->second.value;
+}
+
+auto ShaderCache::Compile(std::string_view name, std::string_view vertex_source, std::string_view fragment_source) noexcept -> GLuint
+{
+  ZoneScopedNC("Compile shader", 0x07dbd4);
+
+  const GLuint vertex_shader = CompileShader(GL_VERTEX_SHADER, name, vertex_source);
+  const GLuint fragment_shader = CompileShader(GL_FRAGMENT_SHADER, name, fragment_source);
+  if(vertex_shader == 0 || fragment_shader == 0)
+  {
+    GL_CALL(glDeleteShader(vertex_shader));
+    GL_CALL(glDeleteShader(fragment_shader));
+    return 0;
+  }
+
+  const GLuint program = glCreateProgram();
+  if(binaries_supported_)
+    GL_CALL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+  GL_CALL(glAttachShader(program, vertex_shader));
+  GL_CALL(glAttachShader(program, fragment_shader));
+  GL_CALL(glLinkProgram(program));
+  GL_CALL(glDetachShader(program, vertex_shader));
+  GL_CALL(glDetachShader(program, fragment_shader));
+  GL_CALL(glDeleteShader(vertex_shader));
+  GL_CALL(glDeleteShader(fragment_shader));
+  if(IsLinked(program))
+    return program;
+
+  GLint length;
+  GL_CALL(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+  std::string log(length, '\0');
+  GL_CALL(glGetProgramInfoLog(program, length, nullptr, log.data()));
+  GAME_LOG(LogType::Error) << "Couldn't link shader " << name << ": " << log;
+  GL_CALL(glDeleteProgram(program));
+  return 0;
+}
+
+auto ShaderCache::LoadBinary(const std::string &path, const BinaryHeader &expected) noexcept -> GLuint
+{
+  ZoneScopedNC("Load shader binary", 0x07dbd4);
+
+  std::ifstream file(path, std::ios::binary);
+  if(!file)
+    return 0;
+  BinaryHeader header;
+  if(!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+    || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0
+    || header.source_hash != expected.source_hash || header.source_size != expected.source_size || header.driver_hash != expected.driver_hash)
+    return 0;
+  std::vector<char> binary(header.size);
+  if(!file.read(binary.data(), static_cast<std::streamsize>(binary.size())))
+    return 0;
+
+  const GLuint program = glCreateProgram();
+  GL_CALL(glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size())));
+  if(IsLinked(program))
+    return program;
+
+  // Driver can reject binary even when its version string didn't change
+  GAME_LOG(LogType::Info) << "Driver rejected cached shader " << path << ", compiling it again";
+  GL_CALL(glDeleteProgram(program));
+  return 0;
+}
+
+void ShaderCache::SaveBinary(const std::string &path, BinaryHeader header, GLuint program) noexcept
+{
+  ZoneScopedNC("Save shader binary", 0x07dbd4);
+
+  GLint size = 0;
+  GL_CALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size));
+  if(size <= 0)
+    return;
+  std::vector<char> binary(static_cast<std::size_t>(size));
+  GLenum format = 0;
+  GL_CALL(glGetProgramBinary(program, size, &size, &format, binary.data()));
+  header.format = format;
+  header.size = static_cast<uint32_t>(size);
+
+  // Written under temporary name, so other instance of the game never reads half written file
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), size);
+    if(!file)
+    {
+      GAME_LOG(LogType::Warning) << "Couldn't write shader cache " << temporary;
+      return;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if(error)
+    GAME_LOG(LogType::Warning) << "Couldn't write shader cache " << path << ": " << error.message();
+}
+
+void ShaderCache::Reflect(Program &program) noexcept
+{
+  GLint count = 0;
+  GLint max_length = 0;
+  GL_CALL(glGetProgramiv(program.program, GL_ACTIVE_UNIFORMS, &count));
+  GL_CALL(glGetProgramiv(program.program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length));
+
+  std::string name(static_cast<std::size_t>(std::max(max_length, 1)), '\0');
+  for(GLint i = 0; i < count; ++i)
+  {
+    GLsizei length = 0;
+    GLint size;
+    GLenum type;
+    GL_CALL(glGetActiveUniform(program.program, static_cast<GLuint>(i), max_length, &length, &size, &type, name.data()));
+    std::string_view uniform(name.data(), static_cast<std::size_t>(length));
+    const GLint location = glGetUniformLocation(program.program, name.c_str());
+    // Members of uniform blocks have no location
+    if(location < 0)
+      continue;
+    // Arrays are reported as name[0], they are set through the first element
+    if(uniform.size() > 3 && uniform.substr(uniform.size() - 3) == "[0]")
+      uniform.remove_suffix(3);
+
+    const uint32_t slot = GetUniformSlot(uniform);
+    if(program.locations.size() <= slot)
+      program.locations.resize(slot + 1, -1);
+    program.locations[slot] = location;
+  }
+}
+} // game
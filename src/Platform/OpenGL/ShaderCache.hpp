@@ -0,0 +1,108 @@
+#ifndef GAME_SHADER_CACHE_HPP
+#define GAME_SHADER_CACHE_HPP
+
+#include "Setup.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+#include "Core/RenderQueue.hpp"
+#include "Platform/OpenGL/OpenGL.hpp"
+
+
+namespace game
+{
+/// Compiles shader programs, reflects their uniforms and keeps linked programs on disk
+///
+/// Programs are referred to by small ids that fit into render queue keys, 0 is never given out
+/// Every uniform name gets a slot shared by all programs, so location is found by indexing instead of glGetUniformLocation
+/// Linked binary is stored in cache directory under hash of sources and driver string,
+/// next launch with same driver loads it without compiling, binary that driver rejects is compiled again
+/// Should be used only on thread with current GL context
+class ShaderCache
+{
+public:
+  /// Slots of uniforms that every sprite shader has
+  static constexpr inline uint32_t kScreenSizeSlot = 0;
+  static constexpr inline uint32_t kTextureSlot = 1;
+  static constexpr inline const char *kDefCacheDirectory = "shader_cache";
+  /// Ids have to fit into shader bits of render queue key, id 0 counts too
+  static constexpr inline std::size_t kMaxPrograms = std::size_t{1} << RenderQueue::kShaderBits;
+
+  ShaderCache() noexcept;
+  ShaderCache(const ShaderCache &) = delete;
+  ShaderCache &operator=(const ShaderCache &) = delete;
+
+  /// Query driver and create cache directory, empty directory disables disk cache
+  void Init(std::string directory = kDefCacheDirectory) noexcept;
+  /// Delete all programs
+  void Exit() noexcept;
+
+  /// Load program from disk cache or compile it, same sources give same id
+  /// name is used only in log messages
+  /// return 0 if program can't be compiled or linked or kMaxPrograms are already loaded
+  [[nodiscard]] auto Load(std::string_view name, std::string_view vertex_source, std::string_view fragment_source) noexcept -> uint32_t;
+  /// Slot of uniform name, it is registered if it wasn't seen before
+  [[nodiscard]] auto GetUniformSlot(std::string_view name) noexcept -> uint32_t;
+
+  [[nodiscard]] inline auto GetProgram(uint32_t id) const noexcept -> GLuint { return programs_[id].program; }
+  /// return -1 if program doesn't have uniform of that slot
+  [[nodiscard]] inline auto GetLocation(uint32_t id, uint32_t slot) const noexcept -> GLint
+  { const std::vector<GLint> &locations = programs_[id].locations; return slot < locations.size() ? locations[slot] : -1; }
+
+  /// Programs compiled from source and loaded from disk cache since Init
+  [[nodiscard]] constexpr inline auto GetCompiledCount() const noexcept -> std::size_t { return compiled_count_; }
+  [[nodiscard]] constexpr inline auto GetCachedCount() const noexcept -> std::size_t { return cached_count_; }
+
+private:
+  struct Program
+  {
+    GLuint program = 0;
+    /// Indexed by uniform slot
+    std::vector<GLint> locations;
+  };
+
+  /// Value of map keyed by hash, debug builds keep hashed string too, so collisions are caught
+  struct HashEntry
+  {
+    uint32_t value = 0;
+    #ifndef NDEBUG
+    std::string key;
+    #endif
+  };
+
+  /// Start of cache file, program binary follows it
+  struct BinaryHeader
+  {
+    char magic[4];
+    uint32_t source_hash;
+    uint32_t source_size;
+    uint32_t driver_hash;
+    uint32_t format;
+    uint32_t size;
+  };
+
+  auto Compile(std::string_view name, std::string_view vertex_source, std::string_view fragment_source) noexcept -> GLuint;
+  auto LoadBinary(const std::string &path, const BinaryHeader &expected) noexcept -> GLuint;
+  void SaveBinary(const std::string &path, BinaryHeader header, GLuint program) noexcept;
+  /// Fill locations of every active uniform
+  void Reflect(Program &program) noexcept;
+
+  std::vector<Program> programs_ = std::vector<Program>(1);
+  /// Hash of sources to program id
+  std::unordered_map<uint32_t, HashEntry> program_by_hash_;
+  /// Hash of uniform name to slot
+  std::unordered_map<uint32_t, HashEntry> slot_by_name_;
+  uint32_t slot_count_ = 0;
+
+  std::string directory_;
+  uint32_t driver_hash_ = 0;
+  bool binaries_supported_ = false;
+  std::size_t compiled_count_ = 0;
+  std::size_t cached_count_ = 0;
+};
+} // game
+
+#endif // GAME_SHADER_CACHE_HPP
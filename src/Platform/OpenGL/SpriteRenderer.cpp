@@ -0,0 +1,190 @@
+#include "SpriteRenderer.hpp"
+
+#include "Setup.hpp"
+
+#include <cstddef>
+
+#include "Utils/Logger.hpp"
+#include "Platform/OpenGL/OpenGL.hpp"
+
+
+namespace game
+{
+namespace
+{
+constexpr inline const char *kVertexShaderSource = R"(#version 430 core
+layout(location = 0) in vec2 a_position;
+layout(location = 1) in vec2 a_size;
+layout(location = 2) in float a_rotation;
+layout(location = 3) in vec4 a_uv;
+layout(location = 4) in vec4 a_color;
+
+uniform vec2 u_screen_size;
+
+out vec2 v_uv;
+out vec4 v_color;
+
+void main()
+{
+  // Triangle strip corners: (0, 0), (1, 0), (0, 1), (1, 1)
+  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+  vec2 local = (corner - 0.5) * a_size;
+  float c = cos(a_rotation);
+  float s = sin(a_rotation);
+  vec2 screen = a_position + vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+  vec2 ndc = screen / u_screen_size * 2.0 - 1.0;
+  gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+  v_uv = mix(a_uv.xy, a_uv.zw, corner);
+  v_color = a_color;
+}
+)";
+
+constexpr inline const char *kFragmentShaderSource = R"(#version 430 core
+in vec2 v_uv;
+in vec4 v_color;
+
+uniform sampler2D u_texture;
+
+out vec4 o_color;
+
+void main()
+{
+  o_color = texture(u_texture, v_uv) * v_color;
+}
+)";
+
+} // namespace
+
+void SpriteRenderer::Init(ShaderCache &shaders, GLState &state) noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  shaders_ = &shaders;
+  state_ = &state;
+  default_shader_ = shaders_->Load("Sprite", kVertexShaderSource, kFragmentShaderSource);
+  GAME_ASSERT(default_shader_ != 0) << "Couldn't load sprite shader";
+
+  // Immutable storage that stays mapped for whole lifetime
+  constexpr GLsizeiptr kBufferSize = sizeof(SpriteInstance) * kSpritesPerSegment * kSegmentCount;
+  constexpr GLbitfield kMapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  GL_CALL(glGenBuffers(1, &buffer_));
+  state_->BindArrayBuffer(buffer_);
+  GL_CALL(glBufferStorage(GL_ARRAY_BUFFER, kBufferSize, nullptr, kMapFlags));
+  mapped_ = reinterpret_cast<SpriteInstance*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, kBufferSize, kMapFlags));
+  GAME_ASSERT(mapped_ != nullptr) << "Couldn't map sprite buffer, persistent mapping requires OpenGL 4.4";
+  state_->BindArrayBuffer(0);
+
+  // Buffer offset is changed per batch with glBindVertexBuffer, so format is set only once
+  GL_CALL(glGenVertexArrays(1, &vertex_array_));
+  state_->BindVertexArray(vertex_array_);
+  struct Attribute { GLint size; GLenum type; GLboolean normalized; GLuint offset; };
+  constexpr Attribute kAttributes[] = {
+    { 2, GL_FLOAT, GL_FALSE, offsetof(SpriteInstance, position) },
+    { 2, GL_FLOAT, GL_FALSE, offsetof(SpriteInstance, size) },
+    { 1, GL_FLOAT, GL_FALSE, offsetof(SpriteInstance, rotation) },
+    { 4, GL_FLOAT, GL_FALSE, offsetof(SpriteInstance, uv) },
+    { 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(SpriteInstance, color) }
+  };
+  for(GLuint i = 0; i < sizeof(kAttributes) / sizeof(kAttributes[0]); ++i)
+  {
+    GL_CALL(glEnableVertexAttribArray(i));
+    GL_CALL(glVertexAttribFormat(i, kAttributes[i].size, kAttributes[i].type, kAttributes[i].normalized, kAttributes[i].offset));
+    GL_CALL(glVertexAttribBinding(i, 0));
+  }
+  GL_CALL(glVertexBindingDivisor(0, 1));
+  state_->BindVertexArray(0);
+
+  constexpr uint32_t kWhite = 0xffffffff;
+  GL_CALL(glGenTextures(1, &white_texture_));
+  state_->BindTexture(0, white_texture_);
+  GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &kWhite));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+}
+
+void SpriteRenderer::Exit() noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  for(GLsync &fence : fences_)
+  {
+    if(fence != nullptr)
+      GL_CALL(glDeleteSync(fence));
+    fence = nullptr;
+  }
+
+  state_->BindArrayBuffer(buffer_);
+  GL_CALL(glUnmapBuffer(GL_ARRAY_BUFFER));
+  state_->BindArrayBuffer(0);
+  mapped_ = nullptr;
+
+  state_->BindVertexArray(0);
+  GL_CALL(glDeleteBuffers(1, &buffer_));
+  GL_CALL(glDeleteVertexArrays(1, &vertex_array_));
+  state_->DeleteTexture(white_texture_);
+}
+
+void SpriteRenderer::Begin(int width, int height) noexcept
+{
+  screen_width_ = static_cast<float>(width);
+  screen_height_ = static_cast<float>(height);
+  draw_call_count_ = 0;
+  batch_shader_ = kNoBatch;
+  batch_texture_ = kNoBatch;
+}
+
+auto SpriteRenderer::Flush() noexcept -> bool
+{
+  const std::size_t count = segment_used_ - batch_begin_;
+  if(count == 0)
+    return false;
+
+  ZoneScopedC(0x07dbd4);
+  ZoneValue(count);
+
+  const uint32_t shader = batch_shader_ == 0 ? default_shader_ : batch_shader_;
+  state_->UseProgram(shaders_->GetProgram(shader));
+  GL_CALL(glUniform2f(shaders_->GetLocation(shader, ShaderCache::kScreenSizeSlot), screen_width_, screen_height_));
+  state_->BindTexture(0, batch_texture_ == 0 ? white_texture_ : batch_texture_);
+  state_->BindVertexArray(vertex_array_);
+
+  const GLintptr offset = static_cast<GLintptr>((segment_ * kSpritesPerSegment + batch_begin_) * sizeof(SpriteInstance));
+  GL_CALL(glBindVertexBuffer(0, buffer_, offset, sizeof(SpriteInstance)));
+  GL_CALL(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count)));
+
+  batch_begin_ = segment_used_;
+  ++draw_call_count_;
+  return true;
+}
+
+void SpriteRenderer::End() noexcept
+{
+  Flush();
+  if(segment_used_ != 0)
+    NextSegment();
+}
+
+void SpriteRenderer::NextSegment() noexcept
+{
+  ZoneScopedC(0x07dbd4);
+
+  fences_[segment_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  segment_ = (segment_ + 1) % kSegmentCount;
+  segment_used_ = 0;
+  batch_begin_ = 0;
+
+  GLsync &fence = fences_[segment_];
+  if(fence == nullptr)
+    return;
+
+  // Usually fence is signaled long ago, GPU is more than kSegmentCount - 1 segments behind otherwise
+  constexpr GLuint64 kTimeout = 1'000'000'000;
+  GLenum result;
+  while((result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kTimeout)) == GL_TIMEOUT_EXPIRED)
+    GAME_LOG(LogType::Warning) << "Waiting for sprite buffer segment for more than a second";
+  GAME_ASSERT(result != GL_WAIT_FAILED) << "Couldn't wait for sprite buffer fence";
+  GL_CALL(glDeleteSync(fence));
+  fence = nullptr;
+}
+} // game
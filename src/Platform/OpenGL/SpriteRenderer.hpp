@@ -0,0 +1,101 @@
+#ifndef GAME_SPRITE_RENDERER_HPP
+#define GAME_SPRITE_RENDERER_HPP
+
+#include "Setup.hpp"
+
+#include <array>
+#include <cstddef>
+
+#include "Core/RenderQueue.hpp"
+#include "Platform/OpenGL/OpenGL.hpp"
+#include "Platform/OpenGL/ShaderCache.hpp"
+#include "Platform/OpenGL/GLState.hpp"
+
+
+namespace game
+{
+/// Instanced sprite batcher
+///
+/// Sprite instances are written straight into persistently mapped vertex buffer
+/// Buffer is split into segments that are fenced after use, so CPU never writes memory GPU still reads
+/// Every run of sprites with same shader and texture is drawn with single glDrawArraysInstanced
+/// Shaders are ids from ShaderCache, custom ones should use same vertex attributes and u_screen_size uniform as default one
+class SpriteRenderer
+{
+public:
+  static constexpr inline std::size_t kSegmentCount = 3;
+  static constexpr inline std::size_t kSpritesPerSegment = std::size_t{1} << 16;
+
+  SpriteRenderer() noexcept = default;
+  SpriteRenderer(const SpriteRenderer &) = delete;
+  SpriteRenderer &operator=(const SpriteRenderer &) = delete;
+
+  /// Create GL objects and load default shader from cache, context should be current
+  /// Bindings of batches go through state, so they are skipped when they don't change
+  void Init(ShaderCache &shaders, GLState &state) noexcept;
+  void Exit() noexcept;
+
+  /// Start frame with screen size in pixels
+  void Begin(int width, int height) noexcept;
+  /// Add sprite to batch, batch is drawn when shader or texture change
+  inline void Draw(uint32_t shader, uint32_t texture, const SpriteInstance &sprite) noexcept;
+  /// Draw sprites that are waiting in batch
+  /// return true if anything was drawn
+  auto Flush() noexcept -> bool;
+  /// Flush and fence memory used by this frame
+  void End() noexcept;
+
+  /// Draw calls since last Begin
+  [[nodiscard]] constexpr inline auto GetDrawCallCount() const noexcept -> uint32_t { return draw_call_count_; }
+  /// Texture used for sprites with texture 0
+  [[nodiscard]] constexpr inline auto GetWhiteTexture() const noexcept -> GLuint { return white_texture_; }
+
+private:
+  static constexpr inline uint32_t kNoBatch = ~uint32_t{0};
+
+  /// Fence current segment and wait until next one is free
+  void NextSegment() noexcept;
+
+  ShaderCache *shaders_ = nullptr;
+  GLState *state_ = nullptr;
+  uint32_t default_shader_ = 0;
+  GLuint vertex_array_ = 0;
+  GLuint buffer_ = 0;
+  GLuint white_texture_ = 0;
+  SpriteInstance *mapped_ = nullptr;
+  std::array<GLsync, kSegmentCount> fences_{};
+
+  std::size_t segment_ = 0;
+  /// Sprites written to current segment
+  std::size_t segment_used_ = 0;
+  /// First sprite of current batch in segment
+  std::size_t batch_begin_ = 0;
+  uint32_t batch_shader_ = kNoBatch;
+  uint32_t batch_texture_ = kNoBatch;
+
+  float screen_width_ = 1.0f;
+  float screen_height_ = 1.0f;
+  uint32_t draw_call_count_ = 0;
+};
+
+
+
+inline void SpriteRenderer::Draw(uint32_t shader, uint32_t texture, const SpriteInstance &sprite) noexcept
+{
+  if(GAME_IS_UNLIKELY(shader != batch_shader_ || texture != batch_texture_))
+  {
+    Flush();
+    batch_shader_ = shader;
+    batch_texture_ = texture;
+  }
+  if(GAME_IS_UNLIKELY(segment_used_ == kSpritesPerSegment))
+  {
+    Flush();
+    NextSegment();
+  }
+
+  mapped_[segment_ * kSpritesPerSegment + segment_used_++] = sprite;
+}
+} // game
+
+#endif // GAME_SPRITE_RENDERER_HPP
@@ -5,6 +5,10 @@
   #define GAME_OS_WIN
 #endif
 
+#if defined(__linux__)
+  #define GAME_OS_LINUX
+#endif
+
 #ifdef GAME_OS_WIN
   #include "Platform/Windows/Windows.hpp"
 #endif
@@ -0,0 +1,303 @@
+#include "BinaryLog.hpp"
+
+#include "Setup.hpp"
+
+#include <charconv>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+
+namespace game
+{
+namespace
+{
+template<typename T>
+void AppendValue(std::string &out, const T &value) noexcept
+{
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+auto ReadValue(const std::byte *&data, const std::byte *end, T &value) noexcept -> bool
+{
+  if(static_cast<std::size_t>(end - data) < sizeof(value))
+    return false;
+  std::memcpy(&value, data, sizeof(value));
+  data += sizeof(value);
+  return true;
+}
+
+/// Appends to string
+struct StringOutput
+{
+  std::string &out;
+
+  inline void Append(const char *text, std::size_t size) noexcept { out.append(text, size); }
+};
+
+/// Writes to fixed buffer, text that doesn't fit is cut
+struct BufferOutput
+{
+  char *out;
+  std::size_t capacity;
+  std::size_t size;
+
+  inline void Append(const char *text, std::size_t text_size) noexcept
+  {
+    const std::size_t count = std::min(text_size, capacity - size);
+    std::memcpy(out + size, text, count);
+    size += count;
+  }
+};
+
+template<typename Output, typename T>
+void AppendNumber(Output &out, T value, int base = 10) noexcept
+{
+  char text[24];
+  const std::to_chars_result result = std::to_chars(std::begin(text), std::end(text), value, base);
+  out.Append(text, static_cast<std::size_t>(result.ptr - text));
+}
+
+/// Same text as "%g" gives, to_chars with precision is defined as printf
+template<typename Output>
+void AppendFloat(Output &out, double value) noexcept
+{
+  char text[32];
+  const std::to_chars_result result = std::to_chars(std::begin(text), std::end(text), value, std::chars_format::general, 6);
+  out.Append(text, static_cast<std::size_t>(result.ptr - text));
+}
+
+/// Append text of one argument, return false if args end before it
+/// Nothing here allocates for BufferOutput, so it works in signal handler too
+template<typename Output>
+auto AppendArg(Output &out, BinaryArgType type, const std::byte *&data, const std::byte *end) noexcept -> bool
+{
+  // Text is the same as LogStream would write for the value
+  switch(type)
+  {
+  case BinaryArgType::Bool:
+  {
+    uint8_t value;
+    if(!ReadValue(data, end, value))
+      return false;
+    out.Append(value != 0 ? "1" : "0", 1);
+    return true;
+  }
+  case BinaryArgType::Char:
+  {
+    uint8_t value;
+    if(!ReadValue(data, end, value))
+      return false;
+    out.Append(reinterpret_cast<const char*>(&value), 1);
+    return true;
+  }
+  case BinaryArgType::Int32:
+  {
+    int32_t value;
+    if(!ReadValue(data, end, value))
+      return false;
+    AppendNumber(out, value);
+    return true;
+  }
+  case BinaryArgType::Int64:
+  {
+    int64_t value;
+    if(!ReadValue(data, end, value))
+      return false;
+    AppendNumber(out, value);
+    return true;
+  }
+  case BinaryArgType::UInt32:
+  {
+    uint32_t value;
+    if(!ReadValue(data, end, value))
+      return false;
+    AppendNumber(out, value);
+    return true;
+  }
+  case BinaryArgType::UInt64:
+  {
+    uint64_t value;
+    if(!ReadValue(data, end, value))
+      return false;
+    AppendNumber(out, value);
+    return true;
+  }
+  case BinaryArgType::Float:
+  {
+    float value;
+    if(!ReadValue(data, end, value))
+      return false;
+    AppendFloat(out, static_cast<double>(value));
+    return true;
+  }
+  case BinaryArgType::Double:
+  {
+    double value;
+    if(!ReadValue(data, end, value))
+      return false;
+    AppendFloat(out, value);
+    return true;
+  }
+  case BinaryArgType::String:
+  {
+    uint16_t length;
+    if(!ReadValue(data, end, length) || static_cast<std::size_t>(end - data) < length)
+      return false;
+    out.Append(reinterpret_cast<const char*>(data), length);
+    data += length;
+    return true;
+  }
+  case BinaryArgType::Pointer:
+  {
+    uint64_t value;
+    if(!ReadValue(data, end, value))
+      return false;
+    out.Append("0x", 2);
+    AppendNumber(out, value, 16);
+    return true;
+  }
+  case BinaryArgType::None:
+    break;
+  }
+  return false;
+}
+
+template<typename Output>
+void FormatLine(Output &out, const BinaryLogSite &site, const std::byte *args, std::size_t size) noexcept
+{
+  const std::byte *end = args + size;
+  std::size_t arg = 0;
+  for(const char *c = site.format; *c != '\0'; ++c)
+  {
+    if(c[0] != '{' || c[1] != '}')
+    {
+      out.Append(c, 1);
+      continue;
+    }
+    // Argument that didn't fit when line was logged
+    if(arg >= site.arg_count || !AppendArg(out, site.arg_types[arg], args, end))
+      out.Append("{?}", 3);
+    ++arg;
+    ++c;
+  }
+}
+
+/// Site read from file, strings are owned by it
+struct DecodedSite
+{
+  BinaryLogSite site;
+  std::string file;
+  std::string format;
+  std::vector<BinaryArgType> arg_types;
+};
+
+template<typename T>
+auto ReadValue(std::istream &in, T &value) noexcept -> bool
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+auto ReadString(std::istream &in, std::string &text) noexcept -> bool
+{
+  uint16_t size;
+  if(!ReadValue(in, size))
+    return false;
+  text.resize(size);
+  return static_cast<bool>(in.read(text.data(), size));
+}
+} // namespace
+
+void FormatBinaryLog(std::string &out, const BinaryLogSite &site, const std::byte *args, std::size_t size) noexcept
+{
+  StringOutput output{ out };
+  FormatLine(output, site, args, size);
+}
+
+auto FormatBinaryLog(char *out, std::size_t capacity, const BinaryLogSite &site, const std::byte *args, std::size_t size) noexcept -> std::size_t
+{
+  BufferOutput output{ out, capacity, 0 };
+  FormatLine(output, site, args, size);
+  return output.size;
+}
+
+void AppendBinaryLogSite(std::string &out, uint32_t id, const BinaryLogSite &site) noexcept
+{
+  const std::string_view file(site.file);
+  const std::string_view format(site.format);
+  out += static_cast<char>(BinaryLogEntry::Site);
+  AppendValue(out, id);
+  AppendValue(out, static_cast<int32_t>(site.line));
+  AppendValue(out, ToUnderlying(site.type));
+  AppendValue(out, static_cast<uint8_t>(site.arg_count));
+  out.append(reinterpret_cast<const char*>(site.arg_types), site.arg_count);
+  AppendValue(out, static_cast<uint16_t>(file.size()));
+  out += file;
+  AppendValue(out, static_cast<uint16_t>(format.size()));
+  out += format;
+}
+
+void AppendBinaryLogLine(std::string &out, uint32_t id, const std::byte *args, std::size_t size) noexcept
+{
+  out += static_cast<char>(BinaryLogEntry::Line);
+  AppendValue(out, id);
+  AppendValue(out, static_cast<uint16_t>(size));
+  out.append(reinterpret_cast<const char*>(args), size);
+}
+
+auto DecodeBinaryLog(std::istream &in, std::string &out) noexcept -> bool
+{
+  ZoneScopedC(0xbaed00);
+
+  std::string magic(kBinaryLogMagic.size(), '\0');
+  if(!in.read(magic.data(), static_cast<std::streamsize>(magic.size())) || magic != kBinaryLogMagic)
+    return false;
+
+  std::unordered_map<uint32_t, DecodedSite> sites;
+  std::vector<std::byte> args;
+  char entry;
+  while(in.get(entry))
+  {
+    uint32_t id;
+    if(!ReadValue(in, id))
+      return false;
+
+    if(entry == static_cast<char>(BinaryLogEntry::Site))
+    {
+      DecodedSite decoded;
+      int32_t line;
+      std::underlying_type_t<LogType> type;
+      uint8_t arg_count;
+      if(!ReadValue(in, line) || !ReadValue(in, type) || !ReadValue(in, arg_count))
+        return false;
+      decoded.arg_types.resize(arg_count);
+      if(!in.read(reinterpret_cast<char*>(decoded.arg_types.data()), arg_count) || !ReadString(in, decoded.file) || !ReadString(in, decoded.format))
+        return false;
+      decoded.site = BinaryLogSite{ line, nullptr, static_cast<LogType>(type), nullptr, nullptr, arg_count };
+      // Pointers are set once site stops moving
+      DecodedSite &site = sites[id] = std::move(decoded);
+      site.site.file = site.file.c_str();
+      site.site.format = site.format.c_str();
+      site.site.arg_types = site.arg_types.data();
+    }
+    else if(entry == static_cast<char>(BinaryLogEntry::Line))
+    {
+      uint16_t size;
+      if(!ReadValue(in, size))
+        return false;
+      args.resize(size);
+      if(!in.read(reinterpret_cast<char*>(args.data()), size))
+        return false;
+      const auto site = sites.find(id);
+      if(site == sites.end())
+        return false;
+      FormatBinaryLog(out, site->second.site, args.data(), args.size());
+      out += '\n';
+    }
+    else
+      return false;
+  }
+  return true;
+}
+} // game
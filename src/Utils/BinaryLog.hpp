@@ -0,0 +1,187 @@
+#ifndef GAME_BINARY_LOG_HPP
+#define GAME_BINARY_LOG_HPP
+
+#include "Setup.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "Utils/Logger.hpp"
+
+/// Log line with arguments in binary form, format is only formatted on logger thread or by LogDecoder tool
+/// Every {} in format is replaced by next argument, their counts are checked at compile time
+/// Call site is described once by static descriptor, call itself only copies argument bytes
+/// Arguments can be numbers, enums, bool, char, strings and pointers, strings longer than Logger::kMaxBinaryArgsSize are cut
+/// Format is the first of variadic arguments, so calls without arguments are valid C++17
+/// Line is filtered like GAME_LOG, arguments of line that is off aren't evaluated
+#define GAME_BLOG(type, ...) \
+  !GAME_LOG_IS_ON(type) ? (void)0 : [](const auto &, const auto &...game_blog_args) noexcept \
+  { \
+    static_assert(game::detail::CountBinaryLogArgs(GAME_BLOG_FORMAT(__VA_ARGS__, 0)) == sizeof...(game_blog_args), "Every {} in format needs one argument"); \
+    static constexpr game::BinaryLogSite game_blog_site{ __LINE__, __FILE__, type, GAME_BLOG_FORMAT(__VA_ARGS__, 0), \
+      game::detail::kBinaryArgTypes<std::decay_t<decltype(game_blog_args)>...>, sizeof...(game_blog_args) }; \
+    std::byte game_blog_data[game::Logger::kMaxBinaryArgsSize]; \
+    game::Logger::Get().PushBinary(game_blog_site, game_blog_data, game::detail::EncodeBinaryArgs(game_blog_data, game_blog_args...)); \
+  }(__VA_ARGS__)
+#define GAME_BLOG_FORMAT(format, ...) format
+
+namespace game
+{
+enum class BinaryArgType : uint8_t
+{
+  None, Bool, Char, Int32, Int64, UInt32, UInt64, Float, Double, String, Pointer
+};
+
+/// Static description of GAME_BLOG call site
+struct BinaryLogSite
+{
+  int line;
+  const char *file;
+  LogType type;
+  const char *format;
+  const BinaryArgType *arg_types;
+  std::size_t arg_count;
+};
+
+/// .binlog file starts with kBinaryLogMagic, then it has entries that start with BinaryLogEntry byte
+/// Site: u32 id, i32 line, u8 LogType, u8 arg count, arg types, u16 file size, file, u16 format size, format
+/// Line: u32 site id, u16 args size, args
+/// Site entry comes before the first line of it, numbers are in native byte order
+enum class BinaryLogEntry : uint8_t
+{
+  Site = 'S', Line = 'L'
+};
+inline constexpr std::string_view kBinaryLogMagic{"GAMEBLOG1\n"};
+
+/// Append text of line to out
+void FormatBinaryLog(std::string &out, const BinaryLogSite &site, const std::byte *args, std::size_t size) noexcept;
+/// Write text of line to out of capacity bytes, text that doesn't fit is cut
+/// Doesn't allocate, so it can be used in signal handler
+/// return written size
+auto FormatBinaryLog(char *out, std::size_t capacity, const BinaryLogSite &site, const std::byte *args, std::size_t size) noexcept -> std::size_t;
+/// Append entries of .binlog file to out
+void AppendBinaryLogSite(std::string &out, uint32_t id, const BinaryLogSite &site) noexcept;
+void AppendBinaryLogLine(std::string &out, uint32_t id, const std::byte *args, std::size_t size) noexcept;
+/// Append text of every line in .binlog stream to out, each line ends with '\n'
+/// return false if stream isn't .binlog or it ends in the middle of entry, lines before are still decoded
+auto DecodeBinaryLog(std::istream &in, std::string &out) noexcept -> bool;
+
+namespace detail
+{
+template<typename T>
+constexpr auto GetBinaryArgType() noexcept -> BinaryArgType
+{
+  if constexpr(std::is_same_v<T, bool>)
+    return BinaryArgType::Bool;
+  else if constexpr(std::is_same_v<T, char>)
+    return BinaryArgType::Char;
+  else if constexpr(std::is_enum_v<T>)
+    return GetBinaryArgType<std::underlying_type_t<T>>();
+  else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>)
+    return sizeof(T) <= sizeof(int32_t) ? BinaryArgType::Int32 : BinaryArgType::Int64;
+  else if constexpr(std::is_integral_v<T>)
+    return sizeof(T) <= sizeof(uint32_t) ? BinaryArgType::UInt32 : BinaryArgType::UInt64;
+  else if constexpr(std::is_same_v<T, float>)
+    return BinaryArgType::Float;
+  else if constexpr(std::is_same_v<T, double>)
+    return BinaryArgType::Double;
+  else if constexpr(std::is_convertible_v<T, std::string_view>)
+    return BinaryArgType::String;
+  else if constexpr(std::is_pointer_v<T>)
+    return BinaryArgType::Pointer;
+  else
+    static_assert(sizeof(T) == 0, "Type can't be logged in binary form");
+}
+
+/// Ends with None, so it isn't empty for calls without arguments
+template<typename... Args>
+inline constexpr BinaryArgType kBinaryArgTypes[] = { GetBinaryArgType<Args>()..., BinaryArgType::None };
+
+constexpr auto CountBinaryLogArgs(std::string_view format) noexcept -> std::size_t
+{
+  std::size_t count = 0;
+  for(std::size_t i = 0; i + 1 < format.size(); ++i)
+    if(format[i] == '{' && format[i + 1] == '}')
+    {
+      ++count;
+      ++i;
+    }
+  return count;
+}
+
+struct BinaryArgEncoder
+{
+  std::byte *data;
+  std::size_t size;
+  /// Set once argument doesn't fit, later ones aren't written so decoder doesn't misread them
+  bool full;
+
+  inline void Write(const void *value, std::size_t value_size) noexcept
+  {
+    if(full || Logger::kMaxBinaryArgsSize - size < value_size)
+    {
+      full = true;
+      return;
+    }
+    std::memcpy(data + size, value, value_size);
+    size += value_size;
+  }
+
+  template<typename T>
+  inline void Encode(const T &value) noexcept
+  {
+    using Type = std::decay_t<T>;
+    constexpr BinaryArgType kType = GetBinaryArgType<Type>();
+    if constexpr(kType == BinaryArgType::String)
+    {
+      const std::string_view text(value);
+      if(full || Logger::kMaxBinaryArgsSize - size < sizeof(uint16_t))
+      {
+        full = true;
+        return;
+      }
+      const uint16_t length = static_cast<uint16_t>(std::min(text.size(), Logger::kMaxBinaryArgsSize - size - sizeof(uint16_t)));
+      Write(&length, sizeof(length));
+      Write(text.data(), length);
+    }
+    else if constexpr(kType == BinaryArgType::Bool || kType == BinaryArgType::Char)
+    {
+      const uint8_t stored = static_cast<uint8_t>(value);
+      Write(&stored, sizeof(stored));
+    }
+    else if constexpr(kType == BinaryArgType::Int32 || kType == BinaryArgType::UInt32 || kType == BinaryArgType::Int64 || kType == BinaryArgType::UInt64)
+    {
+      using Stored = std::conditional_t<kType == BinaryArgType::Int32, int32_t, std::conditional_t<kType == BinaryArgType::UInt32, uint32_t,
+        std::conditional_t<kType == BinaryArgType::Int64, int64_t, uint64_t>>>;
+      const Stored stored = static_cast<Stored>(value);
+      Write(&stored, sizeof(stored));
+    }
+    else if constexpr(kType == BinaryArgType::Pointer)
+    {
+      const uint64_t stored = reinterpret_cast<uintptr_t>(value);
+      Write(&stored, sizeof(stored));
+    }
+    else
+      Write(&value, sizeof(value));
+  }
+};
+
+/// Write arguments into data of Logger::kMaxBinaryArgsSize bytes
+/// return written size
+template<typename... Args>
+inline auto EncodeBinaryArgs(std::byte *data, const Args &...args) noexcept -> std::size_t
+{
+  BinaryArgEncoder encoder{ data, 0, false };
+  (encoder.Encode(args), ...);
+  return encoder.size;
+}
+} // detail
+} // game
+
+#endif // GAME_BINARY_LOG_HPP
@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <iostream>
+#include <cstdlib>
 
 #include "Utils/String.hpp"
 
@@ -194,6 +195,25 @@ auto Flags::ParseFlag(ConstArgvType flag_begin, const ConstArgvType possible_fla
   }
 }
 
+auto Flags::GetPositiveNumber(const std::string &flag, double def) const noexcept -> double
+{
+  ZoneScopedC(0xbaed00);
+
+  const auto it = flags_.find(flag);
+  if(it == flags_.end())
+    return def;
+
+  const std::string &value = it->second;
+  char *end;
+  const double number = std::strtod(value.c_str(), &end);
+  if(end == value.c_str() || *end != '\0' || !(number > 0.0))
+  {
+    GAME_LOG(LogType::Warning) << "Flag " << flag << " expects positive number, got: " << value;
+    return def;
+  }
+  return number;
+}
+
 void Flags::Parse() noexcept
 {
   ZoneScopedC(0xbaed00);
@@ -53,6 +53,10 @@ public:
   /// return pair with begin and end of range i.e. Flags::RangeType
   inline auto GetRange(const std::string &flag) const noexcept -> RangeType { return flags_.equal_range(flag); }
 
+  /// Get flag value as positive number
+  /// return def if flag doesn't exist or it's value isn't a positive number
+  auto GetPositiveNumber(const std::string &flag, double def) const noexcept -> double;
+
 
   /// Get constant iterator to the begining of flag map
   inline auto begin() const noexcept -> MapType::const_iterator { return flags_.cbegin(); }
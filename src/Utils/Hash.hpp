@@ -3,6 +3,8 @@
 
 #include "Setup.hpp"
 
+#include <string_view>
+
 
 namespace game
 {
@@ -56,15 +58,28 @@ static constexpr unsigned int crcTable[256] = {
 
 template<std::size_t index>
 constexpr uint32_t Crc32(const char *string)
-{ return (Crc32<index - 1>(string) >> 8) ^ crcTable[(Crc32<index - 1>(string) ^ string[index]) & 0x000000FF]; }
+{
+  // Previous value is evaluated only once, otherwise amount of calls grows exponentially with string length
+  const uint32_t previous = Crc32<index - 1>(string);
+  return (previous >> 8) ^ crcTable[(previous ^ string[index]) & 0x000000FF];
+}
 
 template<>
 constexpr uint32_t Crc32<std::size_t(-1)>(__attribute__((unused)) const char *string)
 { return 0xFFFFFFFF; }
 } // detail
 
-/// Constexpr hash of a string
-#define HASH_STRING(x) (detail::Crc32<sizeof(x) - 1>(x))
+/// Constexpr hash of a string literal, its terminating null isn't hashed, so it is equal to HashString of the same characters
+#define HASH_STRING(x) (game::detail::Crc32<sizeof(x) - 2>(x))
+
+/// Hash of a string that is known only at runtime, equal to HASH_STRING of the same characters
+constexpr inline auto HashString(std::string_view string) noexcept -> uint32_t
+{
+  uint32_t hash = 0xFFFFFFFF;
+  for(const char c : string)
+    hash = (hash >> 8) ^ detail::crcTable[(hash ^ static_cast<unsigned char>(c)) & 0x000000FF];
+  return hash;
+}
 
 /// Hash given type
 template<typename T> constexpr inline std::size_t HeshType()
@@ -0,0 +1,164 @@
+#include "LZ4.hpp"
+
+#include "Setup.hpp"
+
+#include <cstring>
+#include <memory>
+
+
+namespace game
+{
+namespace
+{
+constexpr std::size_t kMinMatch = 4;
+/// Last match should start at least that many bytes before the end of input
+constexpr std::size_t kMatchStartLimit = 12;
+/// Last that many bytes are always literals
+constexpr std::size_t kLastLiterals = 5;
+constexpr std::size_t kMaxOffset = 65535;
+constexpr int kHashBits = 16;
+
+inline auto Read32(const std::byte *data) noexcept -> uint32_t
+{
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline auto Hash(uint32_t sequence) noexcept -> uint32_t
+{
+  // Knuth's multiplicative hash
+  return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+/// Write length that didn't fit in token as 255 255 ... rest
+inline void WriteLength(std::size_t length, std::vector<std::byte> &output) noexcept
+{
+  for(; length >= 255; length -= 255)
+    output.push_back(std::byte{255});
+  output.push_back(static_cast<std::byte>(length));
+}
+
+void WriteSequence(const std::byte *literals, std::size_t literal_count, std::size_t offset, std::size_t match_length, std::vector<std::byte> &output) noexcept
+{
+  const std::size_t match_code = match_length == 0 ? 0 : match_length - kMinMatch;
+  const uint8_t token = static_cast<uint8_t>((literal_count < 15 ? literal_count : 15) << 4 | (match_code < 15 ? match_code : 15));
+  output.push_back(static_cast<std::byte>(token));
+  if(literal_count >= 15)
+    WriteLength(literal_count - 15, output);
+  output.insert(output.end(), literals, literals + literal_count);
+
+  // Last sequence has only literals
+  if(match_length == 0)
+    return;
+  output.push_back(static_cast<std::byte>(offset & 0xff));
+  output.push_back(static_cast<std::byte>(offset >> 8));
+  if(match_code >= 15)
+    WriteLength(match_code - 15, output);
+}
+} // namespace
+
+void LZ4Compress(const std::byte *data, std::size_t size, std::vector<std::byte> &output) noexcept
+{
+  ZoneScopedC(0x3e2ed1);
+
+  output.reserve(output.size() + LZ4CompressBound(size));
+  std::size_t anchor = 0;
+  if(size > kMatchStartLimit)
+  {
+    // Positions are stored plus one, so zero means empty
+    std::unique_ptr<uint32_t[]> table(new uint32_t[std::size_t{1} << kHashBits]());
+    const std::size_t match_start_end = size - kMatchStartLimit;
+    const std::size_t match_end = size - kLastLiterals;
+    std::size_t position = 0;
+    while(position < match_start_end)
+    {
+      const uint32_t sequence = Read32(data + position);
+      uint32_t &slot = table[Hash(sequence)];
+      const std::size_t candidate = slot;
+      slot = static_cast<uint32_t>(position + 1);
+      if(candidate == 0 || position - (candidate - 1) > kMaxOffset || Read32(data + candidate - 1) != sequence)
+      {
+        ++position;
+        continue;
+      }
+
+      const std::size_t reference = candidate - 1;
+      std::size_t length = kMinMatch;
+      while(position + length < match_end && data[reference + length] == data[position + length])
+        ++length;
+
+      WriteSequence(data + anchor, position - anchor, position - reference, length, output);
+      position += length;
+      anchor = position;
+    }
+  }
+  WriteSequence(data + anchor, size - anchor, 0, 0, output);
+}
+
+auto LZ4Decompress(const std::byte *data, std::size_t size, std::byte *output, std::size_t output_size) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  const std::byte *input = data;
+  const std::byte *const input_end = data + size;
+  std::byte *out = output;
+  std::byte *const output_end = output + output_size;
+
+  // Reads length continuation bytes, false if input ends in the middle
+  const auto read_length = [&](std::size_t &length) -> bool
+  {
+    uint8_t byte;
+    do
+    {
+      if(GAME_IS_UNLIKELY(input == input_end))
+        return false;
+      byte = static_cast<uint8_t>(*input++);
+      length += byte;
+    } while(byte == 255);
+    return true;
+  };
+
+  while(input < input_end)
+  {
+    const uint8_t token = static_cast<uint8_t>(*input++);
+
+    std::size_t literal_count = token >> 4;
+    if(literal_count == 15 && !read_length(literal_count))
+      return false;
+    if(GAME_IS_UNLIKELY(literal_count > static_cast<std::size_t>(input_end - input) || literal_count > static_cast<std::size_t>(output_end - out)))
+      return false;
+    std::memcpy(out, input, literal_count);
+    input += literal_count;
+    out += literal_count;
+
+    if(input == input_end)
+      break;
+
+    if(GAME_IS_UNLIKELY(input_end - input < 2))
+      return false;
+    const std::size_t offset = static_cast<std::size_t>(input[0]) | static_cast<std::size_t>(input[1]) << 8;
+    input += 2;
+    if(GAME_IS_UNLIKELY(offset == 0 || offset > static_cast<std::size_t>(out - output)))
+      return false;
+
+    std::size_t match_length = token & 15;
+    if(match_length == 15 && !read_length(match_length))
+      return false;
+    match_length += kMinMatch;
+    if(GAME_IS_UNLIKELY(match_length > static_cast<std::size_t>(output_end - out)))
+      return false;
+
+    // Match can overlap with bytes it produces, so it is copied forward byte by byte when close
+    const std::byte *match = out - offset;
+    if(offset >= match_length)
+      std::memcpy(out, match, match_length);
+    else
+      for(std::size_t i = 0; i < match_length; ++i)
+        out[i] = match[i];
+    out += match_length;
+  }
+
+  return out == output_end;
+}
+} // game
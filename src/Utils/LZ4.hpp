@@ -0,0 +1,27 @@
+#ifndef GAME_LZ4_HPP
+#define GAME_LZ4_HPP
+
+#include "Setup.hpp"
+
+#include <vector>
+#include <cstddef>
+
+
+namespace game
+{
+/// LZ4 block format compression
+///
+/// Output is a raw LZ4 block (no frame header), so it can be read by reference lz4 and the other way round
+/// Compressor is greedy single pass with 64K entry hash table, it trades ratio for speed like LZ4 fast mode
+/// Decompressor checks every read and write, so corrupted input can't make it go out of bounds
+
+/// Worst case size of compressed data
+[[nodiscard]] constexpr inline auto LZ4CompressBound(std::size_t size) noexcept -> std::size_t { return size + size / 255 + 16; }
+/// Compress data and append it to output
+void LZ4Compress(const std::byte *data, std::size_t size, std::vector<std::byte> &output) noexcept;
+/// Decompress block that expands exactly to output_size bytes
+/// return false if block is corrupted or size doesn't match
+[[nodiscard]] auto LZ4Decompress(const std::byte *data, std::size_t size, std::byte *output, std::size_t output_size) noexcept -> bool;
+} // game
+
+#endif // GAME_LZ4_HPP
@@ -0,0 +1,112 @@
+#include "LogArchive.hpp"
+
+#include "Setup.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <system_error>
+#include <vector>
+
+#include "Platform/MappedFile.hpp"
+#include "Utils/LZ4.hpp"
+
+
+namespace game
+{
+namespace
+{
+/// Part of file name that is the same for every file of one log
+auto GetLogStem(const std::filesystem::path &path) noexcept -> std::string
+{
+  const std::string name = path.filename().string();
+  return name.substr(0, name.find('.'));
+}
+} // namespace
+
+auto CompressLogFile(const std::filesystem::path &path) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  std::vector<std::byte> output(kLogArchiveMagic.size() + sizeof(uint64_t));
+  std::memcpy(output.data(), kLogArchiveMagic.data(), kLogArchiveMagic.size());
+  {
+    MappedFile file;
+    // Empty file can't be mapped and it doesn't need to be
+    const uint64_t size = file.Open(path.string()) ? file.GetSize() : 0;
+    std::memcpy(output.data() + kLogArchiveMagic.size(), &size, sizeof(size));
+    if(size != 0)
+      LZ4Compress(file.GetData(), file.GetSize(), output);
+  }
+
+  std::filesystem::path archive = path;
+  archive += kLogArchiveExtension;
+  std::filesystem::path part = archive;
+  part += ".part";
+  {
+    std::ofstream out(part, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(output.data()), static_cast<std::streamsize>(output.size()));
+    if(!out.good())
+      return false;
+  }
+
+  std::error_code error;
+  std::filesystem::rename(part, archive, error);
+  if(error)
+    return false;
+  std::filesystem::remove(path, error);
+  return !error;
+}
+
+auto ReadLogFile(const std::filesystem::path &path, std::string &content) noexcept -> bool
+{
+  ZoneScopedC(0x3e2ed1);
+
+  std::ifstream in(path, std::ios::binary);
+  if(!in.is_open())
+    return false;
+  const std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if(in.bad())
+    return false;
+
+  const std::size_t header_size = kLogArchiveMagic.size() + sizeof(uint64_t);
+  if(file.size() < header_size || std::string_view(file).substr(0, kLogArchiveMagic.size()) != kLogArchiveMagic)
+  {
+    content = file;
+    return true;
+  }
+
+  uint64_t size;
+  std::memcpy(&size, file.data() + kLogArchiveMagic.size(), sizeof(size));
+  content.resize(size);
+  return size == 0 || LZ4Decompress(reinterpret_cast<const std::byte*>(file.data()) + header_size, file.size() - header_size,
+    reinterpret_cast<std::byte*>(content.data()), content.size());
+}
+
+void RemoveOldLogs(const std::filesystem::path &directory, std::size_t count) noexcept
+{
+  ZoneScopedC(0x3e2ed1);
+
+  std::error_code error;
+  std::vector<std::filesystem::path> files;
+  std::set<std::string> stems;
+  for(const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory, error))
+  {
+    const std::string name = entry.path().filename().string();
+    if(name.compare(0, kLogArchivePrefix.size(), kLogArchivePrefix) != 0)
+      continue;
+    files.push_back(entry.path());
+    stems.insert(GetLogStem(entry.path()));
+  }
+  if(stems.size() <= count)
+    return;
+
+  // Names sort from the oldest, so the first stems are removed
+  const auto newest = std::next(stems.begin(), static_cast<std::ptrdiff_t>(stems.size() - count));
+  const std::set<std::string> removed(stems.begin(), newest);
+  for(const std::filesystem::path &file : files)
+    if(removed.count(GetLogStem(file)) != 0)
+      std::filesystem::remove(file, error);
+}
+} // game
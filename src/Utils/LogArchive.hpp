@@ -0,0 +1,30 @@
+#ifndef GAME_LOG_ARCHIVE_HPP
+#define GAME_LOG_ARCHIVE_HPP
+
+#include "Setup.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+
+namespace game
+{
+/// Rotated log files are named prefix, time and sequence number, so their names sort from the oldest to the newest
+/// Files whose names are the same up to first '.' belong to one log, like text and binary part of it
+inline const std::string kLogArchivePrefix{"log_"};
+/// Compressed file is kLogArchiveMagic, u64 size of original file and LZ4 block of it
+inline constexpr std::string_view kLogArchiveMagic{"GLZ4"};
+inline const std::string kLogArchiveExtension{".lz4"};
+
+/// Compress file into file with kLogArchiveExtension added and remove it
+/// Compressed file is complete once it has its name, so crash leaves at most a .part file behind
+auto CompressLogFile(const std::filesystem::path &path) noexcept -> bool;
+/// Read whole log file, compressed one is decompressed
+auto ReadLogFile(const std::filesystem::path &path, std::string &content) noexcept -> bool;
+/// Remove every file of the oldest archived logs in directory, so that at most count logs stay
+void RemoveOldLogs(const std::filesystem::path &directory, std::size_t count) noexcept;
+} // game
+
+#endif // GAME_LOG_ARCHIVE_HPP
@@ -7,42 +7,589 @@
 #include <optional>
 #include <string>
 #include <filesystem>
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <ctime>
+#include <system_error>
+
+#include "Platform/Platform.hpp"
+#include "Platform/FileAllocation.hpp"
+#include "Utils/MPSCQueue.hpp"
+#include "Utils/BinaryLog.hpp"
+#include "Utils/LogArchive.hpp"
 
 
 namespace game
 {
+namespace detail
+{
+/// Formatted line waiting in queue, long lines are kept on heap until writer frees them
+/// Start of long line is in text too, so crash handler never reads heap
+/// Line of GAME_BLOG has site and its text are encoded arguments
+struct LogRecord
+{
+  static constexpr inline std::size_t kInlineSize = Logger::kMaxBinaryArgsSize;
+
+  char *heap;
+  const BinaryLogSite *site;
+  uint32_t size;
+  LogType type;
+  char text[kInlineSize];
+
+  [[nodiscard]] inline auto GetText() const noexcept -> const char* { return heap != nullptr ? heap : text; }
+};
+
+/// Record of crash history guarded by sequence lock, sequence is odd while writer changes record
+struct CrashRecord
+{
+  std::atomic<uint32_t> sequence{0};
+  LogRecord record;
+};
+} // detail
+
+namespace
+{
+/// Batch is written once it grows that big, even if queue isn't empty yet
+constexpr std::size_t kMaxBatchSize = 256 * 1024;
+
+auto ParseLogType(std::string_view name, LogType &type) noexcept -> bool
+{
+  for(uint8_t i = 0; i <= ToUnderlying(LogType::Info); ++i)
+    if(Logger::GetLogTypeName(static_cast<LogType>(i)) == name)
+    {
+      type = static_cast<LogType>(i);
+      return true;
+    }
+  return false;
+}
+
+auto ParseLogModule(std::string_view name, LogModule &module) noexcept -> bool
+{
+  for(uint8_t i = 0; i < ToUnderlying(LogModule::Count); ++i)
+    if(Logger::GetLogModuleName(static_cast<LogModule>(i)) == name)
+    {
+      module = static_cast<LogModule>(i);
+      return true;
+    }
+  return false;
+}
+
+/// Archive name from current time, so names sort from the oldest
+/// Sequence number keeps names of files archived in the same millisecond, by this or other run, apart
+/// Name sorts after previous one, even if files with the same time were removed meanwhile
+auto MakeArchiveStem(const std::filesystem::path &directory, const std::string &previous) noexcept -> std::string
+{
+  const auto now = std::chrono::system_clock::now();
+  const std::time_t time = std::chrono::system_clock::to_time_t(now);
+  std::tm local{};
+  #ifdef GAME_OS_WIN
+    localtime_s(&local, &time);
+  #else
+    localtime_r(&time, &local);
+  #endif
+  char text[64];
+  std::size_t size = std::strftime(text, sizeof(text), "%Y%m%d_%H%M%S", &local);
+  const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+  size += static_cast<std::size_t>(std::snprintf(text + size, sizeof(text) - size, "_%03d", static_cast<int>(milliseconds)));
+
+  for(unsigned sequence = 0;; ++sequence)
+  {
+    char number[16];
+    std::snprintf(number, sizeof(number), "_%02u", sequence);
+    const std::string stem = kLogArchivePrefix + std::string(text, size) + number;
+    std::error_code error;
+    bool used = false;
+    for(const char *extension : { ".txt", ".txt.lz4", ".binlog", ".binlog.lz4", ".crash.txt", ".crash.txt.lz4" })
+      used = used || std::filesystem::exists(directory / (stem + extension), error);
+    if(!used && stem > previous)
+      return stem;
+  }
+}
+} // namespace
+
 Logger::Logger() noexcept
+: queue_(std::make_unique<MPSCQueue<detail::LogRecord>>(kQueueCapacity))
+, last_flush_(std::chrono::steady_clock::now())
+, history_(std::make_unique<detail::CrashRecord[]>(kCrashLineCount))
 {
   ZoneScopedC(0xbaed00);
 
-  std::filesystem::create_directories(kDefLogPath);
+  // Logger can't log its own failure, nothing would be there to write it
+  std::error_code error;
+  std::filesystem::create_directories(kDefLogPath, error);
+  // Log of previous run is kept instead of being overwritten
+  std::vector<std::filesystem::path> previous;
+  if(archive_enabled_)
+  {
+    archiving_ = true;
+    archiver_ = std::thread(&Logger::ArchiverLoop, this);
+    previous = MoveToArchive();
+  }
   file_.open(file_path_, std::ios_base::out | std::ios_base::trunc);
-  GAME_ASSERT(file_.good()) << "Couldn't creaate file: " << file_path_ << " when initialized LogStream: " << this;
+  if(!file_.good())
+  {
+    std::cerr << "Couldn't create log file " << file_path_ << ", logging only to stream\n";
+    output_to_file_ = false;
+  }
+  opened_time_ = std::chrono::steady_clock::now();
+  if(!previous.empty())
+    Archive(std::move(previous));
+
+  batch_.reserve(kMaxBatchSize);
+  running_ = true;
+  writer_ = std::thread(&Logger::WriterLoop, this);
+  instance_.store(this, std::memory_order_release);
 }
 
 Logger::~Logger() noexcept
 {
   ZoneScopedC(0xbaed00);
 
+  instance_.store(nullptr, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    running_ = false;
+  }
+  wake_condition_.notify_one();
+  writer_.join();
+
+  Flush();
   file_.close();
+  binary_file_.close();
+
+  if(!archiver_.joinable())
+    return;
+  // Files that are queued already are still archived
+  {
+    std::lock_guard<std::mutex> lock(archive_mutex_);
+    archiving_ = false;
+  }
+  archive_condition_.notify_one();
+  archiver_.join();
 }
 
-LogStream::~LogStream() noexcept
+void Logger::Flush() noexcept
 {
-  ZoneScopedNC("Log whole", 0xbaed00);
+  ZoneScopedC(0xbaed00);
 
-  string_stream << '\n';
-  Logger::Get().GetStream() << string_stream.str();
-  if(Logger::Get().IsOutputToFile())
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  Drain(true);
+}
+
+void Logger::SetFlushPolicy(const LogFlushPolicy &policy) noexcept
+{
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  policy_ = policy;
+  flush_type_.store(policy.flush_type, std::memory_order_relaxed);
+}
+
+void Logger::SetRotationPolicy(const LogRotationPolicy &policy) noexcept
+{
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  rotation_ = policy;
+}
+
+auto Logger::SetModuleTypes(std::string_view text) noexcept -> bool
+{
+  while(!text.empty())
+  {
+    const std::size_t end = std::min(text.find(','), text.size());
+    const std::string_view entry = text.substr(0, end);
+    text.remove_prefix(std::min(end + 1, text.size()));
+
+    const std::size_t colon = entry.find(':');
+    LogType type;
+    if(!ParseLogType(colon == std::string_view::npos ? entry : entry.substr(colon + 1), type))
+      return false;
+    if(colon == std::string_view::npos)
+    {
+      for(uint8_t module = 0; module < ToUnderlying(LogModule::Count); ++module)
+        SetModuleType(static_cast<LogModule>(module), type);
+      continue;
+    }
+    LogModule module;
+    if(!ParseLogModule(entry.substr(0, colon), module))
+      return false;
+    SetModuleType(module, type);
+  }
+  return true;
+}
+
+void Logger::SetBinaryOutput(bool binary_output) noexcept
+{
+  ZoneScopedC(0xbaed00);
+
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  // Lines queued so far are written the old way
+  Drain(true);
+  if(binary_file_.is_open() == binary_output)
+    return;
+  if(!binary_output)
+  {
+    binary_file_.close();
+    return;
+  }
+  OpenBinaryFile();
+}
+
+void Logger::OpenBinaryFile() noexcept
+{
+  const std::filesystem::path path = kDefLogPath / kDefBinaryLogFileName;
+  binary_file_.open(path, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+  if(!binary_file_.good())
+  {
+    std::cerr << "Couldn't create binary log file " << path.generic_string() << ", binary lines are formatted\n";
+    binary_file_.close();
+    return;
+  }
+  binary_file_.write(kBinaryLogMagic.data(), static_cast<std::streamsize>(kBinaryLogMagic.size()));
+  binary_sites_.clear();
+}
+
+void Logger::PushBinary(const BinaryLogSite &site, const std::byte *args, std::size_t size) noexcept
+{
+  detail::LogRecord record;
+  record.heap = nullptr;
+  record.site = &site;
+  record.size = static_cast<uint32_t>(size);
+  record.type = site.type;
+  std::memcpy(record.text, args, size);
+  Push(record);
+
+  if(site.type == LogType::Fatal)
+  {
+    Flush();
+    std::abort();
+  }
+}
+
+void Logger::Push(std::string_view line, LogType type) noexcept
+{
+  detail::LogRecord record;
+  record.site = nullptr;
+  record.size = static_cast<uint32_t>(line.size());
+  record.type = type;
+  record.heap = line.size() > detail::LogRecord::kInlineSize ? new char[line.size()] : nullptr;
+  if(record.heap != nullptr)
+    std::memcpy(record.heap, line.data(), line.size());
+  std::memcpy(record.text, line.data(), std::min(line.size(), detail::LogRecord::kInlineSize));
+  Push(record);
+}
+
+void Logger::Push(const detail::LogRecord &record) noexcept
+{
+  // Fatal is the smallest value, so smaller means more severe
+  const bool severe = record.type <= flush_type_.load(std::memory_order_relaxed);
+  while(GAME_IS_UNLIKELY(!queue_->TryPush(record)))
+  {
+    if(!severe)
+    {
+      delete[] record.heap;
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    // Make room on this thread if writer isn't draining right now, writer could be gone already
+    if(std::unique_lock<std::mutex> lock(write_mutex_, std::try_to_lock); lock.owns_lock())
+      Drain(false);
+    else
+      std::this_thread::yield();
+  }
+
+  if(severe)
+    urgent_.store(true, std::memory_order_relaxed);
+  // Pairs with fence of writer, either it sees the line or this thread sees it sleeping
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if(writer_sleeping_.load(std::memory_order_relaxed))
+  {
+    // Lock so notification can't be sent between writer checking for lines and going to sleep
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    wake_condition_.notify_one();
+  }
+}
+
+void Logger::WriterLoop() noexcept
+{
+  #ifdef TRACY_ENABLE
+  tracy::SetThreadName("Logger");
+  #endif
+
+  // Writer sleeps until line is pushed, timeout is used only while written lines wait for flush
+  bool unflushed = false;
+  std::chrono::steady_clock::time_point flush_time;
+  while(true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      writer_sleeping_.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const auto wake = [this]{ return urgent_.load(std::memory_order_relaxed) || queue_->GetSizeApprox() != 0 || !running_; };
+      if(unflushed)
+        wake_condition_.wait_until(lock, flush_time, wake);
+      else
+        wake_condition_.wait(lock, wake);
+      writer_sleeping_.store(false, std::memory_order_relaxed);
+      if(!running_)
+        return;
+    }
+
+    const bool urgent = urgent_.exchange(false, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Drain(urgent);
+    unflushed = unflushed_size_ != 0;
+    flush_time = last_flush_ + policy_.interval;
+  }
+}
+
+void Logger::Drain(bool flush) noexcept
+{
+  const LogType flush_type = policy_.flush_type;
+  detail::LogRecord record;
+  while(true)
+  {
+    while(batch_.size() + binary_batch_.size() < kMaxBatchSize && queue_->TryPop(record))
+    {
+      Remember(record);
+      if(record.site == nullptr)
+        batch_.append(record.GetText(), record.size);
+      else if(binary_file_.is_open())
+        AppendBinary(record);
+      else
+      {
+        FormatBinaryLog(batch_, *record.site, reinterpret_cast<const std::byte*>(record.text), record.size);
+        batch_ += '\n';
+      }
+      delete[] record.heap;
+      flush = flush || record.type <= flush_type;
+    }
+
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if(dropped != reported_dropped_)
+    {
+      batch_ += "Dropped " + std::to_string(dropped - reported_dropped_) + " log lines, log queue was full\n";
+      reported_dropped_ = dropped;
+    }
+    if(batch_.empty() && binary_batch_.empty())
+      break;
+
+    ZoneScopedNC("Log write", 0xbaed00);
+    ZoneValue(batch_.size() + binary_batch_.size());
+    if(!binary_batch_.empty())
+    {
+      binary_file_.write(binary_batch_.data(), static_cast<std::streamsize>(binary_batch_.size()));
+      unflushed_size_ += binary_batch_.size();
+      written_size_ += binary_batch_.size();
+      binary_batch_.clear();
+    }
+    if(batch_.empty())
+      continue;
+    // Stream is usually console that someone watches, so it isn't kept waiting for policy
+    stream_.write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+    stream_.flush();
+    if(output_to_file_)
+    {
+      file_.write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+      written_size_ += batch_.size();
+    }
+    unflushed_size_ += batch_.size();
+    batch_.clear();
+  }
+
+  if(output_to_file_ && written_size_ > allocated_size_)
+  {
+    ZoneScopedNC("Log preallocate", 0xbaed00);
+    allocated_size_ = written_size_ + kPreallocationStep;
+    (void)PreallocateFile(file_path_, allocated_size_);
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  if(unflushed_size_ != 0 && (flush || unflushed_size_ >= policy_.size || now - last_flush_ >= policy_.interval))
+  {
+    ZoneScopedNC("Log flush", 0xbaed00);
+    if(output_to_file_)
+      file_.flush();
+    if(binary_file_.is_open())
+      binary_file_.flush();
+    unflushed_size_ = 0;
+    last_flush_ = now;
+  }
+
+  if(archive_enabled_ && written_size_ != 0 && ((rotation_.size != 0 && written_size_ >= rotation_.size) || (rotation_.interval.count() != 0 && now - opened_time_ >= rotation_.interval)))
+    Rotate();
+}
+
+void Logger::Rotate() noexcept
+{
+  ZoneScopedNC("Log rotate", 0xbaed00);
+
+  const bool binary = binary_file_.is_open();
+  file_.close();
+  binary_file_.close();
+  std::vector<std::filesystem::path> files = MoveToArchive();
+
+  file_.open(file_path_, std::ios_base::out | std::ios_base::trunc);
+  if(output_to_file_ && !file_.good())
+  {
+    std::cerr << "Couldn't create log file " << file_path_ << " after rotation, logging only to stream\n";
+    output_to_file_ = false;
+  }
+  if(binary)
+    OpenBinaryFile();
+  written_size_ = 0;
+  allocated_size_ = 0;
+  opened_time_ = std::chrono::steady_clock::now();
+  Archive(std::move(files));
+}
+
+auto Logger::MoveToArchive() noexcept -> std::vector<std::filesystem::path>
+{
+  const std::string stem = MakeArchiveStem(kDefLogPath, archive_stem_);
+  archive_stem_ = stem;
+  std::vector<std::filesystem::path> files;
+  const std::filesystem::path crash_path = kDefLogPath / kDefCrashFileName;
+  for(const std::filesystem::path &path : { std::filesystem::path(file_path_), kDefLogPath / kDefBinaryLogFileName, crash_path })
+  {
+    std::error_code error;
+    if(!std::filesystem::exists(path, error))
+      continue;
+    // Crash file has the same extension as log file, so it gets its own
+    std::filesystem::path archived = kDefLogPath / (stem + (path == crash_path ? kArchivedCrashExtension : path.extension().string()));
+    std::filesystem::rename(path, archived, error);
+    if(error)
+      std::cerr << "Couldn't archive log file " << path.generic_string() << ": " << error.message() << '\n';
+    else
+      files.push_back(std::move(archived));
+  }
+  return files;
+}
+
+void Logger::Archive(std::vector<std::filesystem::path> files) noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock(archive_mutex_);
+    archive_queue_.insert(archive_queue_.end(), std::make_move_iterator(files.begin()), std::make_move_iterator(files.end()));
+    archive_rotation_ = rotation_;
+  }
+  archive_condition_.notify_one();
+}
+
+void Logger::ArchiverLoop() noexcept
+{
+  #ifdef TRACY_ENABLE
+  tracy::SetThreadName("Log archiver");
+  #endif
+
+  std::vector<std::filesystem::path> files;
+  while(true)
+  {
+    LogRotationPolicy rotation;
+    {
+      std::unique_lock<std::mutex> lock(archive_mutex_);
+      archive_condition_.wait(lock, [this]{ return !archive_queue_.empty() || !archiving_; });
+      if(archive_queue_.empty())
+        return;
+      files.swap(archive_queue_);
+      rotation = archive_rotation_;
+    }
+
+    ZoneScopedNC("Log archive", 0xbaed00);
+    if(rotation.compress)
+      for(const std::filesystem::path &file : files)
+        if(!CompressLogFile(file))
+          std::cerr << "Couldn't compress log file " << file.generic_string() << '\n';
+    RemoveOldLogs(kDefLogPath, rotation.file_count);
+    files.clear();
+  }
+}
+
+void Logger::AppendBinary(const detail::LogRecord &record) noexcept
+{
+  const auto [site, inserted] = binary_sites_.try_emplace(record.site, static_cast<uint32_t>(binary_sites_.size()));
+  if(inserted)
+    AppendBinaryLogSite(binary_batch_, site->second, *record.site);
+  AppendBinaryLogLine(binary_batch_, site->second, reinterpret_cast<const std::byte*>(record.text), record.size);
+}
+
+void Logger::Remember(const detail::LogRecord &record) noexcept
+{
+  const std::size_t next = history_next_.load(std::memory_order_relaxed);
+  detail::CrashRecord &slot = history_[next % kCrashLineCount];
+  const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.record = record;
+  slot.record.heap = nullptr;
+  slot.record.size = std::min<uint32_t>(record.size, detail::LogRecord::kInlineSize);
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+  history_next_.store(next + 1, std::memory_order_release);
+}
+
+namespace
+{
+/// Copy record that writer could be changing, return false if it was changed while it was copied
+auto ReadCrashRecord(const detail::CrashRecord &slot, detail::LogRecord &record) noexcept -> bool
+{
+  const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+  if((sequence & 1) != 0)
+    return false;
+  std::memcpy(&record, &slot.record, sizeof(record));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+void WriteCrashRecord(const detail::LogRecord &record, Logger::CrashWriteFunction write, void *data) noexcept
+{
+  char text[detail::LogRecord::kInlineSize * 2];
+  std::size_t size;
+  if(record.site != nullptr)
+    size = FormatBinaryLog(text, sizeof(text) - 1, *record.site, reinterpret_cast<const std::byte*>(record.text), record.size);
+  else
   {
-	  Logger::Get().GetFile() << string_stream.str();
-	  Logger::Get().GetFile() .flush();
+    // Heap could be freed already, inline start of line is enough
+    size = std::min<std::size_t>(record.size, detail::LogRecord::kInlineSize);
+    std::memcpy(text, record.text, size);
   }
+  // Cut lines lost their end
+  if(size == 0 || text[size - 1] != '\n')
+    text[size++] = '\n';
+  write(text, size, data);
+}
+} // namespace
 
-	string_stream.str("");
+void Logger::WriteCrashLines(CrashWriteFunction write, void *data) noexcept
+{
+  const Logger *logger = instance_.load(std::memory_order_acquire);
+  if(logger == nullptr)
+    return;
 
-  if(fatal_)
+  // Writer keeps going while this runs, slots it changes meanwhile are skipped
+  detail::LogRecord record;
+  const std::size_t next = logger->history_next_.load(std::memory_order_acquire);
+  for(std::size_t i = next - std::min(next, kCrashLineCount); i < next; ++i)
+    if(ReadCrashRecord(logger->history_[i % kCrashLineCount], record))
+      WriteCrashRecord(record, write, data);
+
+  // Lines of the last moments are often still queued, they are only looked at, queue stays as it is
+  for(std::size_t offset = 0; logger->queue_->TryPeek(offset, record); ++offset)
+    WriteCrashRecord(record, write, data);
+}
+
+LogStream::~LogStream() noexcept
+{
+  ZoneScopedNC("Log whole", 0xbaed00);
+
+  string_stream << '\n';
+  Logger &logger = Logger::Get();
+  logger.Push(string_stream.str(), type_);
+  string_stream.str("");
+
+  if(type_ == LogType::Fatal)
+  {
+    // Everything logged before, by any thread, reaches outputs before abort
+    logger.Flush();
     std::abort();
+  }
 }
-} // game
\ No newline at end of file
+} // game
@@ -5,10 +5,20 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <cassert>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "Utils/Enum.hpp"
 
@@ -19,10 +29,21 @@
 *  Setters
 */
 
+/// Most verbose LogType that is compiled in translation unit, lines above it generate no code
+/// Define it before any include or for whole module in CMake, Fatal lines are always compiled
+#ifndef GAME_LOG_LEVEL
+  #define GAME_LOG_LEVEL Info
+#endif
+/// LogModule of lines in translation unit, its runtime type is set by Logger::SetModuleType
+/// Inline functions of headers log as module of translation unit that includes them
+#ifndef GAME_LOG_MODULE
+  #define GAME_LOG_MODULE General
+#endif
+
 #if defined(NDEBUG) && !defined(TRACY_ENABLE)
-  #define GAME_DLOG(type) if constexpr (false) game::LogStream(LogData{__LINE__, __FILE__, LogType::None})
-  #define GAME_VDLOG(level, type) if constexpr (false) game::LogStream(LogData{__LINE__, __FILE__, LogType::None})
-  #define GAME_ASSERT(condition) if constexpr (false) game::LogStream(LogData{__LINE__, __FILE__, LogType::None})
+  #define GAME_DLOG(type) if constexpr (false) game::LogStream(game::LogData{__LINE__, __FILE__, game::LogType::None})
+  #define GAME_VDLOG(level, type) if constexpr (false) game::LogStream(game::LogData{__LINE__, __FILE__, game::LogType::None})
+  #define GAME_ASSERT(condition) if constexpr (false) game::LogStream(game::LogData{__LINE__, __FILE__, game::LogType::None})
   #define GAME_ASSERT_STD(condition, message)
 #else
   /// Log message only in when NDEBUG is 0
@@ -34,8 +55,12 @@
   #define GAME_ASSERT_STD(condition, message) assert(((void)(message), (condition)))
 #endif
 
-#define GAME_LOG(type) game::LogStream(LogData{__LINE__, __FILE__, type})
-#define GAME_VLOG(level, type) if(level < game::Logger::Get().GetVerboseLevel()) GAME_LOG(type)
+/// True if line of type is compiled and its module logs it now, runtime check is one relaxed load
+/// Type has to be constant, so the first part is folded even without optimizations
+#define GAME_LOG_IS_ON(type) (game::detail::kLogTypeCompiled<type, game::LogType::GAME_LOG_LEVEL> && game::detail::IsLogTypeOn(type, game::LogModule::GAME_LOG_MODULE))
+/// Values of line that is off aren't evaluated
+#define GAME_LOG(type) !GAME_LOG_IS_ON(type) ? (void)0 : game::detail::Vodify() & game::LogStream(game::LogData{__LINE__, __FILE__, type})
+#define GAME_VLOG(level, type) !((level) < game::detail::log_verbose_level.load(std::memory_order_relaxed)) ? (void)0 : GAME_LOG(type)
 
 namespace game
 {
@@ -44,7 +69,70 @@ enum class LogType : uint8_t
   None, Fatal, Error, Warning, Info
 };
 
+/// Part of the game that line comes from, each one has its own runtime LogType
+enum class LogModule : uint8_t
+{
+  General, Game, Renderer, Events, Assets, Jobs, Platform, Count
+};
+
+template<typename T>
+class MPSCQueue;
+struct BinaryLogSite;
+
+namespace detail
+{
+struct LogRecord;
+struct CrashRecord;
+
+/// Most verbose LogType that module logs, every line is logged by default
+struct LogModuleType
+{
+  std::atomic<LogType> type{LogType::Info};
+};
+/// Globals are constant initialized, so macros don't go through Logger::Get()
+inline LogModuleType log_module_types[ToUnderlying(LogModule::Count)];
+inline std::atomic<int> log_verbose_level{0};
+
+template<LogType kType, LogType kLevel>
+inline constexpr bool kLogTypeCompiled = kType == LogType::Fatal || kType <= kLevel;
+[[nodiscard]] inline auto IsLogTypeOn(LogType type, LogModule module) noexcept -> bool
+{ return type == LogType::Fatal || type <= log_module_types[ToUnderlying(module)].type.load(std::memory_order_relaxed); }
+} // detail
+
+/// When lines written by logger thread reach the file
+struct LogFlushPolicy
+{
+  /// Lines of this type or more severe wake writer and are flushed right away
+  LogType flush_type = LogType::Error;
+  /// Written lines are flushed at least that often
+  std::chrono::milliseconds interval{200};
+  /// Written lines are flushed once there are that many bytes since last flush
+  std::size_t size = 64 * 1024;
+};
+
+/// When log files are moved to archive and how many archived logs are kept
+/// Archived files are named like kLogArchivePrefix describes
+struct LogRotationPolicy
+{
+  /// Files are rotated once that many bytes were written to them, 0 turns it off
+  std::size_t size = 16 << 20;
+  /// Files are rotated once they are open that long, 0 turns it off
+  std::chrono::minutes interval{0};
+  /// Archived logs that are kept, the oldest ones are removed
+  std::size_t file_count = 8;
+  /// Archived files are compressed with LZ4 on background thread
+  bool compress = true;
+};
 
+
+/// Asynchronous logger
+///
+/// LogStream formats line in buffer of its thread and pushes it into lock-free queue
+/// Writer thread drains the queue in batches, so one write call covers many lines and file is flushed only by LogFlushPolicy
+/// GAME_BLOG lines share the queue, writer formats them or writes them to .binlog file as they are
+/// With EnableArchive log of previous run and files that reach LogRotationPolicy limits are archived, file is preallocated as it grows
+/// When queue is full lines less severe than LogFlushPolicy::flush_type are dropped and counted, others wait for room
+/// Last kCrashLineCount lines are kept in memory, so crash handler can write them without allocating
 class Logger
 {
   friend class LogStream;
@@ -54,14 +142,43 @@ public:
 
   /// Global instance of logger
   [[nodiscard]] static inline auto Get() -> Logger& { static Logger instance; return instance; }
+  /// Archive log of previous run, rotate files by LogRotationPolicy and remove the oldest archives
+  /// Should be called before the first Get, processes that don't call it just overwrite log file
+  static inline void EnableArchive() noexcept { archive_enabled_ = true; }
 
   [[nodiscard]] constexpr inline auto GetStream() noexcept -> std::basic_ostream<StreamCharT>& { return stream_; }
   [[nodiscard]] constexpr inline auto GetFile() noexcept -> std::basic_ofstream<StreamCharT>& { return file_; }
   [[nodiscard]] constexpr inline auto IsOutputToFile() const noexcept -> bool { return output_to_file_; }
-  [[nodiscard]] constexpr inline auto GetVerboseLevel() const noexcept -> int { return verbose_level_; }
+  [[nodiscard]] static inline auto GetVerboseLevel() noexcept -> VerboseLevelT { return detail::log_verbose_level.load(std::memory_order_relaxed); }
+
+  /// Write every line that was logged before the call and flush outputs
+  /// Works without writer thread too, so it is safe on fatal path
+  void Flush() noexcept;
+  void SetFlushPolicy(const LogFlushPolicy &policy) noexcept;
+  void SetRotationPolicy(const LogRotationPolicy &policy) noexcept;
+  /// If true GAME_BLOG lines are written to .binlog file next to log file instead of being formatted
+  /// Default value is false
+  void SetBinaryOutput(bool binary_output) noexcept;
+  [[nodiscard]] inline auto IsBinaryOutput() noexcept -> bool { std::lock_guard<std::mutex> lock(write_mutex_); return binary_file_.is_open(); }
+  /// Queue line of GAME_BLOG call site, its arguments are already encoded
+  void PushBinary(const BinaryLogSite &site, const std::byte *args, std::size_t size) noexcept;
+  /// Called with parts of crash text, data is what was passed with it
+  using CrashWriteFunction = void(*)(const char *text, std::size_t size, void *data);
+  /// Write last lines of log, oldest first, each ends with '\n'
+  /// Lines still in queue are included too, line that writer takes right then can be missing or written twice
+  /// Only reads atomics and preallocated memory, so it is meant for signal handler that writes crash file
+  static void WriteCrashLines(CrashWriteFunction write, void *data) noexcept;
+  /// Lines dropped because queue was full
+  [[nodiscard]] inline auto GetDroppedCount() const noexcept -> uint64_t { return dropped_.load(std::memory_order_relaxed); }
 
   /// Sets verbose levels such that values with heigher level won't be printed
-  constexpr inline void SetVerboseLevel(VerboseLevelT verbose_level) noexcept { verbose_level_ = verbose_level; }
+  static inline void SetVerboseLevel(VerboseLevelT verbose_level) noexcept { detail::log_verbose_level.store(verbose_level, std::memory_order_relaxed); }
+  /// Lines of module that are less severe than type are skipped, Fatal ones are always logged
+  static inline void SetModuleType(LogModule module, LogType type) noexcept { detail::log_module_types[ToUnderlying(module)].type.store(type, std::memory_order_relaxed); }
+  [[nodiscard]] static inline auto GetModuleType(LogModule module) noexcept -> LogType { return detail::log_module_types[ToUnderlying(module)].type.load(std::memory_order_relaxed); }
+  /// Set module types from text like "Warning" for every module or "Renderer:Warning,Events:Info"
+  /// return false if text has unknown name, types before it are still set
+  static auto SetModuleTypes(std::string_view text) noexcept -> bool;
   /// If true output is also writen to file
   /// Default value is true 
   constexpr inline void SetOutputToFile(bool output_to_file) noexcept { output_to_file_ = output_to_file; }
@@ -70,25 +187,110 @@ public:
   /// std::cerr.rdbuf() to use std::cerr
   /// std::cout.rdbuf() to use std::cout
   /// etc.
-  inline void SetOutStreamBuffer(std::basic_ostream<StreamCharT> &stream) noexcept { stream_.rdbuf(stream.rdbuf()); }
+  /// Lines that are still queued are written to the old buffer
+  inline void SetOutStreamBuffer(std::basic_ostream<StreamCharT> &stream) noexcept { Flush(); std::lock_guard<std::mutex> lock(write_mutex_); stream_.rdbuf(stream.rdbuf()); }
 
   /// Get string with name of LogType
-  [[nodiscard]] static inline auto GetLogTypeName(LogType type) noexcept -> std::string { static const std::string kLogTypeNameMap[] = { "Fatal", "Error", "Warning", "Info" }; return kLogTypeNameMap[ToUnderlying(type)]; }
+  [[nodiscard]] static inline auto GetLogTypeName(LogType type) noexcept -> std::string { static const std::string kLogTypeNameMap[] = { "None", "Fatal", "Error", "Warning", "Info" }; return kLogTypeNameMap[ToUnderlying(type)]; }
+  [[nodiscard]] static inline auto GetLogModuleName(LogModule module) noexcept -> std::string { static const std::string kLogModuleNameMap[] = { "General", "Game", "Renderer", "Events", "Assets", "Jobs", "Platform" }; return kLogModuleNameMap[ToUnderlying(module)]; }
 
   static inline const std::filesystem::path kDefLogPath{"./logs/"};
   static inline const std::string kDefLogFileName{"last_log.txt"};
+  static inline const std::string kDefBinaryLogFileName{"last_log.binlog"};
+  /// Written by crash handler, archived with log of that run as stem and kArchivedCrashExtension
+  static inline const std::string kDefCrashFileName{"last_crash.txt"};
+  static inline const std::string kArchivedCrashExtension{".crash.txt"};
   static inline const std::basic_ostream<StreamCharT> kDefStream{std::cout.rdbuf()};
   static constexpr inline VerboseLevelT kDefVerboseLevel{0};
+  /// Lines that can wait for writer thread, power of 2
+  static constexpr inline std::size_t kQueueCapacity = 4096;
+  /// Encoded arguments of GAME_BLOG line fit into queue record
+  static constexpr inline std::size_t kMaxBinaryArgsSize = 232;
+  /// Disk space for log file is reserved in steps of that many bytes
+  static constexpr inline std::size_t kPreallocationStep = 1 << 20;
+  /// Lines kept for crash file, long lines are cut to kMaxBinaryArgsSize
+  static constexpr inline std::size_t kCrashLineCount = 256;
 
 private:
   Logger() noexcept;
   ~Logger() noexcept;
 
+  /// Queue formatted line, wait for room only if it is severe
+  void Push(std::string_view line, LogType type) noexcept;
+  /// Queue record, wait for room only if it is severe
+  void Push(const detail::LogRecord &record) noexcept;
+  void WriterLoop() noexcept;
+  /// Pop every queued line and write them in one batch, flush is forced or decided by policy
+  /// Should be called with write_mutex_ locked, it makes the caller the only consumer of queue
+  void Drain(bool flush) noexcept;
+  /// Append line of GAME_BLOG to binary_batch_, with its site if it wasn't written yet
+  void AppendBinary(const detail::LogRecord &record) noexcept;
+  void OpenBinaryFile() noexcept;
+  /// Archive files that are written now and start new ones, called with write_mutex_ locked
+  void Rotate() noexcept;
+  /// Rename closed log files to archive names
+  /// return new paths of files that existed
+  auto MoveToArchive() noexcept -> std::vector<std::filesystem::path>;
+  /// Queue files for archiver thread, which compresses them and removes the oldest logs
+  /// Only queue lock is taken, so it doesn't keep writer waiting for compression
+  void Archive(std::vector<std::filesystem::path> files) noexcept;
+  void ArchiverLoop() noexcept;
+  /// Copy popped record to crash history, only inline part of long line is kept
+  void Remember(const detail::LogRecord &record) noexcept;
+
+  /// Logger that crash handler reads, it is set only while logger exists
+  static inline std::atomic<Logger*> instance_{nullptr};
+  static inline bool archive_enabled_ = false;
+
   std::basic_ostream<StreamCharT> stream_{kDefStream.rdbuf()};
   bool output_to_file_ = true;
-  VerboseLevelT verbose_level_{0};
   std::string file_path_{kDefLogPath.generic_u8string() + kDefLogFileName};
 	std::basic_ofstream<StreamCharT> file_;
+
+  std::unique_ptr<MPSCQueue<detail::LogRecord>> queue_;
+  std::atomic<uint64_t> dropped_{0};
+  /// Set by severe lines, so writer flushes them right away
+  std::atomic<bool> urgent_{false};
+  /// Threads that log wake writer only while it sleeps
+  std::atomic<bool> writer_sleeping_{false};
+  // Guarded by write_mutex_, which also guards outputs and popping from queue
+  std::mutex write_mutex_;
+  LogFlushPolicy policy_;
+  /// Copy of policy_.flush_type for threads that log
+  std::atomic<LogType> flush_type_{LogType::Error};
+  std::string batch_;
+  std::size_t unflushed_size_ = 0;
+  std::chrono::steady_clock::time_point last_flush_;
+  uint64_t reported_dropped_ = 0;
+  std::ofstream binary_file_;
+  std::string binary_batch_;
+  /// Ids of sites that were written to binary_file_
+  std::unordered_map<const BinaryLogSite*, uint32_t> binary_sites_;
+  LogRotationPolicy rotation_;
+  /// Bytes written to files since they were opened
+  std::size_t written_size_ = 0;
+  std::size_t allocated_size_ = 0;
+  std::chrono::steady_clock::time_point opened_time_;
+  /// Name of the last archive without extension
+  std::string archive_stem_;
+
+  // Guarded by archive_mutex_
+  std::mutex archive_mutex_;
+  std::condition_variable archive_condition_;
+  std::vector<std::filesystem::path> archive_queue_;
+  /// Copy of rotation_ from the last time files were queued
+  LogRotationPolicy archive_rotation_;
+  bool archiving_ = false;
+  std::thread archiver_;
+  /// Ring of the last popped records, written with write_mutex_ locked and read by crash handler without it
+  std::unique_ptr<detail::CrashRecord[]> history_;
+  /// Records remembered since start, next one goes to history_next_ % kCrashLineCount
+  std::atomic<std::size_t> history_next_{0};
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_condition_;
+  bool running_ = false;
+  std::thread writer_;
 };
 
 
@@ -101,10 +303,12 @@ struct LogData
 
 
 /// Stream that uses global information from Logger to log
+/// Line is formatted in buffer of calling thread and handed to Logger when stream is destroyed
+/// Fatal line is written and flushed before program is aborted
 class LogStream
 {
 public:
-  LogStream(const LogData &log_data) noexcept : fatal_(log_data.type == LogType::Fatal) { GAME_ASSERT_STD(log_data.type != LogType::None, "LogType::None"); }
+  LogStream(const LogData &log_data) noexcept : type_(log_data.type) { GAME_ASSERT_STD(log_data.type != LogType::None, "LogType::None"); }
   ~LogStream() noexcept;
 	
   /// Input value to be printed
@@ -112,16 +316,15 @@ public:
 	inline LogStream &operator<<(T &&t) noexcept;
 
 private:
-  bool fatal_ = false;
-	
-  static inline std::basic_stringstream<Logger::StreamCharT> string_stream;
+  LogType type_;
+
+  /// Each thread formats into its own buffer, so lines of different threads don't mix
+  static inline thread_local std::basic_ostringstream<Logger::StreamCharT> string_stream;
 };
 
 template<typename T>
 inline LogStream &LogStream::operator<<(T &&t) noexcept
 {
-  ZoneScopedNC("Log vaue", 0xbaed00);
-  
   string_stream << std::forward<T>(t);
 	return *this;
 }
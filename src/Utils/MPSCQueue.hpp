@@ -0,0 +1,136 @@
+#ifndef GAME_MPSC_QUEUE_HPP
+#define GAME_MPSC_QUEUE_HPP
+
+#include "Setup.hpp"
+
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+/// Size used to separate data written by different threads
+constexpr inline std::size_t kCacheLineSize = 64;
+
+/// Bounded lock-free multi producer single consumer queue
+///
+/// Push can be called from any amount of threads at the same time
+/// Pop should be called only by one thread at a time (consumer)
+/// Each cell holds a sequence number that tells whose turn it is to use the cell,
+/// so producers only contend on a single counter and never wait for each other
+template<typename T>
+class MPSCQueue
+{
+  static_assert(std::is_trivially_copyable_v<T>, "Values are copied as raw bytes, so T should be trivially copyable");
+public:
+  /// capacity should be power of 2
+  explicit MPSCQueue(std::size_t capacity) noexcept;
+  MPSCQueue(const MPSCQueue &) = delete;
+  MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+  /// Thread safe for any amount of producers
+  /// return false if queue is full, value isn't pushed then
+  [[nodiscard]] inline auto TryPush(const T &value) noexcept -> bool;
+  /// Should be called only from consumer thread
+  /// return false if queue is empty or next value is still being written by producer
+  [[nodiscard]] inline auto TryPop(T &value) noexcept -> bool;
+  /// Copy value that is offset places after the next one to pop, without popping it
+  /// Can be called from any thread while consumer works, also from signal handler
+  /// return false if there is no value there or it was popped while it was copied
+  [[nodiscard]] inline auto TryPeek(std::size_t offset, T &value) const noexcept -> bool;
+
+  [[nodiscard]] constexpr inline auto GetCapacity() const noexcept -> std::size_t { return mask_ + 1; }
+  /// Values might be pushed or popped while it is being calculated, so use only for statistics
+  [[nodiscard]] inline auto GetSizeApprox() const noexcept -> std::size_t { return enqueue_pos_.load(std::memory_order_relaxed) - dequeue_pos_.load(std::memory_order_relaxed); }
+
+private:
+  struct Cell
+  {
+    std::atomic<std::size_t> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  const std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(kCacheLineSize) std::atomic<std::size_t> enqueue_pos_{0};
+  // Atomic only to allow approximate size reads and peeks from other threads, consumer is the only writer
+  alignas(kCacheLineSize) std::atomic<std::size_t> dequeue_pos_{0};
+};
+
+
+
+template<typename T>
+MPSCQueue<T>::MPSCQueue(std::size_t capacity) noexcept
+: mask_(capacity - 1)
+, cells_(new Cell[capacity])
+{
+  GAME_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0) << "MPSCQueue capacity should be power of 2, got: " << capacity;
+
+  for(std::size_t i = 0; i < capacity; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template<typename T>
+inline auto MPSCQueue<T>::TryPush(const T &value) noexcept -> bool
+{
+  Cell *cell;
+  std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  while(true)
+  {
+    cell = &cells_[pos & mask_];
+    const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+    if(difference == 0)
+    {
+      // Cell is free, try to claim it
+      if(enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if(difference < 0)
+      return false; // Consumer didn't free the cell yet so queue is full
+    else
+      pos = enqueue_pos_.load(std::memory_order_relaxed); // Other producer claimed the cell
+  }
+
+  std::memcpy(cell->storage, &value, sizeof(T));
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+inline auto MPSCQueue<T>::TryPop(T &value) noexcept -> bool
+{
+  const std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  Cell &cell = cells_[pos & mask_];
+  if(cell.sequence.load(std::memory_order_acquire) != pos + 1)
+    return false;
+
+  std::memcpy(&value, cell.storage, sizeof(T));
+  // Cell will be free for producer that is one lap ahead
+  cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+  dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+  return true;
+}
+
+template<typename T>
+inline auto MPSCQueue<T>::TryPeek(std::size_t offset, T &value) const noexcept -> bool
+{
+  const std::size_t pos = dequeue_pos_.load(std::memory_order_acquire) + offset;
+  const Cell &cell = cells_[pos & mask_];
+  if(offset > mask_ || cell.sequence.load(std::memory_order_acquire) != pos + 1)
+    return false;
+
+  // Sequence changes once cell is popped, so the same sequence after copy means copy is whole
+  std::memcpy(&value, cell.storage, sizeof(T));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return cell.sequence.load(std::memory_order_relaxed) == pos + 1;
+}
+} // game
+
+#endif // GAME_MPSC_QUEUE_HPP
@@ -0,0 +1,103 @@
+#include "SkylinePacker.hpp"
+
+#include "Setup.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "Utils/Logger.hpp"
+
+
+namespace game
+{
+SkylinePacker::SkylinePacker(int32_t width, int32_t height) noexcept
+: width_(width)
+, height_(height)
+{
+  GAME_ASSERT(width > 0 && height > 0) << "Packer size should be positive, got: " << width << 'x' << height;
+  Clear();
+}
+
+void SkylinePacker::Clear() noexcept
+{
+  skyline_.clear();
+  skyline_.push_back(Segment{0, 0, width_});
+  used_area_ = 0;
+}
+
+auto SkylinePacker::Fit(std::size_t index, int32_t width, int32_t height) const noexcept -> int32_t
+{
+  if(skyline_[index].x + width > width_)
+    return -1;
+
+  // Rectangle lies on the highest segment it spans
+  int32_t y = 0;
+  for(int32_t width_left = width; width_left > 0; width_left -= skyline_[index++].width)
+  {
+    y = std::max(y, skyline_[index].y);
+    if(y + height > height_)
+      return -1;
+  }
+  return y;
+}
+
+auto SkylinePacker::Pack(int32_t width, int32_t height, int32_t &x, int32_t &y) noexcept -> bool
+{
+  if(width <= 0 || height <= 0)
+    return false;
+
+  std::size_t best_index = skyline_.size();
+  int32_t best_bottom = std::numeric_limits<int32_t>::max();
+  int32_t best_width = std::numeric_limits<int32_t>::max();
+  int32_t best_y = 0;
+  for(std::size_t i = 0; i < skyline_.size(); ++i)
+  {
+    const int32_t fit_y = Fit(i, width, height);
+    if(fit_y < 0)
+      continue;
+    const int32_t bottom = fit_y + height;
+    if(bottom < best_bottom || (bottom == best_bottom && skyline_[i].width < best_width))
+    {
+      best_index = i;
+      best_bottom = bottom;
+      best_width = skyline_[i].width;
+      best_y = fit_y;
+    }
+  }
+  if(best_index == skyline_.size())
+    return false;
+
+  x = skyline_[best_index].x;
+  y = best_y;
+  used_area_ += static_cast<int64_t>(width) * height;
+
+  // New segment covers the rectangle, segments under it are cut or removed
+  skyline_.insert(skyline_.begin() + best_index, Segment{x, best_bottom, width});
+  for(std::size_t i = best_index + 1; i < skyline_.size();)
+  {
+    const int32_t covered = skyline_[best_index].x + skyline_[best_index].width - skyline_[i].x;
+    if(covered <= 0)
+      break;
+    if(covered < skyline_[i].width)
+    {
+      skyline_[i].x += covered;
+      skyline_[i].width -= covered;
+      break;
+    }
+    skyline_.erase(skyline_.begin() + i);
+  }
+
+  // Merge neighbours of the same height, so skyline stays short
+  for(std::size_t i = 0; i + 1 < skyline_.size();)
+  {
+    if(skyline_[i].y == skyline_[i + 1].y)
+    {
+      skyline_[i].width += skyline_[i + 1].width;
+      skyline_.erase(skyline_.begin() + i + 1);
+    }
+    else
+      ++i;
+  }
+  return true;
+}
+} // game
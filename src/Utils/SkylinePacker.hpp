@@ -0,0 +1,52 @@
+#ifndef GAME_SKYLINE_PACKER_HPP
+#define GAME_SKYLINE_PACKER_HPP
+
+#include "Setup.hpp"
+
+#include <vector>
+
+
+namespace game
+{
+/// Rectangle packer for texture atlases
+///
+/// Keeps only the top edge of packed area as a list of horizontal segments (skyline)
+/// Every rectangle is placed where its bottom ends up the highest, ties are broken by narrower segment
+/// Origin is top left corner, y grows down
+class SkylinePacker
+{
+public:
+  SkylinePacker(int32_t width, int32_t height) noexcept;
+
+  /// Find free place for rectangle
+  /// return false if it doesn't fit, x and y are unchanged then
+  [[nodiscard]] auto Pack(int32_t width, int32_t height, int32_t &x, int32_t &y) noexcept -> bool;
+  /// Forget all packed rectangles
+  void Clear() noexcept;
+
+  [[nodiscard]] constexpr inline auto GetWidth() const noexcept -> int32_t { return width_; }
+  [[nodiscard]] constexpr inline auto GetHeight() const noexcept -> int32_t { return height_; }
+  /// Sum of areas of packed rectangles
+  [[nodiscard]] constexpr inline auto GetUsedArea() const noexcept -> int64_t { return used_area_; }
+  /// Part of area that is used, in range [0, 1]
+  [[nodiscard]] constexpr inline auto GetOccupancy() const noexcept -> float { return static_cast<float>(used_area_) / (static_cast<float>(width_) * static_cast<float>(height_)); }
+
+private:
+  struct Segment
+  {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+  };
+
+  /// return y at which rectangle fits starting from segment, -1 if it doesn't fit
+  [[nodiscard]] auto Fit(std::size_t index, int32_t width, int32_t height) const noexcept -> int32_t;
+
+  int32_t width_;
+  int32_t height_;
+  int64_t used_area_ = 0;
+  std::vector<Segment> skyline_;
+};
+} // game
+
+#endif // GAME_SKYLINE_PACKER_HPP
@@ -0,0 +1,64 @@
+#include "Time.hpp"
+
+#include "Setup.hpp"
+
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+
+namespace game
+{
+namespace
+{
+/// Running estimate of how much longer than asked OS sleep takes
+/// Welford's algorithm, so estimate adapts to OS timer resolution
+struct SleepEstimate
+{
+  double mean = 1e-3;
+  double m2 = 0.0;
+  uint64_t count = 1;
+
+  [[nodiscard]] inline auto Get() const noexcept -> double { return mean + std::sqrt(m2 / static_cast<double>(count)); }
+  inline void Add(double sample) noexcept
+  {
+    // Keep estimate from going stale if timer resolution changes
+    if(count >= 1000)
+    {
+      count = 1;
+      m2 = 0.0;
+    }
+    ++count;
+    const double delta = sample - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta * (sample - mean);
+  }
+};
+
+SleepEstimate sleep_estimate;
+} // namespace
+
+void PreciseSleepUntil(ClockType::time_point time_point) noexcept
+{
+  ZoneScopedC(0x3e2ed1);
+
+  while(true)
+  {
+    const double remaining = SecondsType(time_point - ClockType::now()).count();
+    const double overshoot = sleep_estimate.Get();
+    if(remaining <= overshoot)
+      break;
+
+    // Everything except expected overshoot is slept at once
+    const double requested = remaining - overshoot;
+    const ClockType::time_point start = ClockType::now();
+    std::this_thread::sleep_for(SecondsType(requested));
+    sleep_estimate.Add(SecondsType(ClockType::now() - start).count() - requested);
+  }
+
+  // Spin only for the part shorter than overshoot, yield lets other threads of the same core run
+  while(ClockType::now() < time_point)
+    std::this_thread::yield();
+}
+} // game
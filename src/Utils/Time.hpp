@@ -0,0 +1,24 @@
+#ifndef GAME_TIME_HPP
+#define GAME_TIME_HPP
+
+#include "Setup.hpp"
+
+#include <chrono>
+
+
+namespace game
+{
+/// Clock used for all frame timing
+using ClockType = std::chrono::steady_clock;
+/// Seconds as floating point
+using SecondsType = std::chrono::duration<double>;
+
+/// Sleep until time point with sub millisecond precision
+///
+/// OS sleep can overshoot by several milliseconds, so thread sleeps for remaining time minus
+/// observed overshoot and spins for the rest
+/// Should be called from one thread at a time as overshoot estimation is shared
+void PreciseSleepUntil(ClockType::time_point time_point) noexcept;
+} // game
+
+#endif // GAME_TIME_HPP
@@ -0,0 +1,124 @@
+#ifndef GAME_WORK_STEALING_DEQUE_HPP
+#define GAME_WORK_STEALING_DEQUE_HPP
+
+#include "Setup.hpp"
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <type_traits>
+
+#include "Utils/Logger.hpp"
+#include "Utils/MPSCQueue.hpp"
+
+
+namespace game
+{
+/// Bounded lock-free Chase-Lev deque
+///
+/// Owner thread pushes and pops from the bottom (LIFO), any other thread steals from the top (FIFO)
+/// Owner and thieves contend only when a single value is left
+/// Memory orders are taken from "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013)
+template<typename T>
+class WorkStealingDeque
+{
+  static_assert(std::is_trivially_copyable_v<T>, "Values are stored in atomics, so T should be trivially copyable");
+public:
+  /// capacity should be power of 2
+  explicit WorkStealingDeque(std::size_t capacity) noexcept;
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+  /// Should be called only from owner thread
+  /// return false if deque is full, value isn't pushed then
+  [[nodiscard]] inline auto Push(T value) noexcept -> bool;
+  /// Take last pushed value, should be called only from owner thread
+  /// return false if deque is empty
+  [[nodiscard]] inline auto Pop(T &value) noexcept -> bool;
+  /// Take first pushed value, thread safe
+  /// return false if deque is empty or other thread took the value first
+  [[nodiscard]] inline auto Steal(T &value) noexcept -> bool;
+
+  [[nodiscard]] constexpr inline auto GetCapacity() const noexcept -> std::size_t { return static_cast<std::size_t>(mask_) + 1; }
+  /// Values might be pushed or taken while it is being calculated, so use only for statistics
+  [[nodiscard]] inline auto GetSizeApprox() const noexcept -> std::size_t
+  {
+    const int64_t size = bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+    return size > 0 ? static_cast<std::size_t>(size) : 0;
+  }
+
+private:
+  const int64_t mask_;
+  std::unique_ptr<std::atomic<T>[]> buffer_;
+  alignas(kCacheLineSize) std::atomic<int64_t> top_{0};
+  alignas(kCacheLineSize) std::atomic<int64_t> bottom_{0};
+};
+
+
+
+template<typename T>
+WorkStealingDeque<T>::WorkStealingDeque(std::size_t capacity) noexcept
+: mask_(static_cast<int64_t>(capacity) - 1)
+, buffer_(new std::atomic<T>[capacity])
+{
+  GAME_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0) << "WorkStealingDeque capacity should be power of 2, got: " << capacity;
+}
+
+template<typename T>
+inline auto WorkStealingDeque<T>::Push(T value) noexcept -> bool
+{
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  const int64_t top = top_.load(std::memory_order_acquire);
+  if(GAME_IS_UNLIKELY(bottom - top > mask_))
+    return false;
+
+  buffer_[bottom & mask_].store(value, std::memory_order_relaxed);
+  // Release store instead of release fence is free on x86 and is understood by thread sanitizer
+  bottom_.store(bottom + 1, std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+inline auto WorkStealingDeque<T>::Pop(T &value) noexcept -> bool
+{
+  // Reserve the last value before looking at top, so thieves see it as taken
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_relaxed);
+
+  if(top > bottom)
+  {
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  value = buffer_[bottom & mask_].load(std::memory_order_relaxed);
+  if(top != bottom)
+    return true;
+
+  // Last value, race with thieves for it
+  const bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  bottom_.store(bottom + 1, std::memory_order_relaxed);
+  return won;
+}
+
+template<typename T>
+inline auto WorkStealingDeque<T>::Steal(T &value) noexcept -> bool
+{
+  int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t bottom = bottom_.load(std::memory_order_acquire);
+  if(top >= bottom)
+    return false;
+
+  const T stolen = buffer_[top & mask_].load(std::memory_order_relaxed);
+  if(!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    return false;
+
+  value = stolen;
+  return true;
+}
+} // game
+
+#endif // GAME_WORK_STEALING_DEQUE_HPP
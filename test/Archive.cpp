@@ -0,0 +1,153 @@
+#include "Core/Archive.hpp"
+
+#include "TestSetup.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <random>
+
+#include "Core/Image.hpp"
+#include "Utils/Hash.hpp"
+
+namespace
+{
+const std::string kResPath = std::string(__FILE__).substr(0, std::string(__FILE__).find_last_of("/\\")) + "/../res/";
+const std::string kArchivePath = (std::filesystem::temp_directory_path() / "ArchiveTest.pak").string();
+
+std::vector<std::byte> MakeBytes(std::size_t size, std::size_t period)
+{
+    std::vector<std::byte> bytes(size);
+    for(std::size_t i = 0; i < size; ++i)
+        bytes[i] = static_cast<std::byte>(i % period);
+    return bytes;
+}
+
+std::vector<std::byte> MakeNoise(std::size_t size)
+{
+    std::mt19937 random(42);
+    std::vector<std::byte> bytes(size);
+    for(std::byte &byte : bytes)
+        byte = static_cast<std::byte>(random());
+    return bytes;
+}
+
+std::vector<std::byte> ReadFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return std::vector<std::byte>(reinterpret_cast<const std::byte*>(bytes.data()), reinterpret_cast<const std::byte*>(bytes.data()) + bytes.size());
+}
+} // namespace
+
+TEST(ArchiveTest, WritesAndFindsEntries)
+{
+    const std::vector<std::byte> small = MakeBytes(100, 251);
+    const std::vector<std::byte> repetitive = MakeBytes(100000, 16);
+    const std::vector<std::byte> noise = MakeNoise(5000);
+
+    ArchiveWriter writer;
+    ASSERT_TRUE(writer.Add("res/small.bin", small.data(), small.size(), false));
+    ASSERT_TRUE(writer.Add("res/repetitive.bin", repetitive.data(), repetitive.size(), true));
+    ASSERT_TRUE(writer.Add("res/noise.bin", noise.data(), noise.size(), true));
+    ASSERT_TRUE(writer.Add("res/empty.bin", nullptr, 0, false));
+    ASSERT_TRUE(writer.Write(kArchivePath));
+
+    Archive archive;
+    ASSERT_TRUE(archive.Open(kArchivePath));
+    EXPECT_EQ(archive.GetEntryCount(), 4u);
+    EXPECT_EQ(archive.Find("res/missing.bin"), nullptr);
+
+    // Uncompressed entry is handed out from mapping without copy
+    const Archive::Entry *entry = archive.Find("res/small.bin");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->flags & Archive::Entry::kCompressed, 0u);
+    EXPECT_EQ(entry->offset % Archive::kAlignment, 0u);
+    const ByteSpan stored = archive.GetStored(*entry);
+    EXPECT_EQ(std::vector<std::byte>(stored.data, stored.data + stored.size), small);
+
+    entry = archive.Find("res/repetitive.bin");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_NE(entry->flags & Archive::Entry::kCompressed, 0u);
+    EXPECT_LT(entry->stored_size, entry->size);
+    std::vector<std::byte> output;
+    EXPECT_TRUE(archive.Read(*entry, output));
+    EXPECT_EQ(output, repetitive);
+
+    // Compression that doesn't pay off isn't kept
+    entry = archive.Find("res/noise.bin");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->flags & Archive::Entry::kCompressed, 0u);
+    EXPECT_TRUE(archive.Read(*entry, output));
+    EXPECT_EQ(output, noise);
+
+    entry = archive.Find("res/empty.bin");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_TRUE(archive.Read(*entry, output));
+    EXPECT_TRUE(output.empty());
+
+    archive.Close();
+    std::remove(kArchivePath.c_str());
+}
+
+TEST(ArchiveTest, RejectsCollisionsAndInvalidFiles)
+{
+    const std::vector<std::byte> bytes = MakeBytes(10, 10);
+    ArchiveWriter writer;
+    ASSERT_TRUE(writer.Add("res/a.bin", bytes.data(), bytes.size(), false));
+    EXPECT_FALSE(writer.Add("res/a.bin", bytes.data(), bytes.size(), false));
+    EXPECT_EQ(writer.GetEntryCount(), 1u);
+
+    Archive archive;
+    EXPECT_FALSE(archive.Open(kArchivePath + ".missing"));
+    // Image file isn't an archive
+    EXPECT_FALSE(archive.Open(kResPath + "NoTexture64.png"));
+    EXPECT_FALSE(archive.IsOpen());
+
+    // Index pointing past the end of file
+    ASSERT_TRUE(writer.Write(kArchivePath));
+    {
+        std::fstream file(kArchivePath, std::ios::binary | std::ios::in | std::ios::out);
+        const uint64_t offset = uint64_t{1} << 40;
+        file.seekp(offsetof(Archive::Header, index_offset));
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+    EXPECT_FALSE(archive.Open(kArchivePath));
+    std::remove(kArchivePath.c_str());
+}
+
+TEST(ArchiveTest, DecodesImagesFromArchive)
+{
+    const std::vector<std::byte> png = ReadFile(kResPath + "NoTexture64.png");
+    ASSERT_FALSE(png.empty());
+
+    ArchiveWriter writer;
+    ASSERT_TRUE(writer.Add("packed/NoTexture64.png", png.data(), png.size(), true));
+    ASSERT_TRUE(writer.Write(kArchivePath));
+    Archive archive;
+    ASSERT_TRUE(archive.Open(kArchivePath));
+
+    Image packed;
+    ASSERT_TRUE(LoadImage(&archive, "packed/NoTexture64.png", packed));
+    Image loose;
+    ASSERT_TRUE(LoadImage(kResPath + "NoTexture64.png", loose));
+    EXPECT_EQ(packed.width, 64);
+    EXPECT_EQ(packed.pixels, loose.pixels);
+
+    // Path that isn't packed is read from disk
+    Image fallback;
+    EXPECT_TRUE(LoadImage(&archive, kResPath + "NoTexture64.png", fallback));
+    EXPECT_EQ(fallback.pixels, loose.pixels);
+
+    archive.Close();
+    std::remove(kArchivePath.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,190 @@
+#include "Core/AssetLoader.hpp"
+
+#include "TestSetup.hpp"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+
+#include "Utils/Hash.hpp"
+
+namespace
+{
+const std::string kResPath = std::string(__FILE__).substr(0, std::string(__FILE__).find_last_of("/\\")) + "/../res/";
+
+struct LoadLog
+{
+    std::vector<AssetLoadedEvent> events;
+};
+
+bool LogLoad(const Event &event, void *data)
+{
+    reinterpret_cast<LoadLog*>(data)->events.push_back(event.GetCustomData<AssetLoadedEvent>());
+    return true;
+}
+
+class AssetLoaderTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        textures.SetFallbackPath(kResPath + "NoTexture64.png");
+        loader.Init(textures, events, 2);
+        events.AddListener(cleaner, kAssetLoadedEventType, &log, LogLoad);
+    }
+
+    /// Update loader and dispatch events until nothing is pending
+    void Finish()
+    {
+        const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        do
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            loader.Update();
+            events.DispatchEnquedEvents();
+        } while(loader.GetPendingCount() != 0 && std::chrono::steady_clock::now() < timeout);
+    }
+
+    TextureCache textures;
+    EventHandler events;
+    EventCleaner cleaner{events};
+    AssetLoader loader;
+    LoadLog log;
+};
+} // namespace
+
+TEST_F(AssetLoaderTest, HandleIsPendingUntilUpdate)
+{
+    const TextureHandle handle = loader.LoadTexture(kResPath + "NoTexture64.png");
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(handle.GetState(), AssetState::Pending);
+    EXPECT_EQ(handle.GetRegion().texture, 0u);
+
+    Finish();
+    EXPECT_EQ(handle.GetState(), AssetState::Ready);
+    EXPECT_NE(handle.GetRegion().texture, 0u);
+    EXPECT_EQ(handle.GetRegion().width, 64);
+
+    ASSERT_EQ(log.events.size(), 1u);
+    EXPECT_EQ(log.events[0].path_hash, HashString(kResPath + "NoTexture64.png"));
+    EXPECT_EQ(log.events[0].state, AssetState::Ready);
+}
+
+TEST_F(AssetLoaderTest, SamePathSharesHandle)
+{
+    const TextureHandle first = loader.LoadTexture(kResPath + "NoTexture64.png");
+    const TextureHandle second = loader.LoadTexture(kResPath + "NoTexture64.png");
+    EXPECT_EQ(loader.GetPendingCount(), 1u);
+
+    Finish();
+    EXPECT_EQ(first.GetRegion().texture, second.GetRegion().texture);
+    EXPECT_EQ(log.events.size(), 1u);
+}
+
+TEST_F(AssetLoaderTest, MissingFileFails)
+{
+    const TextureHandle handle = loader.LoadTexture("does/not/exist.png");
+    Finish();
+    EXPECT_EQ(handle.GetState(), AssetState::Failed);
+    EXPECT_EQ(handle.GetRegion().texture, textures.GetFallback().texture);
+    ASSERT_EQ(log.events.size(), 1u);
+    EXPECT_EQ(log.events[0].state, AssetState::Failed);
+}
+
+TEST_F(AssetLoaderTest, CachedTextureIsReadyRightAway)
+{
+    const TextureRegion region = textures.Load(kResPath + "NoTexture64.png");
+    const TextureHandle handle = loader.LoadTexture(kResPath + "NoTexture64.png");
+    EXPECT_EQ(handle.GetState(), AssetState::Ready);
+    EXPECT_EQ(handle.GetRegion().texture, region.texture);
+
+    events.DispatchEnquedEvents();
+    EXPECT_EQ(log.events.size(), 1u);
+}
+
+TEST_F(AssetLoaderTest, UnreferencedTexturesAreEvicted)
+{
+    loader.Exit();
+    AssetLoader limited;
+    limited.Init(textures, events, 1, 0);
+    {
+        TextureHandle handle = limited.LoadTexture(kResPath + "NoTexture64.png");
+        while(limited.GetPendingCount() != 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            limited.Update();
+        }
+        // Handle keeps texture alive
+        limited.Update();
+        EXPECT_NE(textures.Find(kResPath + "NoTexture64.png"), nullptr);
+        EXPECT_GT(textures.GetMemoryUsage(), 0);
+
+        TextureHandle copy = handle;
+        handle = TextureHandle{};
+        limited.Update();
+        EXPECT_NE(textures.Find(kResPath + "NoTexture64.png"), nullptr);
+    }
+
+    limited.Update();
+    EXPECT_EQ(textures.Find(kResPath + "NoTexture64.png"), nullptr);
+    EXPECT_EQ(textures.GetMemoryUsage(), 0);
+}
+
+TEST_F(AssetLoaderTest, DroppedPendingHandleIsDiscarded)
+{
+    {
+        __attribute__((unused)) const TextureHandle handle = loader.LoadTexture(kResPath + "NoTexture64.png");
+    }
+    Finish();
+    EXPECT_TRUE(log.events.empty());
+    EXPECT_EQ(textures.Find(kResPath + "NoTexture64.png"), nullptr);
+}
+
+TEST_F(AssetLoaderTest, ReloadKeepsHandleValid)
+{
+    // Copy of the image is reloaded from disk, so it can be broken without touching res
+    const std::string path = (std::filesystem::temp_directory_path() / "AssetLoaderReload.png").string();
+    std::filesystem::copy_file(kResPath + "NoTexture64.png", path, std::filesystem::copy_options::overwrite_existing);
+
+    const TextureHandle handle = loader.LoadTexture(path);
+    Finish();
+    ASSERT_EQ(handle.GetState(), AssetState::Ready);
+    const TextureRegion region = handle.GetRegion();
+    std::vector<TextureUpload> uploads;
+    textures.TakeUploads(uploads);
+    uploads.clear();
+
+    loader.Reload(path);
+    // Reload doesn't count as pending, so wait for its event
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while(log.events.size() < 2 && std::chrono::steady_clock::now() < timeout)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        loader.Update();
+        events.DispatchEnquedEvents();
+    }
+    ASSERT_EQ(log.events.size(), 2u);
+    EXPECT_EQ(handle.GetState(), AssetState::Ready);
+    EXPECT_EQ(handle.GetRegion().texture, region.texture);
+    EXPECT_FLOAT_EQ(handle.GetRegion().uv[0], region.uv[0]);
+    textures.TakeUploads(uploads);
+    EXPECT_EQ(uploads.size(), 1u);
+
+    // Broken file keeps the old texture
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not an image";
+    loader.Reload(path);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    loader.Update();
+    EXPECT_EQ(handle.GetState(), AssetState::Ready);
+    EXPECT_EQ(handle.GetRegion().texture, region.texture);
+    std::filesystem::remove(path);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
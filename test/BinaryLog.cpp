@@ -0,0 +1,136 @@
+#include "Utils/BinaryLog.hpp"
+
+#include "TestSetup.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+enum class Color : uint8_t
+{
+    Red, Green
+};
+
+template<typename... Args>
+std::string Format(const BinaryLogSite &site, const Args &...args)
+{
+    std::byte data[Logger::kMaxBinaryArgsSize];
+    std::string text;
+    FormatBinaryLog(text, site, data, detail::EncodeBinaryArgs(data, args...));
+    return text;
+}
+
+template<typename... Args>
+constexpr BinaryLogSite MakeSite(const char *format)
+{
+    return BinaryLogSite{ __LINE__, __FILE__, LogType::Info, format, detail::kBinaryArgTypes<Args...>, sizeof...(Args) };
+}
+
+/// Captures stream output of logger, binary output is turned off when done
+class BinaryLogTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::Get().SetOutStreamBuffer(output);
+    }
+
+    void TearDown() override
+    {
+        Logger::Get().SetBinaryOutput(false);
+        Logger::Get().SetOutStreamBuffer(std::cout);
+    }
+
+    std::ostringstream output;
+};
+} // namespace
+
+TEST(BinaryLogFormatTest, ArgumentsLookLikeStreamOutput)
+{
+    const std::string text = "text";
+    int value = 0;
+    std::ostringstream expected;
+    expected << "b " << true << " c " << 'x' << " i " << -42 << " l " << -5000000000ll << " u " << 7u << " ul " << 18000000000000000000ull
+        << " f " << 1.5f << " d " << 0.1 << " s " << "literal" << ' ' << text << ' ' << std::string_view("view") << " e " << 1 << " p " << static_cast<void*>(&value);
+
+    EXPECT_EQ(Format(MakeSite<bool, char, int, long long, unsigned, unsigned long long, float, double, const char*, std::string, std::string_view, Color, void*>(
+        "b {} c {} i {} l {} u {} ul {} f {} d {} s {} {} {} e {} p {}"),
+        true, 'x', -42, -5000000000ll, 7u, 18000000000000000000ull, 1.5f, 0.1, "literal", text, std::string_view("view"), Color::Green, static_cast<void*>(&value)),
+        expected.str());
+}
+
+TEST(BinaryLogFormatTest, LongArgumentsAreCut)
+{
+    const std::string long_text(2 * Logger::kMaxBinaryArgsSize, 'x');
+    const std::string text = Format(MakeSite<std::string, int>("{} {}"), long_text, 5);
+
+    // String fills what is left, so number after it doesn't fit
+    EXPECT_EQ(text, std::string(Logger::kMaxBinaryArgsSize - sizeof(uint16_t), 'x') + " {?}");
+    EXPECT_EQ(detail::CountBinaryLogArgs("{} {{}} {"), 2u);
+}
+
+TEST_F(BinaryLogTest, LinesAreFormattedInOrderWithTextLines)
+{
+    GAME_LOG(LogType::Info) << "text " << 1;
+    GAME_BLOG(LogType::Info, "binary {} {}", 2, "two");
+    GAME_BLOG(LogType::Warning, "no arguments");
+    GAME_LOG(LogType::Info) << "text " << 3;
+    Logger::Get().Flush();
+
+    EXPECT_EQ(output.str(), "text 1\nbinary 2 two\nno arguments\ntext 3\n");
+}
+
+TEST_F(BinaryLogTest, BinaryOutputIsDecodedToSameText)
+{
+    Logger::Get().SetBinaryOutput(true);
+    if(!Logger::Get().IsBinaryOutput())
+        GTEST_SKIP() << "Binary log file couldn't be created";
+
+    for(int i = 0; i < 3; ++i)
+        GAME_BLOG(LogType::Info, "line {} of {}, half is {}", i, 3, 0.5f * static_cast<float>(i));
+    GAME_BLOG(LogType::Error, "error {}", std::string("message"));
+    GAME_LOG(LogType::Info) << "text line";
+    Logger::Get().Flush();
+
+    // Only text lines are formatted
+    EXPECT_EQ(output.str(), "text line\n");
+
+    std::ifstream file(Logger::kDefLogPath / Logger::kDefBinaryLogFileName, std::ios::binary);
+    std::string text;
+    EXPECT_TRUE(DecodeBinaryLog(file, text));
+    EXPECT_EQ(text, "line 0 of 3, half is 0\nline 1 of 3, half is 0.5\nline 2 of 3, half is 1\nerror message\n");
+}
+
+TEST(BinaryLogDecodeTest, CutFileKeepsLinesBeforeCut)
+{
+    constexpr BinaryLogSite kSite = MakeSite<int>("value {}");
+    std::byte data[Logger::kMaxBinaryArgsSize];
+    std::string file(kBinaryLogMagic);
+    AppendBinaryLogSite(file, 0, kSite);
+    AppendBinaryLogLine(file, 0, data, detail::EncodeBinaryArgs(data, 1));
+    AppendBinaryLogLine(file, 0, data, detail::EncodeBinaryArgs(data, 2));
+
+    std::string text;
+    std::istringstream whole(file);
+    EXPECT_TRUE(DecodeBinaryLog(whole, text));
+    EXPECT_EQ(text, "value 1\nvalue 2\n");
+
+    text.clear();
+    std::istringstream cut(file.substr(0, file.size() - 1));
+    EXPECT_FALSE(DecodeBinaryLog(cut, text));
+    EXPECT_EQ(text, "value 1\n");
+
+    text.clear();
+    std::istringstream other("not a binary log");
+    EXPECT_FALSE(DecodeBinaryLog(other, text));
+    EXPECT_TRUE(text.empty());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
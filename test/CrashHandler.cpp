@@ -0,0 +1,109 @@
+#include "Platform/CrashHandler.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/BinaryLog.hpp"
+
+#include "TestSetup.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+const std::string kCrashPath = (Logger::kDefLogPath / Logger::kDefCrashFileName).string();
+
+std::string ReadCrashFile()
+{
+    std::ifstream file(kCrashPath);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+void AppendText(const char *text, std::size_t size, void *data)
+{
+    static_cast<std::string*>(data)->append(text, size);
+}
+
+/// Some lines are written and some still queued when null pointer is written
+void LogAndCrash(const std::string &long_text)
+{
+    if(!InstallCrashHandler(kCrashPath))
+        std::exit(1);
+    GAME_LOG(LogType::Info) << "flushed line";
+    Logger::Get().Flush();
+    GAME_BLOG(LogType::Info, "binary line {} {}", 7, 1.5f);
+    GAME_LOG(LogType::Info) << "long " << long_text;
+    SetCrashFrame(42);
+    volatile int *null = nullptr;
+    *null = 1;
+}
+} // namespace
+
+TEST(CrashHandlerTest, SegfaultWritesFrameBacktraceAndLastLines)
+{
+    std::remove(kCrashPath.c_str());
+    const std::string long_text(400, 'x');
+
+    // Child starts from scratch, so writer thread of this process can't hold logger locks in it
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_DEATH(LogAndCrash(long_text), "Crash file was written to");
+
+    const std::string content = ReadCrashFile();
+    EXPECT_NE(content.find("Crash: SIGSEGV at 0x0\n"), std::string::npos) << content;
+    EXPECT_NE(content.find("Frame: 42\n"), std::string::npos);
+    const std::size_t backtrace = content.find("\nBacktrace:\n");
+    const std::size_t lines = content.find("\nLast log lines:\n");
+    ASSERT_NE(backtrace, std::string::npos);
+    ASSERT_NE(lines, std::string::npos);
+    EXPECT_GT(lines, backtrace + 12);
+
+    // Lines that weren't written yet are there too, long one is cut
+    const std::size_t flushed = content.find("flushed line\n", lines);
+    ASSERT_NE(flushed, std::string::npos);
+    const std::size_t binary = content.find("binary line 7 1.5\n", flushed);
+    ASSERT_NE(binary, std::string::npos);
+    const std::size_t long_line = content.find("long xxx", binary);
+    ASSERT_NE(long_line, std::string::npos);
+    EXPECT_EQ(content.find('\n', long_line), long_line + Logger::kMaxBinaryArgsSize);
+}
+
+TEST(CrashHandlerTest, AbortIsReported)
+{
+    std::remove(kCrashPath.c_str());
+
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_DEATH(
+    {
+        if(!InstallCrashHandler(kCrashPath))
+            std::exit(1);
+        SetCrashFrame(7);
+        std::abort();
+    }, "Crash file was written to");
+
+    const std::string content = ReadCrashFile();
+    EXPECT_EQ(content.rfind("Crash: SIGABRT\nFrame: 7\n", 0), 0u) << content;
+}
+
+TEST(CrashHandlerTest, OnlyLastLinesAreKept)
+{
+    constexpr std::size_t kExtraLines = 10;
+    for(std::size_t i = 0; i < Logger::kCrashLineCount + kExtraLines; ++i)
+        GAME_LOG(LogType::Info) << "kept " << i;
+    Logger::Get().Flush();
+
+    std::string lines;
+    Logger::WriteCrashLines(AppendText, &lines);
+    std::string expected;
+    for(std::size_t i = kExtraLines; i < Logger::kCrashLineCount + kExtraLines; ++i)
+        expected += "kept " + std::to_string(i) + '\n';
+    EXPECT_EQ(lines, expected);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,328 @@
+#include "Core/EventHandler.hpp"
+
+#include "TestSetup.hpp"
+
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+namespace
+{
+std::atomic<std::size_t> allocation_count{0};
+} // namespace
+
+// Counts all allocations made by the test binary
+void *operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if(void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, __attribute__((unused)) std::size_t size) noexcept { std::free(ptr); }
+
+namespace
+{
+struct CallLog
+{
+    std::vector<int> calls;
+};
+
+template<int Id, bool Propagate = true>
+bool LogCall(__attribute__((unused)) const Event &event, void *data)
+{
+    reinterpret_cast<CallLog*>(data)->calls.push_back(Id);
+    return Propagate;
+}
+
+template<int Id>
+bool LogBatch(const Event *events, std::size_t count, void *data)
+{
+    CallLog &log = *reinterpret_cast<CallLog*>(data);
+    log.calls.push_back(Id);
+    for(std::size_t i = 0; i < count; ++i)
+        log.calls.push_back(events[i].GetKeycode());
+    return true;
+}
+
+Event MakeKeyDown(uint16_t keycode)
+{
+    return Event{Event::KeyDown{Event::Keyboard{keycode, 0, 0}}};
+}
+
+struct Payload
+{
+    int value;
+    float weight;
+};
+
+bool SumPayload(const Event &event, void *data)
+{
+    *reinterpret_cast<int*>(data) += event.GetCustomData<Payload>().value;
+    return true;
+}
+
+constexpr EventType kCustomType = static_cast<EventType>(Event::kCustomTypeBitMask | 7);
+} // namespace
+
+TEST(EventHandlerTest, ListenersCalledInOrder)
+{
+    EventHandler events;
+    EventCleaner cleaner(events);
+    CallLog log;
+
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<1>);
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<2>);
+    events.AddListener(cleaner, EventType::KeyDown, &log, LogCall<3>);
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<4>);
+
+    events.DispatchEvent(Event{Event::Quit{}});
+    EXPECT_EQ(log.calls, (std::vector<int>{1, 2, 4}));
+}
+
+TEST(EventHandlerTest, ReturnFalseStopsPropagation)
+{
+    EventHandler events;
+    EventCleaner cleaner(events);
+    CallLog log;
+
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<1>);
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<2, false>);
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<3>);
+
+    events.DispatchEvent(Event{Event::Quit{}});
+    EXPECT_EQ(log.calls, (std::vector<int>{1, 2}));
+}
+
+TEST(EventHandlerTest, CustomTypes)
+{
+    EventHandler events;
+    EventCleaner cleaner(events);
+    CallLog log;
+
+    events.AddListener(cleaner, kCustomType, &log, LogCall<1>);
+    events.AddListener(cleaner, static_cast<EventType>(Event::kCustomTypeBitMask | 8), &log, LogCall<2>);
+
+    events.DispatchEvent(Event{Event::Custom{kCustomType}});
+    EXPECT_EQ(log.calls, (std::vector<int>{1}));
+}
+
+TEST(EventHandlerTest, RemoveKeepsOrderAndHandles)
+{
+    EventHandler events;
+    EventCleaner cleaner(events);
+    CallLog log;
+
+    EventHandler::ListenerHandle first = events.AddListener(cleaner, EventType::Quit, &log, LogCall<1>);
+    EventHandler::ListenerHandle second = events.AddListener(cleaner, EventType::Quit, &log, LogCall<2>);
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<3>);
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<4>);
+
+    events.RemoveListener(cleaner, second);
+    events.RemoveListener(cleaner, first); // triggers compaction
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<5>);
+
+    events.DispatchEvent(Event{Event::Quit{}});
+    EXPECT_EQ(log.calls, (std::vector<int>{3, 4, 5}));
+}
+
+TEST(EventHandlerTest, CleanerRemovesListeners)
+{
+    EventHandler events;
+    CallLog log;
+    {
+        EventCleaner cleaner(events);
+        events.AddListener(cleaner, EventType::Quit, &log, LogCall<1>);
+        events.AddListener(cleaner, kCustomType, &log, LogCall<2>);
+    }
+
+    events.DispatchEvent(Event{Event::Quit{}});
+    events.DispatchEvent(Event{Event::Custom{kCustomType}});
+    EXPECT_TRUE(log.calls.empty());
+}
+
+TEST(EventHandlerTest, StaleHandleAfterClearIsIgnored)
+{
+    EventHandler events;
+    EventCleaner cleaner(events);
+    CallLog log;
+
+    {
+        EventCleaner old_cleaner(events);
+        EventHandler::ListenerHandle stale = events.AddListener(old_cleaner, EventType::Quit, &log, LogCall<1>);
+        events.ClearListeners(EventType::Quit);
+        // Reuses the slot of removed listener
+        EventHandler::ListenerHandle fresh = events.AddListener(cleaner, EventType::Quit, &log, LogCall<2>);
+        EXPECT_NE(stale, fresh);
+    } // old_cleaner removes stale handle here
+
+    events.DispatchEvent(Event{Event::Quit{}});
+    EXPECT_EQ(log.calls, (std::vector<int>{2}));
+}
+
+TEST(EventHandlerTest, BatchGroupsByType)
+{
+    EventHandler events;
+    EventCleaner cleaner(events);
+    CallLog log;
+
+    events.AddListener(cleaner, EventType::Quit, &log, LogCall<-1>);
+    events.AddBatchListener(cleaner, EventType::KeyDown, &log, LogBatch<-2>);
+    events.AddListener(cleaner, EventType::KeyDown, &log, LogCall<-3>);
+
+    std::vector<Event> batch{MakeKeyDown(1), Event{Event::Quit{}}, MakeKeyDown(2), MakeKeyDown(3)};
+    events.DispatchBatch(batch);
+    // KeyDown goes before Quit, batch listener gets all events in order, then each event is dispatched
+    EXPECT_EQ(log.calls, (std::vector<int>{-2, 1, 2, 3, -3, -3, -3, -1}));
+}
+
+TEST(EventHandlerTest, BatchCoalescing)
+{
+    EventHandler events;
+    EventCleaner cleaner(events);
+    CallLog log;
+
+    events.AddBatchListener(cleaner, EventType::KeyDown, &log, LogBatch<-1>);
+    events.SetCoalescePolicy(EventType::KeyDown, EventHandler::CoalescePolicy::KeepLast);
+    std::vector<Event> batch{MakeKeyDown(1), MakeKeyDown(2), MakeKeyDown(3)};
+    events.DispatchBatch(batch);
+    EXPECT_EQ(log.calls, (std::vector<int>{-1, 3}));
+
+    log.calls.clear();
+    events.SetCoalescePolicy(EventType::KeyDown, EventHandler::CoalescePolicy::KeepFirst);
+    batch = {MakeKeyDown(1), MakeKeyDown(2), MakeKeyDown(3)};
+    events.DispatchBatch(batch);
+    EXPECT_EQ(log.calls, (std::vector<int>{-1, 1}));
+}
+
+TEST(EventHandlerTest, BatchedEnquedEvents)
+{
+    EventHandler events;
+    EventCleaner cleaner(events);
+    CallLog log;
+
+    EventHandler::ListenerHandle handle = events.AddBatchListener(cleaner, EventType::KeyDown, &log, LogBatch<-1>);
+    events.SetBatched(true);
+    events.EnqueEvent(MakeKeyDown(1));
+    events.EnqueEvent(MakeKeyDown(2));
+    events.DispatchEnquedEvents();
+    EXPECT_EQ(log.calls, (std::vector<int>{-1, 1, 2}));
+
+    log.calls.clear();
+    events.RemoveListener(cleaner, handle);
+    events.EnqueEvent(MakeKeyDown(1));
+    events.DispatchEnquedEvents();
+    EXPECT_TRUE(log.calls.empty());
+}
+
+TEST(EventHandlerTest, EventNames)
+{
+    EXPECT_EQ(Event{Event::Quit{}}.GetName(), "Quit");
+    EXPECT_EQ(MakeKeyDown(1).GetName(), "Key Down");
+    EXPECT_EQ(Event{Event::Custom{kCustomType}}.GetName(), kUnnamedEventTypeName);
+
+    RegisterEventTypeName(kCustomType, "Test Custom");
+    EXPECT_EQ(Event{Event::Custom{kCustomType}}.GetName(), "Test Custom");
+}
+
+TEST(EventHandlerTest, DispatchDoesNotAllocate)
+{
+    EventHandler events;
+    EventCleaner cleaner(events);
+    CallLog log;
+    log.calls.reserve(4096);
+
+    const EventType unnamed_type = static_cast<EventType>(Event::kCustomTypeBitMask | 9);
+    RegisterEventTypeName(kCustomType, "Test Custom");
+    events.AddListener(cleaner, EventType::KeyDown, &log, LogCall<1>);
+    events.AddListener(cleaner, kCustomType, &log, LogCall<2>);
+    events.AddListener(cleaner, unnamed_type, &log, LogCall<3>);
+
+    const std::size_t allocations_before = allocation_count.load();
+    for(int i = 0; i < 1000; ++i)
+    {
+        events.DispatchEvent(MakeKeyDown(1));
+        events.DispatchEvent(Event{Event::Custom{kCustomType}});
+        events.DispatchEvent(Event{Event::Custom{unnamed_type}});
+        events.DispatchEvent(Event{Event::Quit{}});
+        EXPECT_FALSE(Event{Event::Custom{kCustomType}}.GetName().empty());
+    }
+    EXPECT_EQ(allocation_count.load(), allocations_before);
+    EXPECT_EQ(log.calls.size(), 3000u);
+}
+
+TEST(EventHandlerTest, CustomEventPayload)
+{
+    EventHandler events(EventHandler::kDefQueueCapacity, 256);
+    EventCleaner cleaner(events);
+    int sum = 0;
+    events.AddListener(cleaner, kCustomType, &sum, SumPayload);
+
+    EXPECT_TRUE(events.EnqueCustomEvent<Payload>(kCustomType, Payload{1, 0.5f}));
+    EXPECT_TRUE(events.EnqueCustomEvent<Payload>(kCustomType, Payload{2, 0.5f}));
+    events.DispatchEnquedEvents();
+    EXPECT_EQ(sum, 3);
+
+    // Arenas are reused, so small arena should be enough for any amount of frames
+    for(int frame = 0; frame < 100; ++frame)
+    {
+        for(int i = 0; i < 4; ++i)
+            EXPECT_TRUE(events.EnqueCustomEvent<Payload>(kCustomType, Payload{1, 0.0f}));
+        events.DispatchEnquedEvents();
+    }
+    EXPECT_EQ(sum, 403);
+    EXPECT_EQ(events.GetOverflowCount(), 0u);
+}
+
+TEST(EventHandlerTest, CustomEventPayloadOverflow)
+{
+    EventHandler events(EventHandler::kDefQueueCapacity, 64);
+    EventCleaner cleaner(events);
+    int sum = 0;
+    events.AddListener(cleaner, kCustomType, &sum, SumPayload);
+
+    int pushed = 0;
+    for(int i = 0; i < 16; ++i)
+        pushed += events.EnqueCustomEvent<Payload>(kCustomType, Payload{1, 0.0f});
+    events.DispatchEnquedEvents();
+
+    EXPECT_LT(pushed, 16);
+    EXPECT_EQ(sum, pushed);
+    EXPECT_EQ(events.GetOverflowCount(), static_cast<uint64_t>(16 - pushed));
+}
+
+TEST(EventHandlerTest, CustomEventPayloadFromThreads)
+{
+    constexpr int kProducerCount = 4;
+    constexpr int kEventsPerProducer = 20000;
+    EventHandler events(1024, 4096);
+    EventCleaner cleaner(events);
+    int sum = 0;
+    events.AddListener(cleaner, kCustomType, &sum, SumPayload);
+
+    std::vector<std::thread> producers;
+    for(int i = 0; i < kProducerCount; ++i)
+        producers.emplace_back([&events]
+        {
+            for(int j = 0; j < kEventsPerProducer; ++j)
+                while(!events.EnqueCustomEvent<Payload>(kCustomType, Payload{1, 0.0f}))
+                    std::this_thread::yield();
+        });
+
+    // Every payload should be valid when dispatched even though arenas are switched and reset under producers
+    while(sum < kProducerCount * kEventsPerProducer)
+        events.DispatchEnquedEvents();
+
+    for(std::thread &producer : producers)
+        producer.join();
+    EXPECT_EQ(sum, kProducerCount * kEventsPerProducer);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
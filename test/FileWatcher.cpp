@@ -0,0 +1,126 @@
+#include "Platform/FileWatcher.hpp"
+
+#include "TestSetup.hpp"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+
+#include "Platform/Platform.hpp"
+
+namespace
+{
+namespace fs = std::filesystem;
+
+struct ChangeLog
+{
+    std::vector<std::string> paths;
+};
+
+bool LogChange(const Event &event, void *data)
+{
+    reinterpret_cast<ChangeLog*>(data)->paths.emplace_back(event.GetCustomData<AssetChangedEvent>().GetPath());
+    return true;
+}
+
+class FileWatcherTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+        events.AddListener(cleaner, kAssetChangedEventType, &log, LogChange);
+    }
+
+    void TearDown() override
+    {
+        watcher.Exit();
+        fs::remove_all(directory);
+    }
+
+    /// Dispatch events until count changes were reported or time is out
+    void Wait(std::size_t count, std::chrono::milliseconds time = std::chrono::milliseconds(2000))
+    {
+        const auto timeout = std::chrono::steady_clock::now() + time;
+        while(log.paths.size() < count && std::chrono::steady_clock::now() < timeout)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            events.DispatchEnquedEvents();
+        }
+    }
+
+    const std::string directory = (fs::temp_directory_path() / "FileWatcherTest").generic_string();
+    EventHandler events;
+    EventCleaner cleaner{events};
+    FileWatcher watcher;
+    ChangeLog log;
+};
+} // namespace
+
+#ifdef GAME_OS_LINUX
+TEST_F(FileWatcherTest, BurstOfWritesIsReportedOnce)
+{
+    ASSERT_TRUE(watcher.Init(events, {directory}, std::chrono::milliseconds(50)));
+    for(int i = 0; i < 10; ++i)
+        std::ofstream(directory + "/image.png") << i;
+
+    Wait(1);
+    // Nothing else should come after debounce time
+    Wait(2, std::chrono::milliseconds(200));
+    ASSERT_EQ(log.paths.size(), 1u);
+    EXPECT_EQ(log.paths[0], directory + "/image.png");
+}
+
+TEST_F(FileWatcherTest, WatchesNewDirectories)
+{
+    fs::create_directories(directory + "/old");
+    ASSERT_TRUE(watcher.Init(events, {directory}, std::chrono::milliseconds(10)));
+    fs::create_directories(directory + "/new");
+    // Watch is added by watcher thread, give it time
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::ofstream(directory + "/old/a.png") << "a";
+    std::ofstream(directory + "/new/b.png") << "b";
+    Wait(2);
+    ASSERT_EQ(log.paths.size(), 2u);
+    EXPECT_NE(std::find(log.paths.begin(), log.paths.end(), directory + "/old/a.png"), log.paths.end());
+    EXPECT_NE(std::find(log.paths.begin(), log.paths.end(), directory + "/new/b.png"), log.paths.end());
+}
+
+TEST_F(FileWatcherTest, DirectoryIsNormalized)
+{
+    // Path hash has to match the one asset was loaded with
+    ASSERT_TRUE(watcher.Init(events, {directory + "/./sub/../"}, std::chrono::milliseconds(10)));
+    std::ofstream(directory + "/image.png") << "a";
+    Wait(1);
+    ASSERT_EQ(log.paths.size(), 1u);
+    EXPECT_EQ(log.paths[0], directory + "/image.png");
+}
+
+TEST_F(FileWatcherTest, RenamedFileIsReported)
+{
+    ASSERT_TRUE(watcher.Init(events, {directory}, std::chrono::milliseconds(10)));
+    // Editors often save to temporary file and move it over the original
+    std::ofstream(fs::temp_directory_path() / "FileWatcherTest.tmp") << "a";
+    fs::rename(fs::temp_directory_path() / "FileWatcherTest.tmp", directory + "/moved.png");
+    Wait(1);
+    ASSERT_EQ(log.paths.size(), 1u);
+    EXPECT_EQ(log.paths[0], directory + "/moved.png");
+}
+#endif
+
+TEST_F(FileWatcherTest, MissingDirectoryFails)
+{
+    EXPECT_FALSE(watcher.Init(events, {directory + "/missing"}));
+    EXPECT_FALSE(watcher.IsRunning());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
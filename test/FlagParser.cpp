@@ -41,6 +41,19 @@ TEST(FlagParser, FlagParserErrorCheck)
     EXPECT_EQ(flags.Get("-4"), "");
 }
 
+TEST(FlagParser, FlagParserPositiveNumber)
+{
+    const char *argv[] = { "-rate=30", "-half=0.5", "-zero=0", "-text=abc", "-empty" };
+    Flags flags(5, argv);
+
+    EXPECT_DOUBLE_EQ(flags.GetPositiveNumber("-rate", 1.0), 30.0);
+    EXPECT_DOUBLE_EQ(flags.GetPositiveNumber("-half", 1.0), 0.5);
+    EXPECT_DOUBLE_EQ(flags.GetPositiveNumber("-zero", 1.0), 1.0);
+    EXPECT_DOUBLE_EQ(flags.GetPositiveNumber("-text", 1.0), 1.0);
+    EXPECT_DOUBLE_EQ(flags.GetPositiveNumber("-empty", 1.0), 1.0);
+    EXPECT_DOUBLE_EQ(flags.GetPositiveNumber("-missing", 2.0), 2.0);
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
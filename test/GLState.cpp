@@ -0,0 +1,127 @@
+#include "Platform/OpenGL/GLState.hpp"
+#include "RenderHarness.hpp"
+
+#include "TestSetup.hpp"
+
+namespace
+{
+class GLStateTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string error = gl.Init("GLStateTest", 16, 16);
+        if(!error.empty())
+            GTEST_SKIP() << error;
+
+        state.Init(false);
+    }
+
+    void TearDown() override
+    {
+        gl.Exit();
+    }
+
+    GLint GetInteger(GLenum name)
+    {
+        GLint value = 0;
+        glGetIntegerv(name, &value);
+        return value;
+    }
+
+    TestGLContext gl;
+    GLState state;
+};
+} // namespace
+
+TEST_F(GLStateTest, RedundantCallsAreSkipped)
+{
+    GLuint textures[2];
+    glGenTextures(2, textures);
+
+    state.BindTexture(0, textures[0]);
+    state.BindTexture(0, textures[0]);
+    state.SetBlend(true);
+    state.SetBlend(true);
+    state.SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state.SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state.SetViewport(0, 0, 16, 16);
+    state.SetViewport(0, 0, 16, 16);
+    // Active unit is selected once for both binds
+    EXPECT_EQ(state.GetIssuedCount(), 5u);
+    EXPECT_EQ(state.GetSkippedCount(), 4u);
+
+    state.BindTexture(0, textures[1]);
+    EXPECT_EQ(GetInteger(GL_TEXTURE_BINDING_2D), static_cast<GLint>(textures[1]));
+    EXPECT_EQ(glIsEnabled(GL_BLEND), GL_TRUE);
+    EXPECT_EQ(GetInteger(GL_BLEND_SRC_RGB), GL_SRC_ALPHA);
+
+    state.EndFrame();
+    EXPECT_EQ(state.GetIssuedCount(), 0u);
+    EXPECT_EQ(state.GetSkippedCount(), 0u);
+    glDeleteTextures(2, textures);
+}
+
+TEST_F(GLStateTest, TexturesAreTrackedPerUnit)
+{
+    GLuint textures[2];
+    glGenTextures(2, textures);
+
+    state.BindTexture(0, textures[0]);
+    state.BindTexture(1, textures[1]);
+    state.BindTexture(0, textures[0]);
+    EXPECT_EQ(state.GetSkippedCount(), 1u);
+    // Unit 1 is still active, since bind to unit 0 was skipped
+    EXPECT_EQ(GetInteger(GL_ACTIVE_TEXTURE), GL_TEXTURE1);
+    EXPECT_EQ(GetInteger(GL_TEXTURE_BINDING_2D), static_cast<GLint>(textures[1]));
+    glDeleteTextures(2, textures);
+}
+
+TEST_F(GLStateTest, DeletedTextureIsUnbound)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    state.BindTexture(0, texture);
+    state.DeleteTexture(texture);
+
+    // Driver reset binding to 0 too, so binding 0 is skipped
+    state.BindTexture(0, 0);
+    EXPECT_EQ(state.GetSkippedCount(), 1u);
+    EXPECT_EQ(GetInteger(GL_TEXTURE_BINDING_2D), 0);
+
+    // Name can be reused by driver, new texture should be bound again
+    GLuint reused;
+    glGenTextures(1, &reused);
+    state.BindTexture(0, reused);
+    EXPECT_EQ(GetInteger(GL_TEXTURE_BINDING_2D), static_cast<GLint>(reused));
+    glDeleteTextures(1, &reused);
+}
+
+TEST_F(GLStateTest, InvalidateReissuesCalls)
+{
+    state.SetDepthTest(true);
+    glDisable(GL_DEPTH_TEST);
+    state.SetDepthTest(true);
+    EXPECT_EQ(glIsEnabled(GL_DEPTH_TEST), GL_FALSE);
+
+    state.Invalidate();
+    state.SetDepthTest(true);
+    EXPECT_EQ(glIsEnabled(GL_DEPTH_TEST), GL_TRUE);
+}
+
+TEST_F(GLStateTest, DebugCallbackReplacesPolling)
+{
+    if(!state.Init(true))
+        GTEST_SKIP() << "No KHR_debug";
+    EXPECT_FALSE(game::detail::gl_poll_errors);
+    EXPECT_EQ(glIsEnabled(GL_DEBUG_OUTPUT), GL_TRUE);
+    // Invalid enum is reported by callback instead of crashing or stopping test
+    glEnable(GL_TEXTURE_2D + 0x1000);
+    game::detail::gl_poll_errors = true;
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,63 @@
+#include "Core/GameLoop.hpp"
+#include "Utils/Time.hpp"
+
+#include "TestSetup.hpp"
+
+#include <chrono>
+
+TEST(GameLoopTest, StepsAndAlpha)
+{
+    FixedTimestep timestep(10.0);
+    EXPECT_DOUBLE_EQ(timestep.GetStep(), 0.1);
+
+    EXPECT_EQ(timestep.Advance(0.05), 0u);
+    EXPECT_NEAR(timestep.GetAlpha(), 0.5, 1e-9);
+
+    EXPECT_EQ(timestep.Advance(0.1), 1u);
+    EXPECT_NEAR(timestep.GetAlpha(), 0.5, 1e-9);
+
+    EXPECT_EQ(timestep.Advance(0.17), 2u);
+    EXPECT_NEAR(timestep.GetAlpha(), 0.2, 1e-9);
+    EXPECT_EQ(timestep.GetTick(), 3u);
+    EXPECT_NEAR(timestep.GetTime(), 0.3, 1e-9);
+}
+
+TEST(GameLoopTest, AlphaStaysInRange)
+{
+    FixedTimestep timestep(60.0);
+    for(int i = 0; i < 10000; ++i)
+    {
+        timestep.Advance(1.0 / 144.0);
+        ASSERT_GE(timestep.GetAlpha(), 0.0);
+        ASSERT_LT(timestep.GetAlpha(), 1.0);
+    }
+    // No time is lost to rounding
+    EXPECT_NEAR(timestep.GetTime() + timestep.GetAlpha() * timestep.GetStep(), 10000.0 / 144.0, 1e-6);
+}
+
+TEST(GameLoopTest, LongFrameIsClamped)
+{
+    FixedTimestep timestep(100.0, 0.25);
+    EXPECT_EQ(timestep.Advance(5.0), 25u);
+    EXPECT_NEAR(timestep.GetDroppedTime(), 4.75, 1e-9);
+    EXPECT_EQ(timestep.Advance(-1.0), 0u);
+}
+
+TEST(GameLoopTest, PreciseSleep)
+{
+    for(int i = 0; i < 5; ++i)
+    {
+        const ClockType::time_point start = ClockType::now();
+        const ClockType::time_point target = start + std::chrono::milliseconds(5);
+        PreciseSleepUntil(target);
+        const ClockType::time_point end = ClockType::now();
+        EXPECT_GE(end, target);
+        EXPECT_LT(end - target, std::chrono::milliseconds(4));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,151 @@
+#include "Platform/OpenGL/GpuProfiler.hpp"
+#include "RenderHarness.hpp"
+
+#include "TestSetup.hpp"
+
+#include <string_view>
+#include <vector>
+
+namespace
+{
+/// Mesa llvmpipe has timer queries, so results are real there
+class GpuProfilerTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string error = gl.Init("GpuProfilerTest", 16, 16);
+        if(!error.empty())
+            GTEST_SKIP() << error;
+
+        ASSERT_TRUE(profiler.Init() || !GLAD_GL_ARB_timer_query);
+    }
+
+    void TearDown() override
+    {
+        if(gl.IsReady())
+            profiler.Exit();
+        gl.Exit();
+    }
+
+    /// Frame with two clears, frame pass contains the other ones
+    void RenderFrame()
+    {
+        profiler.BeginFrame();
+        {
+            GAME_GPU_ZONE(profiler, "Frame");
+            for(int i = 0; i < 2; ++i)
+            {
+                GAME_GPU_ZONE(profiler, "Clear");
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+        }
+        profiler.EndFrame();
+    }
+
+    /// Stats of pass, nullptr if it has none
+    const GpuPassStats *Find(const std::vector<GpuPassStats> &stats, std::string_view name)
+    {
+        for(const GpuPassStats &pass : stats)
+            if(name == pass.name)
+                return &pass;
+        return nullptr;
+    }
+
+    TestGLContext gl;
+    GpuProfiler profiler;
+};
+} // namespace
+
+TEST_F(GpuProfilerTest, ResultsArriveWithoutWaiting)
+{
+    if(!profiler.IsSupported())
+        GTEST_SKIP() << "No timer queries";
+
+    // Nothing is read before next frame begins, so there are no stats right after first one
+    RenderFrame();
+    std::vector<GpuPassStats> stats;
+    profiler.GetStats(stats);
+    EXPECT_TRUE(stats.empty());
+
+    glFinish();
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        RenderFrame();
+        glFinish();
+    }
+    profiler.BeginFrame();
+    profiler.GetStats(stats);
+    ASSERT_EQ(stats.size(), 2u);
+    const GpuPassStats *frame = Find(stats, "Frame");
+    const GpuPassStats *clear = Find(stats, "Clear");
+    ASSERT_NE(frame, nullptr);
+    ASSERT_NE(clear, nullptr);
+    EXPECT_EQ(frame->sample_count, 4u);
+    EXPECT_EQ(clear->sample_count, 4u);
+    EXPECT_LE(frame->min_ms, frame->average_ms);
+    EXPECT_LE(frame->average_ms, frame->max_ms);
+    EXPECT_GE(frame->min_ms, 0.0);
+    EXPECT_EQ(profiler.GetDroppedFrameCount(), 0u);
+}
+
+TEST_F(GpuProfilerTest, HistoryIsRolling)
+{
+    if(!profiler.IsSupported())
+        GTEST_SKIP() << "No timer queries";
+
+    for(std::size_t i = 0; i < GpuProfiler::kHistorySize + 10; ++i)
+    {
+        RenderFrame();
+        glFinish();
+    }
+    profiler.BeginFrame();
+    std::vector<GpuPassStats> stats;
+    profiler.GetStats(stats);
+    const GpuPassStats *frame = Find(stats, "Frame");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->sample_count, GpuProfiler::kHistorySize);
+}
+
+TEST_F(GpuProfilerTest, FramesArentKeptForever)
+{
+    if(!profiler.IsSupported())
+        GTEST_SKIP() << "No timer queries";
+
+    // Whether GPU keeps up or not, old frames are read or dropped, never waited for
+    for(std::size_t i = 0; i < GpuProfiler::kFrameCount * 4; ++i)
+        RenderFrame();
+    glFinish();
+    profiler.BeginFrame();
+    std::vector<GpuPassStats> stats;
+    profiler.GetStats(stats);
+    const GpuPassStats *frame = Find(stats, "Frame");
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->sample_count + profiler.GetDroppedFrameCount(), GpuProfiler::kFrameCount * 4);
+}
+
+TEST_F(GpuProfilerTest, WithoutTimerQueriesNothingIsMeasured)
+{
+    profiler.Exit();
+    const int timer_query = GLAD_GL_ARB_timer_query;
+    GLAD_GL_ARB_timer_query = 0;
+    EXPECT_FALSE(profiler.Init());
+    GLAD_GL_ARB_timer_query = timer_query;
+
+    EXPECT_EQ(profiler.BeginPass("Frame"), GpuProfiler::kNoScope);
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        RenderFrame();
+        glFinish();
+    }
+    std::vector<GpuPassStats> stats;
+    profiler.GetStats(stats);
+    EXPECT_TRUE(stats.empty());
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
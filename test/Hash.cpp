@@ -0,0 +1,24 @@
+#include "Utils/Hash.hpp"
+
+#include "TestSetup.hpp"
+
+#include <string>
+
+// Keys made at compile time are compared with keys of paths that are known only at runtime
+static_assert(HASH_STRING("") == HashString(""));
+static_assert(HASH_STRING("ab") == HashString("ab"));
+static_assert(HASH_STRING("res/textures/NoTexture64.png") == HashString("res/textures/NoTexture64.png"));
+
+TEST(HashTest, CompileTimeAndRuntimeHashesAreEqual)
+{
+    const std::string runtime = std::string("res/") + "shaders/" + "Sprite.glsl";
+    EXPECT_EQ(HASH_STRING("res/shaders/Sprite.glsl"), HashString(runtime));
+    EXPECT_EQ(HASH_STRING("ab"), 0x617cb792u);
+    EXPECT_NE(HashString("ab"), HashString(std::string_view("ab", 3)));
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
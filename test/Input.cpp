@@ -0,0 +1,225 @@
+#include "Core/EventHandler.hpp"
+
+#include "TestSetup.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <vector>
+#include <cstring>
+
+namespace
+{
+bool LogEvent(const Event &event, void *data)
+{
+    reinterpret_cast<std::vector<Event>*>(data)->push_back(event);
+    return true;
+}
+
+void PushKey(Uint32 type, SDL_Scancode scancode, bool repeat = false)
+{
+    SDL_Event event{};
+    event.type = type;
+    event.key.keysym.scancode = scancode;
+    event.key.keysym.sym = SDLK_a;
+    event.key.repeat = repeat;
+    SDL_PushEvent(&event);
+}
+
+void PushMouseButton(Uint32 type, Uint8 button, Sint32 x, Sint32 y)
+{
+    SDL_Event event{};
+    event.type = type;
+    event.button.button = button;
+    event.button.clicks = 1;
+    event.button.x = x;
+    event.button.y = y;
+    SDL_PushEvent(&event);
+}
+
+void PushMotion(Sint32 x, Sint32 y, Sint32 xrel, Sint32 yrel)
+{
+    SDL_Event event{};
+    event.type = SDL_MOUSEMOTION;
+    event.motion.x = x;
+    event.motion.y = y;
+    event.motion.xrel = xrel;
+    event.motion.yrel = yrel;
+    SDL_PushEvent(&event);
+}
+
+void PushWindowEvent(Uint8 window_event, Sint32 data1 = 0, Sint32 data2 = 0)
+{
+    SDL_Event event{};
+    event.type = SDL_WINDOWEVENT;
+    event.window.event = window_event;
+    event.window.data1 = data1;
+    event.window.data2 = data2;
+    SDL_PushEvent(&event);
+}
+
+class InputTest : public testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        // Lets events be pushed without real display
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+        ASSERT_EQ(SDL_Init(SDL_INIT_EVENTS), 0) << SDL_GetError();
+    }
+    static void TearDownTestSuite() { SDL_Quit(); }
+
+    void SetUp() override
+    {
+        // Drop anything SDL generated by itself
+        events.DispatchSDLEvents();
+        events.DispatchSDLEvents();
+    }
+
+    EventHandler events;
+};
+} // namespace
+
+TEST_F(InputTest, KeyEdges)
+{
+    PushKey(SDL_KEYDOWN, SDL_SCANCODE_W);
+    events.DispatchSDLEvents();
+    EXPECT_TRUE(events.GetInput().IsKeyDown(SDL_SCANCODE_W));
+    EXPECT_TRUE(events.GetInput().WasKeyPressed(SDL_SCANCODE_W));
+    EXPECT_FALSE(events.GetInput().WasKeyReleased(SDL_SCANCODE_W));
+    EXPECT_FALSE(events.GetInput().IsKeyDown(SDL_SCANCODE_S));
+
+    // Edges last only for one frame, repeats don't produce new ones
+    PushKey(SDL_KEYDOWN, SDL_SCANCODE_W, true);
+    events.DispatchSDLEvents();
+    EXPECT_TRUE(events.GetInput().IsKeyDown(SDL_SCANCODE_W));
+    EXPECT_FALSE(events.GetInput().WasKeyPressed(SDL_SCANCODE_W));
+
+    PushKey(SDL_KEYUP, SDL_SCANCODE_W);
+    events.DispatchSDLEvents();
+    EXPECT_FALSE(events.GetInput().IsKeyDown(SDL_SCANCODE_W));
+    EXPECT_TRUE(events.GetInput().WasKeyReleased(SDL_SCANCODE_W));
+}
+
+TEST_F(InputTest, TapWithinOneFrame)
+{
+    PushKey(SDL_KEYDOWN, SDL_SCANCODE_SPACE);
+    PushKey(SDL_KEYUP, SDL_SCANCODE_SPACE);
+    events.DispatchSDLEvents();
+    EXPECT_FALSE(events.GetInput().IsKeyDown(SDL_SCANCODE_SPACE));
+    EXPECT_TRUE(events.GetInput().WasKeyPressed(SDL_SCANCODE_SPACE));
+    EXPECT_TRUE(events.GetInput().WasKeyReleased(SDL_SCANCODE_SPACE));
+}
+
+TEST_F(InputTest, KeyEventsAreTranslated)
+{
+    EventCleaner cleaner(events);
+    std::vector<Event> log;
+    events.AddListener(cleaner, EventType::KeyDown, &log, LogEvent);
+    events.AddListener(cleaner, EventType::KeyPressed, &log, LogEvent);
+    events.AddListener(cleaner, EventType::KeyUp, &log, LogEvent);
+
+    PushKey(SDL_KEYDOWN, SDL_SCANCODE_A);
+    PushKey(SDL_KEYDOWN, SDL_SCANCODE_A, true);
+    PushKey(SDL_KEYUP, SDL_SCANCODE_A);
+    events.DispatchSDLEvents();
+
+    ASSERT_EQ(log.size(), 3u);
+    EXPECT_EQ(log[0].GetType(), EventType::KeyDown);
+    EXPECT_EQ(log[1].GetType(), EventType::KeyPressed);
+    EXPECT_EQ(log[2].GetType(), EventType::KeyUp);
+    EXPECT_EQ(log[2].GetScancode(), SDL_SCANCODE_A);
+    EXPECT_EQ(log[2].GetKeycode(), SDLK_a);
+}
+
+TEST_F(InputTest, Mouse)
+{
+    EventCleaner cleaner(events);
+    std::vector<Event> log;
+    events.AddListener(cleaner, EventType::MouseMove, &log, LogEvent);
+    events.AddListener(cleaner, EventType::MouseButtonDown, &log, LogEvent);
+    events.AddListener(cleaner, EventType::MouseWheel, &log, LogEvent);
+
+    PushMotion(10, 20, 3, -4);
+    PushMotion(12, 25, 2, 5);
+    PushMouseButton(SDL_MOUSEBUTTONDOWN, SDL_BUTTON_LEFT, 12, 25);
+    SDL_Event wheel{};
+    wheel.type = SDL_MOUSEWHEEL;
+    wheel.wheel.y = 2;
+    wheel.wheel.direction = SDL_MOUSEWHEEL_NORMAL;
+    SDL_PushEvent(&wheel);
+    events.DispatchSDLEvents();
+
+    const InputState &input = events.GetInput();
+    EXPECT_EQ(input.GetMouseX(), 12);
+    EXPECT_EQ(input.GetMouseY(), 25);
+    EXPECT_EQ(input.GetMouseDeltaX(), 5);
+    EXPECT_EQ(input.GetMouseDeltaY(), 1);
+    EXPECT_FLOAT_EQ(input.GetWheelY(), 2.0f);
+    EXPECT_TRUE(input.IsMouseButtonDown(SDL_BUTTON_LEFT));
+    EXPECT_TRUE(input.WasMouseButtonPressed(SDL_BUTTON_LEFT));
+    EXPECT_FALSE(input.IsMouseButtonDown(SDL_BUTTON_RIGHT));
+
+    ASSERT_EQ(log.size(), 4u);
+    EXPECT_EQ(log[0].GetMouseDeltaY(), -4);
+    EXPECT_EQ(log[2].GetMouseButton(), SDL_BUTTON_LEFT);
+    EXPECT_FLOAT_EQ(log[3].GetWheelY(), 2.0f);
+
+    // Deltas are per frame
+    PushMouseButton(SDL_MOUSEBUTTONUP, SDL_BUTTON_LEFT, 12, 25);
+    events.DispatchSDLEvents();
+    EXPECT_EQ(input.GetMouseDeltaX(), 0);
+    EXPECT_FLOAT_EQ(input.GetWheelY(), 0.0f);
+    EXPECT_FALSE(input.IsMouseButtonDown(SDL_BUTTON_LEFT));
+    EXPECT_TRUE(input.WasMouseButtonReleased(SDL_BUTTON_LEFT));
+}
+
+TEST_F(InputTest, WindowEvents)
+{
+    EventCleaner cleaner(events);
+    std::vector<Event> log;
+    events.AddListener(cleaner, EventType::WindowResize, &log, LogEvent);
+    events.AddListener(cleaner, EventType::WindowFocusLost, &log, LogEvent);
+
+    PushKey(SDL_KEYDOWN, SDL_SCANCODE_D);
+    PushWindowEvent(SDL_WINDOWEVENT_SIZE_CHANGED, 800, 600);
+    PushWindowEvent(SDL_WINDOWEVENT_FOCUS_LOST);
+    events.DispatchSDLEvents();
+
+    ASSERT_EQ(log.size(), 2u);
+    EXPECT_EQ(log[0].GetWindowWidth(), 800);
+    EXPECT_EQ(log[0].GetWindowHeight(), 600);
+    EXPECT_EQ(log[1].GetType(), EventType::WindowFocusLost);
+
+    // Held keys are released when window loses focus
+    EXPECT_FALSE(events.GetInput().HasFocus());
+    EXPECT_FALSE(events.GetInput().IsKeyDown(SDL_SCANCODE_D));
+    EXPECT_TRUE(events.GetInput().WasKeyReleased(SDL_SCANCODE_D));
+
+    PushWindowEvent(SDL_WINDOWEVENT_FOCUS_GAINED);
+    events.DispatchSDLEvents();
+    EXPECT_TRUE(events.GetInput().HasFocus());
+}
+
+TEST_F(InputTest, TextInputIsDecoded)
+{
+    EventCleaner cleaner(events);
+    std::vector<Event> log;
+    events.AddListener(cleaner, EventType::TextInput, &log, LogEvent);
+
+    SDL_Event text{};
+    text.type = SDL_TEXTINPUT;
+    std::strcpy(text.text.text, "a\xc3\xa9\xe2\x82\xac");
+    SDL_PushEvent(&text);
+    events.DispatchSDLEvents();
+
+    ASSERT_EQ(log.size(), 3u);
+    EXPECT_EQ(log[0].GetCodepoint(), 0x61u);
+    EXPECT_EQ(log[1].GetCodepoint(), 0xe9u);
+    EXPECT_EQ(log[2].GetCodepoint(), 0x20acu);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,268 @@
+#include "Core/JobSystem.hpp"
+#include "Utils/WorkStealingDeque.hpp"
+
+#include "TestSetup.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <vector>
+#include <numeric>
+
+namespace
+{
+struct ChainData
+{
+    std::atomic<int> *step;
+    int expected;
+    bool *ordered;
+};
+
+void ChainStep(void *data)
+{
+    ChainData &chain = *reinterpret_cast<ChainData*>(data);
+    if(chain.step->fetch_add(1) != chain.expected)
+        *chain.ordered = false;
+}
+
+struct SpawnData
+{
+    JobSystem *jobs;
+    std::atomic<int> *sum;
+    int depth;
+};
+
+/// Takes long enough for the other threads to take jobs that depend on it
+void Slow(void *data)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    reinterpret_cast<std::atomic<int>*>(data)->fetch_add(1);
+}
+
+/// Long enough that spinning workers would burn several times its length of CPU time
+void LongSleep(void *data)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    reinterpret_cast<std::atomic<int>*>(data)->fetch_add(1);
+}
+
+void Count(void *data)
+{
+    reinterpret_cast<std::atomic<int>*>(data)->fetch_add(1);
+}
+
+void Spawn(void *data)
+{
+    SpawnData &spawn = *reinterpret_cast<SpawnData*>(data);
+    spawn.sum->fetch_add(1, std::memory_order_relaxed);
+    if(spawn.depth == 0)
+        return;
+
+    // Jobs can create and wait for other jobs
+    SpawnData children[2] = { { spawn.jobs, spawn.sum, spawn.depth - 1 }, { spawn.jobs, spawn.sum, spawn.depth - 1 } };
+    JobCounter counter;
+    spawn.jobs->Run(Spawn, &children[0], &counter);
+    spawn.jobs->Run(Spawn, &children[1], &counter);
+    spawn.jobs->Wait(counter);
+}
+} // namespace
+
+TEST(JobSystemTest, DequeOwnerIsLifoThiefIsFifo)
+{
+    WorkStealingDeque<int> deque(4);
+    int value = 0;
+
+    EXPECT_FALSE(deque.Pop(value));
+    EXPECT_FALSE(deque.Steal(value));
+    for(int i = 0; i < 4; ++i)
+        EXPECT_TRUE(deque.Push(i));
+    EXPECT_FALSE(deque.Push(4));
+
+    EXPECT_TRUE(deque.Pop(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_TRUE(deque.Steal(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(deque.Pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_TRUE(deque.Pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_FALSE(deque.Pop(value));
+}
+
+TEST(JobSystemTest, DequeStealStress)
+{
+    constexpr int kValueCount = 200000;
+    constexpr int kThiefCount = 4;
+    WorkStealingDeque<int> deque(256);
+    std::vector<std::atomic<int>> taken(kValueCount);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves;
+    for(int i = 0; i < kThiefCount; ++i)
+        thieves.emplace_back([&]
+        {
+            int value;
+            while(!done.load())
+                if(deque.Steal(value))
+                    taken[value].fetch_add(1);
+        });
+
+    int value;
+    for(int i = 0; i < kValueCount; ++i)
+    {
+        while(!deque.Push(i))
+            if(deque.Pop(value))
+                taken[value].fetch_add(1);
+        if(i % 3 == 0 && deque.Pop(value))
+            taken[value].fetch_add(1);
+    }
+    while(deque.Pop(value))
+        taken[value].fetch_add(1);
+    done.store(true);
+    for(std::thread &thief : thieves)
+        thief.join();
+
+    // Every value is taken exactly once
+    for(int i = 0; i < kValueCount; ++i)
+        ASSERT_EQ(taken[i].load(), 1) << "value " << i;
+}
+
+TEST(JobSystemTest, ParallelForCoversRange)
+{
+    JobSystem jobs;
+    jobs.Init(3);
+    EXPECT_EQ(jobs.GetThreadCount(), 4u);
+    EXPECT_EQ(jobs.GetThreadIndex(), 0u);
+
+    constexpr uint32_t kCount = 100003;
+    std::vector<int> visits(kCount, 0);
+    jobs.ParallelFor(kCount, 1000, [&visits](uint32_t begin, uint32_t end)
+    {
+        for(uint32_t i = begin; i < end; ++i)
+            visits[i]++;
+    });
+
+    EXPECT_EQ(std::accumulate(visits.begin(), visits.end(), 0), static_cast<int>(kCount));
+    for(int visit : visits)
+        ASSERT_EQ(visit, 1);
+    jobs.Exit();
+}
+
+TEST(JobSystemTest, DependenciesAreRespected)
+{
+    JobSystem jobs;
+    jobs.Init(4);
+
+    constexpr int kChainLength = 64;
+    std::atomic<int> step{0};
+    bool ordered = true;
+    std::vector<ChainData> chain(kChainLength);
+    std::vector<JobCounter> counters(kChainLength);
+    for(int i = 0; i < kChainLength; ++i)
+    {
+        chain[i] = ChainData{&step, i, &ordered};
+        jobs.Run(ChainStep, &chain[i], &counters[i], "Chain", i == 0 ? nullptr : &counters[i - 1]);
+    }
+    jobs.Wait(counters.back());
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(step.load(), kChainLength);
+    jobs.Exit();
+}
+
+TEST(JobSystemTest, WaitingDependenciesDontBlockWorkers)
+{
+    JobSystem jobs;
+    jobs.Init(2);
+
+    // Both workers take a job whose dependency isn't done, they used to wait for each other
+    std::atomic<int> runs[3] = { {0}, {0}, {0} };
+    JobCounter counters[3];
+    jobs.Run(Slow, &runs[0], &counters[0], "Slow");
+    jobs.Run(Count, &runs[1], &counters[1], "Fast", &counters[0]);
+    jobs.Run(Count, &runs[2], &counters[2], "Fast", &counters[1]);
+    jobs.Wait(counters[2]);
+
+    for(const std::atomic<int> &run : runs)
+        EXPECT_EQ(run.load(), 1);
+    jobs.Exit();
+}
+
+TEST(JobSystemTest, WorkersSleepWhileDependencyRuns)
+{
+    JobSystem jobs;
+    jobs.Init(4);
+
+    std::atomic<int> runs[2] = { {0}, {0} };
+    JobCounter counters[2];
+    jobs.Run(LongSleep, &runs[0], &counters[0], "Long");
+    jobs.Run(Count, &runs[1], &counters[1], "Dependent", &counters[0]);
+
+    // Parked job isn't queued, so idle workers don't spin until dependency is done
+    const std::clock_t start = std::clock();
+    while(!counters[1].IsDone())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const double cpu_seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+
+    EXPECT_EQ(runs[1].load(), 1);
+    EXPECT_LT(cpu_seconds, 0.2);
+    jobs.Exit();
+}
+
+TEST(JobSystemTest, QueuedJobsAreNotOverwritten)
+{
+    JobSystem jobs;
+    jobs.Init(2);
+
+    // More jobs than slots of one thread, all queued at once behind slow job
+    constexpr std::size_t kJobCount = JobSystem::kJobsPerThread * 3;
+    std::vector<std::atomic<int>> runs(kJobCount);
+    std::atomic<int> slow_runs{0};
+    JobCounter slow;
+    JobCounter counter;
+    jobs.Run(Slow, &slow_runs, &slow, "Slow");
+    for(std::atomic<int> &run : runs)
+        jobs.Run(Count, &run, &counter, "Count", &slow);
+    jobs.Wait(counter);
+
+    EXPECT_EQ(slow_runs.load(), 1);
+    for(std::size_t i = 0; i < kJobCount; ++i)
+        EXPECT_EQ(runs[i].load(), 1) << "job " << i;
+    jobs.Exit();
+}
+
+TEST(JobSystemTest, NestedJobs)
+{
+    JobSystem jobs;
+    jobs.Init(4);
+
+    std::atomic<int> sum{0};
+    SpawnData root{&jobs, &sum, 10};
+    JobCounter counter;
+    jobs.Run(Spawn, &root, &counter);
+    jobs.Wait(counter);
+
+    EXPECT_EQ(sum.load(), (1 << 11) - 1);
+    jobs.Exit();
+}
+
+TEST(JobSystemTest, ExitFinishesQueuedJobs)
+{
+    std::atomic<int> step{0};
+    bool ordered = true;
+    std::vector<ChainData> chain(100, ChainData{&step, 0, &ordered});
+    {
+        JobSystem jobs;
+        jobs.Init(2);
+        for(ChainData &data : chain)
+            jobs.Run(ChainStep, &data);
+    }
+    EXPECT_EQ(step.load(), 100);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,86 @@
+#include "Utils/LZ4.hpp"
+
+#include "TestSetup.hpp"
+
+#include <vector>
+#include <random>
+#include <cstring>
+
+namespace
+{
+std::vector<std::byte> RoundTrip(const std::vector<std::byte> &input)
+{
+    std::vector<std::byte> compressed;
+    LZ4Compress(input.data(), input.size(), compressed);
+    EXPECT_LE(compressed.size(), LZ4CompressBound(input.size()));
+
+    std::vector<std::byte> output(input.size());
+    EXPECT_TRUE(LZ4Decompress(compressed.data(), compressed.size(), output.data(), output.size()));
+    EXPECT_EQ(output, input);
+    return compressed;
+}
+
+std::vector<std::byte> MakeText(std::size_t size)
+{
+    const char *kWords = "the quick brown fox jumps over the lazy dog ";
+    std::vector<std::byte> bytes(size);
+    for(std::size_t i = 0; i < size; ++i)
+        bytes[i] = static_cast<std::byte>(kWords[i % std::strlen(kWords)]);
+    return bytes;
+}
+} // namespace
+
+TEST(LZ4Test, RoundTripsEmptyAndSmallInputs)
+{
+    for(std::size_t size = 0; size < 32; ++size)
+        RoundTrip(MakeText(size));
+}
+
+TEST(LZ4Test, CompressesRepetitiveData)
+{
+    const std::vector<std::byte> input = MakeText(100000);
+    EXPECT_LT(RoundTrip(input).size(), input.size() / 10);
+
+    // Run of one byte needs overlapping match and long length encoding
+    EXPECT_LT(RoundTrip(std::vector<std::byte>(70000, std::byte{7})).size(), 400u);
+}
+
+TEST(LZ4Test, RoundTripsRandomData)
+{
+    std::mt19937 random(42);
+    std::vector<std::byte> input(200000);
+    for(std::byte &byte : input)
+        byte = static_cast<std::byte>(random());
+    RoundTrip(input);
+}
+
+TEST(LZ4Test, RejectsCorruptedInput)
+{
+    const std::vector<std::byte> input = MakeText(10000);
+    std::vector<std::byte> compressed;
+    LZ4Compress(input.data(), input.size(), compressed);
+    std::vector<std::byte> output(input.size());
+
+    // Wrong expected size
+    EXPECT_FALSE(LZ4Decompress(compressed.data(), compressed.size(), output.data(), output.size() - 1));
+    std::vector<std::byte> bigger(input.size() + 1);
+    EXPECT_FALSE(LZ4Decompress(compressed.data(), compressed.size(), bigger.data(), bigger.size()));
+    // Truncated
+    EXPECT_FALSE(LZ4Decompress(compressed.data(), compressed.size() / 2, output.data(), output.size()));
+
+    // Random garbage never writes out of bounds
+    std::mt19937 random(7);
+    for(int i = 0; i < 1000; ++i)
+    {
+        std::vector<std::byte> garbage = compressed;
+        garbage[random() % garbage.size()] = static_cast<std::byte>(random());
+        garbage[random() % garbage.size()] = static_cast<std::byte>(random());
+        (void)LZ4Decompress(garbage.data(), garbage.size(), output.data(), output.size());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+#include "Utils/LogArchive.hpp"
+#include "Platform/FileAllocation.hpp"
+
+#include "TestSetup.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+namespace fs = std::filesystem;
+
+/// Empty directory that is removed after test
+class LogArchiveTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory = fs::temp_directory_path() / ("LogArchiveTest_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name()));
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(directory);
+    }
+
+    fs::path Write(const std::string &name, const std::string &content)
+    {
+        const fs::path path = directory / name;
+        std::ofstream(path, std::ios::binary) << content;
+        return path;
+    }
+
+    fs::path directory;
+};
+} // namespace
+
+TEST_F(LogArchiveTest, CompressedFileReadsBack)
+{
+    std::string content;
+    for(int i = 0; i < 10000; ++i)
+        content += "Line " + std::to_string(i) + " of log that repeats a lot\n";
+    const fs::path path = Write("log_20260101_000000_000.txt", content);
+
+    ASSERT_TRUE(CompressLogFile(path));
+    EXPECT_FALSE(fs::exists(path));
+    const fs::path archive = fs::path(path) += kLogArchiveExtension;
+    ASSERT_TRUE(fs::exists(archive));
+    EXPECT_LT(fs::file_size(archive), content.size() / 4);
+
+    std::string read;
+    ASSERT_TRUE(ReadLogFile(archive, read));
+    EXPECT_EQ(read, content);
+}
+
+TEST_F(LogArchiveTest, EmptyAndPlainFilesRead)
+{
+    const fs::path empty = Write("log_20260101_000000_000.txt", "");
+    ASSERT_TRUE(CompressLogFile(empty));
+    std::string read = "something";
+    ASSERT_TRUE(ReadLogFile(fs::path(empty) += kLogArchiveExtension, read));
+    EXPECT_TRUE(read.empty());
+
+    ASSERT_TRUE(ReadLogFile(Write("plain.txt", "plain text\n"), read));
+    EXPECT_EQ(read, "plain text\n");
+    EXPECT_FALSE(ReadLogFile(directory / "missing.txt", read));
+}
+
+TEST_F(LogArchiveTest, OldestLogsAreRemoved)
+{
+    const std::vector<std::string> stems = { "log_20260101_000000_000", "log_20260101_000000_001", "log_20260102_000000_000", "log_20260103_000000_000" };
+    for(const std::string &stem : stems)
+    {
+        Write(stem + ".txt.lz4", "text");
+        Write(stem + ".binlog.lz4", "binary");
+    }
+    Write("last_log.txt", "current");
+
+    RemoveOldLogs(directory, 2);
+
+    EXPECT_FALSE(fs::exists(directory / (stems[0] + ".txt.lz4")));
+    EXPECT_FALSE(fs::exists(directory / (stems[1] + ".binlog.lz4")));
+    EXPECT_TRUE(fs::exists(directory / (stems[2] + ".txt.lz4")));
+    EXPECT_TRUE(fs::exists(directory / (stems[2] + ".binlog.lz4")));
+    EXPECT_TRUE(fs::exists(directory / (stems[3] + ".txt.lz4")));
+    EXPECT_TRUE(fs::exists(directory / "last_log.txt"));
+}
+
+TEST_F(LogArchiveTest, PreallocationKeepsFileSize)
+{
+    const fs::path path = Write("preallocated.txt", "content");
+    // File system may not support it, file has to stay the same either way
+    (void)PreallocateFile(path.string(), 1 << 20);
+    EXPECT_EQ(fs::file_size(path), 7u);
+    EXPECT_FALSE(PreallocateFile((directory / "missing.txt").string(), 1 << 20));
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
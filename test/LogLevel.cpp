@@ -0,0 +1,110 @@
+// Lines of this file are compiled like lines of Renderer module built with Warning level
+#define GAME_LOG_LEVEL Warning
+#define GAME_LOG_MODULE Renderer
+
+#include "Utils/Logger.hpp"
+#include "Utils/BinaryLog.hpp"
+
+#include "TestSetup.hpp"
+
+#include <sstream>
+#include <string>
+
+namespace
+{
+int evaluated = 0;
+
+int Evaluate(int value)
+{
+    ++evaluated;
+    return value;
+}
+
+/// Captures stream output of logger and logs everything again when done
+class LogLevelTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        evaluated = 0;
+        Logger::Get().SetOutStreamBuffer(output);
+    }
+
+    void TearDown() override
+    {
+        EXPECT_TRUE(Logger::SetModuleTypes("Info"));
+        Logger::SetVerboseLevel(Logger::kDefVerboseLevel);
+        Logger::Get().SetOutStreamBuffer(std::cout);
+    }
+
+    std::string Output()
+    {
+        Logger::Get().Flush();
+        return output.str();
+    }
+
+    std::ostringstream output;
+};
+} // namespace
+
+static_assert(!detail::kLogTypeCompiled<LogType::Info, LogType::GAME_LOG_LEVEL>);
+static_assert(detail::kLogTypeCompiled<LogType::Warning, LogType::GAME_LOG_LEVEL>);
+static_assert(detail::kLogTypeCompiled<LogType::Fatal, LogType::None>);
+
+TEST_F(LogLevelTest, LinesAboveCompiledLevelAreNotEvaluated)
+{
+    GAME_LOG(LogType::Info) << "info " << Evaluate(1);
+    GAME_BLOG(LogType::Info, "binary info {}", Evaluate(2));
+    GAME_LOG(LogType::Warning) << "warning " << Evaluate(3);
+    GAME_BLOG(LogType::Error, "binary error {}", Evaluate(4));
+
+    EXPECT_EQ(evaluated, 2);
+    EXPECT_EQ(Output(), "warning 3\nbinary error 4\n");
+}
+
+TEST_F(LogLevelTest, ModuleTypeFiltersAtRuntime)
+{
+    Logger::SetModuleType(LogModule::Renderer, LogType::Error);
+    // Other modules don't change lines of this one
+    Logger::SetModuleType(LogModule::Events, LogType::Info);
+    GAME_LOG(LogType::Warning) << "warning " << Evaluate(1);
+    GAME_LOG(LogType::Error) << "error " << Evaluate(2);
+
+    EXPECT_EQ(evaluated, 1);
+    EXPECT_EQ(Output(), "error 2\n");
+}
+
+TEST_F(LogLevelTest, VerboseLevelFiltersAtRuntime)
+{
+    Logger::SetVerboseLevel(2);
+    GAME_VLOG(1, LogType::Warning) << "verbose 1";
+    GAME_VLOG(2, LogType::Warning) << "verbose 2 " << Evaluate(2);
+
+    EXPECT_EQ(evaluated, 0);
+    EXPECT_EQ(Output(), "verbose 1\n");
+}
+
+TEST_F(LogLevelTest, ModuleTypesAreParsed)
+{
+    EXPECT_TRUE(Logger::SetModuleTypes("Warning"));
+    for(uint8_t module = 0; module < ToUnderlying(LogModule::Count); ++module)
+        EXPECT_EQ(Logger::GetModuleType(static_cast<LogModule>(module)), LogType::Warning);
+
+    EXPECT_TRUE(Logger::SetModuleTypes("Renderer:Error,Events:Info"));
+    EXPECT_EQ(Logger::GetModuleType(LogModule::Renderer), LogType::Error);
+    EXPECT_EQ(Logger::GetModuleType(LogModule::Events), LogType::Info);
+    EXPECT_EQ(Logger::GetModuleType(LogModule::Game), LogType::Warning);
+
+    EXPECT_FALSE(Logger::SetModuleTypes("Renderer:Loud"));
+    EXPECT_FALSE(Logger::SetModuleTypes("Sound:Info"));
+    // Entries before the wrong one are set
+    EXPECT_FALSE(Logger::SetModuleTypes("Jobs:None,Bad"));
+    EXPECT_EQ(Logger::GetModuleType(LogModule::Jobs), LogType::None);
+    EXPECT_EQ(Logger::GetLogTypeName(LogType::Fatal), "Fatal");
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,204 @@
+#include "Utils/Logger.hpp"
+#include "Utils/LogArchive.hpp"
+
+#include "TestSetup.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <set>
+#include <filesystem>
+
+namespace
+{
+constexpr int kThreadCount = 4;
+constexpr int kLinesPerThread = 2000;
+
+/// Captures stream output of logger and restores default policies when done
+class LoggerTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Logger::Get().SetOutStreamBuffer(output);
+    }
+
+    void TearDown() override
+    {
+        Logger::Get().SetFlushPolicy(LogFlushPolicy{});
+        Logger::Get().SetRotationPolicy(LogRotationPolicy{});
+        Logger::Get().SetOutStreamBuffer(std::cout);
+    }
+
+    static std::string ReadLogFile()
+    {
+        std::ifstream file(Logger::kDefLogPath / Logger::kDefLogFileName);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    std::ostringstream output;
+};
+} // namespace
+
+TEST_F(LoggerTest, LinesOfConcurrentThreadsStayWhole)
+{
+    // Every line waits for room instead of being dropped
+    Logger::Get().SetFlushPolicy(LogFlushPolicy{ LogType::Info, std::chrono::milliseconds(200), 64 * 1024 });
+
+    std::vector<std::thread> threads;
+    for(int thread = 0; thread < kThreadCount; ++thread)
+        threads.emplace_back([thread]
+        {
+            for(int line = 0; line < kLinesPerThread; ++line)
+                GAME_LOG(LogType::Info) << "thread " << thread << " line " << line << " end";
+        });
+    for(std::thread &thread : threads)
+        thread.join();
+    Logger::Get().Flush();
+
+    std::vector<int> next_line(kThreadCount, 0);
+    std::istringstream lines(output.str());
+    std::string line;
+    while(std::getline(lines, line))
+    {
+        int thread = -1;
+        int number = -1;
+        char end[4] = {};
+        ASSERT_EQ(std::sscanf(line.c_str(), "thread %d line %d %3s", &thread, &number, end), 3) << line;
+        ASSERT_STREQ(end, "end");
+        ASSERT_TRUE(thread >= 0 && thread < kThreadCount);
+        // Lines of one thread keep their order
+        EXPECT_EQ(number, next_line[thread]++);
+    }
+    for(int thread = 0; thread < kThreadCount; ++thread)
+        EXPECT_EQ(next_line[thread], kLinesPerThread);
+    EXPECT_EQ(Logger::Get().GetDroppedCount(), 0u);
+}
+
+TEST_F(LoggerTest, FlushWritesLongLinesToFile)
+{
+    // Nothing but explicit flush would reach the file
+    Logger::Get().SetFlushPolicy(LogFlushPolicy{ LogType::Fatal, std::chrono::hours(1), std::size_t(1) << 30 });
+
+    const std::string long_text(1000, 'x');
+    GAME_LOG(LogType::Warning) << "long " << long_text;
+    Logger::Get().Flush();
+
+    EXPECT_EQ(output.str(), "long " + long_text + "\n");
+    if(Logger::Get().IsOutputToFile())
+    {
+        EXPECT_NE(ReadLogFile().find("long " + long_text + "\n"), std::string::npos);
+    }
+}
+
+TEST_F(LoggerTest, SleepingWriterWakesForLineAndFlushesIt)
+{
+    if(!Logger::Get().IsOutputToFile())
+        GTEST_SKIP() << "Log file couldn't be created";
+
+    // Writer has nothing to do, so it sleeps without timeout until line comes
+    Logger::Get().Flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    GAME_LOG(LogType::Info) << "line for sleeping writer";
+
+    // Line isn't severe, it reaches the file after flush interval of policy
+    bool written = false;
+    for(int attempt = 0; attempt < 200 && !written; ++attempt)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        written = ReadLogFile().find("line for sleeping writer\n") != std::string::npos;
+    }
+    EXPECT_TRUE(written);
+}
+
+TEST_F(LoggerTest, FatalLineIsWrittenBeforeAbort)
+{
+    if(!Logger::Get().IsOutputToFile())
+        GTEST_SKIP() << "Log file couldn't be created";
+
+    // Child starts from scratch, so writer thread of this process can't hold logger locks in it
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_DEATH(
+    {
+        GAME_LOG(LogType::Info) << "line before fatal";
+        GAME_LOG(LogType::Fatal) << "fatal line";
+    }, "");
+
+    const std::string content = ReadLogFile();
+    const std::size_t before = content.find("line before fatal\n");
+    ASSERT_NE(before, std::string::npos);
+    EXPECT_NE(content.find("fatal line\n", before), std::string::npos);
+}
+
+TEST_F(LoggerTest, FilesAreRotatedIntoCompressedArchive)
+{
+    if(!Logger::Get().IsOutputToFile())
+        GTEST_SKIP() << "Log file couldn't be created";
+
+    constexpr int kRounds = 6;
+    constexpr int kLinesPerRound = 50;
+    const std::string padding(100, '.');
+    std::size_t round_size = 0;
+    for(int line = 0; line < kLinesPerRound; ++line)
+        round_size += ("round 0 line " + std::to_string(line) + ' ' + padding + '\n').size();
+
+    // Lines of other tests are rotated away first
+    Logger::Get().SetRotationPolicy(LogRotationPolicy{ 1, std::chrono::minutes(0), 2, true });
+    GAME_LOG(LogType::Info) << "before rounds";
+    Logger::Get().Flush();
+    // Writer can write round in several parts, limit is reached only by the whole round
+    Logger::Get().SetRotationPolicy(LogRotationPolicy{ round_size, std::chrono::minutes(0), 2, true });
+    for(int round = 0; round < kRounds; ++round)
+    {
+        for(int line = 0; line < kLinesPerRound; ++line)
+            GAME_LOG(LogType::Info) << "round " << round << " line " << line << ' ' << padding;
+        Logger::Get().Flush();
+    }
+
+    // Archiver works in background, wait until it compressed files and removed the old ones
+    std::set<std::string> archives;
+    for(int attempt = 0; attempt < 500; ++attempt)
+    {
+        archives.clear();
+        bool pending = false;
+        for(const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(Logger::kDefLogPath))
+        {
+            const std::string name = entry.path().filename().string();
+            if(name.compare(0, kLogArchivePrefix.size(), kLogArchivePrefix) != 0)
+                continue;
+            pending = pending || entry.path().extension() != kLogArchiveExtension;
+            archives.insert(name);
+        }
+        if(!pending && archives.size() <= 2)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(archives.size(), 2u);
+
+    // Names sort from the oldest, so the last one has the last round
+    int round = kRounds - 2;
+    for(const std::string &name : archives)
+    {
+        std::string content;
+        ASSERT_TRUE(game::ReadLogFile(Logger::kDefLogPath / name, content));
+        std::string expected;
+        for(int line = 0; line < kLinesPerRound; ++line)
+            expected += "round " + std::to_string(round) + " line " + std::to_string(line) + ' ' + padding + '\n';
+        EXPECT_EQ(content, expected) << name;
+        ++round;
+    }
+    EXPECT_TRUE(ReadLogFile().empty());
+}
+
+int main(int argc, char **argv)
+{
+    // Rotation is tested here, so logger archives like the game does
+    Logger::EnableArchive();
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+#include "Utils/MPSCQueue.hpp"
+#include "Core/EventHandler.hpp"
+
+#include "TestSetup.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct Item
+{
+    uint32_t producer;
+    uint32_t sequence;
+};
+
+bool CountEvent(__attribute__((unused)) const Event &event, void *data)
+{
+    ++*reinterpret_cast<int*>(data);
+    return true;
+}
+} // namespace
+
+TEST(MPSCQueueTest, PushPopOrder)
+{
+    MPSCQueue<int> queue(4);
+    int value = 0;
+
+    EXPECT_FALSE(queue.TryPop(value));
+    EXPECT_TRUE(queue.TryPush(1));
+    EXPECT_TRUE(queue.TryPush(2));
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(MPSCQueueTest, FullQueueRejectsPush)
+{
+    MPSCQueue<int> queue(4);
+    for(int i = 0; i < 4; ++i)
+        EXPECT_TRUE(queue.TryPush(i));
+    EXPECT_FALSE(queue.TryPush(4));
+
+    int value = 0;
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_TRUE(queue.TryPush(4));
+}
+
+TEST(MPSCQueueTest, PeekDoesNotPop)
+{
+    MPSCQueue<int> queue(4);
+    int value = 0;
+
+    EXPECT_FALSE(queue.TryPeek(0, value));
+    for(int i = 1; i <= 4; ++i)
+        EXPECT_TRUE(queue.TryPush(i));
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_TRUE(queue.TryPush(5));
+
+    // Peek sees values in pop order, also after queue wrapped
+    for(std::size_t offset = 0; offset < 4; ++offset)
+    {
+        EXPECT_TRUE(queue.TryPeek(offset, value));
+        EXPECT_EQ(value, static_cast<int>(offset) + 2);
+    }
+    EXPECT_FALSE(queue.TryPeek(4, value));
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_EQ(value, 2);
+}
+
+TEST(MPSCQueueTest, MultipleProducersStress)
+{
+    constexpr uint32_t kProducerCount = 8;
+    constexpr uint32_t kItemsPerProducer = 50000;
+    MPSCQueue<Item> queue(1024);
+
+    std::vector<std::thread> producers;
+    for(uint32_t producer = 0; producer < kProducerCount; ++producer)
+    {
+        producers.emplace_back([&queue, producer]
+        {
+            for(uint32_t i = 0; i < kItemsPerProducer; ++i)
+                while(!queue.TryPush(Item{producer, i}))
+                    std::this_thread::yield();
+        });
+    }
+
+    // Values of each producer should come in the order they were pushed
+    // Queue is drained even after wrong value, producers would wait for space forever and join would hang otherwise
+    std::vector<uint32_t> next_sequence(kProducerCount, 0);
+    uint64_t received = 0;
+    uint64_t unexpected = 0;
+    Item item;
+    while(received < kProducerCount * kItemsPerProducer)
+    {
+        if(!queue.TryPop(item))
+            continue;
+        received++;
+        if(item.producer >= kProducerCount)
+        {
+            unexpected++;
+            continue;
+        }
+        if(item.sequence != next_sequence[item.producer])
+            unexpected++;
+        next_sequence[item.producer] = item.sequence + 1;
+    }
+
+    for(std::thread &producer : producers)
+        producer.join();
+
+    EXPECT_EQ(unexpected, 0u);
+    EXPECT_FALSE(queue.TryPop(item));
+    for(uint32_t sequence : next_sequence)
+        EXPECT_EQ(sequence, kItemsPerProducer);
+}
+
+TEST(MPSCQueueTest, EventHandlerCountsOverflow)
+{
+    EventHandler events(4);
+    EventCleaner cleaner(events);
+    int dispatched = 0;
+    events.AddListener(cleaner, EventType::Quit, &dispatched, CountEvent);
+
+    std::vector<std::thread> producers;
+    for(int i = 0; i < 2; ++i)
+        producers.emplace_back([&events] { for(int j = 0; j < 3; ++j) events.EnqueEvent(Event{Event::Quit{}}); });
+    for(std::thread &producer : producers)
+        producer.join();
+
+    events.DispatchEnquedEvents();
+    EXPECT_EQ(dispatched, 4);
+    EXPECT_EQ(events.GetOverflowCount(), 2u);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
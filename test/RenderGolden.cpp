@@ -0,0 +1,219 @@
+#include "RenderHarness.hpp"
+#include "Platform/OpenGL/OpenGLRenderer.hpp"
+#include "Utils/FlagParser.hpp"
+
+#include "TestSetup.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#ifndef GAME_GOLDEN_DIRECTORY
+    #define GAME_GOLDEN_DIRECTORY "test/golden"
+#endif
+
+namespace
+{
+constexpr int kSize = 128;
+/// Rasterizers can differ a bit in rounding and on edges of rotated sprites
+constexpr int kTolerance = 2;
+constexpr std::size_t kMaxDifferentPixels = kSize * kSize / 200;
+
+/// Golden images are rewritten instead of compared when GAME_UPDATE_GOLDEN is set
+void CompareWithGolden(const std::string &name, const Image &actual)
+{
+    const std::string golden_path = std::string(GAME_GOLDEN_DIRECTORY) + "/" + name + ".png";
+    if(std::getenv("GAME_UPDATE_GOLDEN") != nullptr)
+    {
+        EXPECT_TRUE(SaveImage(golden_path, actual));
+        return;
+    }
+
+    Image golden;
+    ASSERT_TRUE(LoadImage(golden_path, golden)) << "No golden image " << golden_path << ", run with GAME_UPDATE_GOLDEN=1 to create it";
+    const ImageDiff diff = CompareImages(golden, actual, kTolerance);
+    EXPECT_LE(diff.different_pixels, kMaxDifferentPixels) << "Max channel difference: " << diff.max_difference;
+    if(diff.different_pixels > kMaxDifferentPixels)
+        (void)SaveImage(name + ".actual.png", actual);
+}
+
+class RenderGoldenTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string error = harness.Init(kSize, kSize);
+        if(!error.empty())
+            GTEST_SKIP() << error;
+    }
+
+    void TearDown() override
+    {
+        harness.Exit();
+    }
+
+    void CheckGolden(const Scene &scene)
+    {
+        ASSERT_TRUE(harness.RenderFrame(scene, 0, true));
+        Image actual;
+        ASSERT_TRUE(harness.readback.Wait(actual));
+        CompareWithGolden(scene.name, actual);
+    }
+
+    RenderHarness harness;
+};
+
+/// Whole renderer with -offscreen flag, frames go through render queue, framebuffer and captures
+/// Fixture context only tells if there is OpenGL 4.5, renderer makes its own one on the same window
+class OpenGLRendererGoldenTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string error = gl.Init("OpenGLRendererGoldenTest", kSize, kSize);
+        if(!error.empty())
+            GTEST_SKIP() << error;
+    }
+
+    void TearDown() override
+    {
+        if(renderer != nullptr)
+            renderer->Exit();
+        gl.Exit();
+    }
+
+    void Init(std::vector<const char*> arguments)
+    {
+        arguments.insert(arguments.begin(), "Game");
+        const Flags flags(static_cast<int>(arguments.size()), arguments.data());
+        renderer = &static_cast<OpenGLRenderer&>(Renderer::CreateRenderer(flags));
+        renderer->Init(gl.GetWindow(), flags);
+    }
+
+    /// Sprites are added from the top layer down, so only sorting puts them in the right order
+    void AddSprites()
+    {
+        renderer->AddSprite(2, 0, scenes::MakeSprite(72.0f, 72.0f, 32.0f, 32.0f, scenes::PaletteColor(2, 0x80), 0.5f));
+        renderer->AddSprite(1, 0, scenes::MakeSprite(56.0f, 56.0f, 48.0f, 48.0f, scenes::PaletteColor(1)));
+        renderer->AddSprite(0, 0, scenes::MakeSprite(64.0f, 64.0f, 112.0f, 112.0f, scenes::PaletteColor(0)));
+    }
+
+    /// Readback finishes a few frames after capture was asked for, empty frames are rendered meanwhile
+    bool RenderCapture(Image &image)
+    {
+        renderer->RequestCapture();
+        AddSprites();
+        renderer->Render(0.0f);
+        for(int frame = 0; frame < 100; ++frame)
+        {
+            if(renderer->TakeCapture(image))
+                return true;
+            renderer->Render(0.0f);
+        }
+        return false;
+    }
+
+    TestGLContext gl;
+    OpenGLRenderer *renderer = nullptr;
+};
+
+/// Sprite that moves by 8 pixels every frame, so frames can be told apart
+void Moving(SpriteRenderer &sprites, const SceneTextures &, int, int, uint32_t frame)
+{
+    sprites.Draw(0, 0, scenes::MakeSprite(4.0f + 8.0f * static_cast<float>(frame), 4.0f, 8.0f, 8.0f, 0xffffffff));
+}
+} // namespace
+
+TEST_F(RenderGoldenTest, Quads)
+{
+    CheckGolden(kGoldenScenes[0]);
+}
+
+TEST_F(RenderGoldenTest, Blended)
+{
+    CheckGolden(kGoldenScenes[1]);
+}
+
+TEST_F(RenderGoldenTest, Textured)
+{
+    CheckGolden(kGoldenScenes[2]);
+}
+
+TEST_F(RenderGoldenTest, MinimizedSizeKeepsFramebuffer)
+{
+    EXPECT_TRUE(harness.framebuffer.Resize(0, 0));
+    EXPECT_EQ(harness.framebuffer.GetWidth(), kSize);
+    EXPECT_EQ(harness.framebuffer.GetHeight(), kSize);
+    CheckGolden(kGoldenScenes[0]);
+}
+
+TEST_F(RenderGoldenTest, ComparisonFindsDifferences)
+{
+    Image lhs;
+    lhs.width = 2;
+    lhs.height = 1;
+    lhs.pixels = { 0xff000000, 0xff102030 };
+    Image rhs = lhs;
+    rhs.pixels[1] = 0xff102033;
+
+    EXPECT_EQ(CompareImages(lhs, rhs, 3).different_pixels, 0u);
+    const ImageDiff diff = CompareImages(lhs, rhs, 2);
+    EXPECT_EQ(diff.different_pixels, 1u);
+    EXPECT_EQ(diff.max_difference, 3);
+
+    rhs.width = 1;
+    EXPECT_EQ(CompareImages(lhs, rhs, 255).different_pixels, 2u);
+}
+
+TEST_F(RenderGoldenTest, CapturesArriveInOrderWithoutWaiting)
+{
+    const Scene moving{ "Moving", Moving };
+    for(uint32_t frame = 0; frame < PixelReadback::kBufferCount; ++frame)
+        ASSERT_TRUE(harness.RenderFrame(moving, frame, true));
+    // Ring is full, so next capture is refused instead of waiting
+    EXPECT_FALSE(harness.RenderFrame(moving, PixelReadback::kBufferCount, true));
+    EXPECT_EQ(harness.readback.GetPendingCount(), PixelReadback::kBufferCount);
+
+    for(uint32_t frame = 0; frame < PixelReadback::kBufferCount; ++frame)
+    {
+        Image image;
+        ASSERT_TRUE(harness.readback.Wait(image));
+        ASSERT_EQ(image.width, kSize);
+        // Rows are top to bottom, so sprite is in the first rows
+        EXPECT_EQ(image.pixels[4 * kSize + 4 + 8 * frame], 0xffffffffu);
+        EXPECT_EQ(image.pixels[4 * kSize + 4 + 8 * (frame + 1)], 0xff000000u);
+        EXPECT_EQ(image.pixels[(kSize - 4) * kSize + 4], 0xff000000u);
+    }
+    Image image;
+    EXPECT_FALSE(harness.readback.Poll(image));
+}
+
+TEST_F(OpenGLRendererGoldenTest, OffscreenFrame)
+{
+    Init({ "-offscreen", "-no-shader-cache" });
+    Image actual;
+    ASSERT_TRUE(RenderCapture(actual));
+    ASSERT_EQ(actual.width, kSize);
+    ASSERT_EQ(actual.height, kSize);
+    CompareWithGolden("OffscreenFrame", actual);
+}
+
+TEST_F(OpenGLRendererGoldenTest, RenderThreadFrame)
+{
+    Init({ "-offscreen", "-no-shader-cache", "-render-thread", "-frame-latency=2" });
+    // Frames before the captured one keep render thread busy
+    for(int frame = 0; frame < 5; ++frame)
+    {
+        AddSprites();
+        renderer->Render(0.0f);
+    }
+    Image actual;
+    ASSERT_TRUE(RenderCapture(actual));
+    CompareWithGolden("OffscreenFrame", actual);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,336 @@
+#ifndef RENDER_HARNESS_HPP
+#define RENDER_HARNESS_HPP
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "Core/Image.hpp"
+#include "Platform/OpenGL/GLState.hpp"
+#include "Platform/OpenGL/ShaderCache.hpp"
+#include "Platform/OpenGL/SpriteRenderer.hpp"
+#include "Platform/OpenGL/Framebuffer.hpp"
+#include "Platform/OpenGL/PixelReadback.hpp"
+
+namespace game {}
+using namespace game;
+
+/// Textures scenes can draw with, sprite texture 0 is white texture
+struct SceneTextures
+{
+    /// 8x8 texels, magenta and black checkers of 2 texels
+    GLuint checker = 0;
+    /// 4x4 texels of single color each
+    std::array<GLuint, 8> tinted{};
+};
+
+/// Deterministic set of sprites, frame lets scene animate
+struct Scene
+{
+    const char *name;
+    void (*draw)(SpriteRenderer &sprites, const SceneTextures &textures, int width, int height, uint32_t frame);
+};
+
+namespace scenes
+{
+inline SpriteInstance MakeSprite(float x, float y, float width, float height, uint32_t color, float rotation = 0.0f)
+{
+    SpriteInstance sprite;
+    sprite.position[0] = x;
+    sprite.position[1] = y;
+    sprite.size[0] = width;
+    sprite.size[1] = height;
+    sprite.rotation = rotation;
+    sprite.color = color;
+    return sprite;
+}
+
+/// Color of palette entry, RGBA with red in the lowest byte
+inline uint32_t PaletteColor(uint32_t index, uint32_t alpha = 0xff)
+{
+    constexpr uint32_t kPalette[] = { 0x0000ff, 0x00ff00, 0xff0000, 0x00ffff, 0xff00ff, 0xffff00, 0xffffff, 0x0080ff };
+    return kPalette[index % 8] | (alpha << 24);
+}
+
+/// Cheap deterministic pseudo random numbers, same on every platform
+inline uint32_t Random(uint32_t &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+/// Grid of opaque axis aligned quads with pixel aligned edges
+inline void Quads(SpriteRenderer &sprites, const SceneTextures &, int width, int height, uint32_t)
+{
+    constexpr int kCells = 8;
+    const float cell_width = static_cast<float>(width) / kCells;
+    const float cell_height = static_cast<float>(height) / kCells;
+    for(int y = 0; y < kCells; ++y)
+        for(int x = 0; x < kCells; ++x)
+            sprites.Draw(0, 0, MakeSprite((x + 0.5f) * cell_width, (y + 0.5f) * cell_height, cell_width - 4.0f, cell_height - 4.0f, PaletteColor(x + y)));
+}
+
+/// Rotated translucent sprites on top of each other, checks blending and rotation
+inline void Blended(SpriteRenderer &sprites, const SceneTextures &, int width, int height, uint32_t frame)
+{
+    const float center_x = static_cast<float>(width) * 0.5f;
+    const float center_y = static_cast<float>(height) * 0.5f;
+    const float size = static_cast<float>(std::min(width, height)) * 0.6f;
+    for(uint32_t i = 0; i < 6; ++i)
+        sprites.Draw(0, 0, MakeSprite(center_x, center_y, size, size * 0.4f, PaletteColor(i, 0x80), 0.5f * static_cast<float>(i) + 0.01f * static_cast<float>(frame)));
+}
+
+/// Textured sprites with nearest filtering, sub regions and tint
+inline void Textured(SpriteRenderer &sprites, const SceneTextures &textures, int width, int height, uint32_t)
+{
+    const float half_width = static_cast<float>(width) * 0.5f;
+    const float half_height = static_cast<float>(height) * 0.5f;
+    sprites.Draw(0, textures.checker, MakeSprite(half_width * 0.5f, half_height * 0.5f, half_width, half_height, 0xffffffff));
+    SpriteInstance quarter = MakeSprite(half_width * 1.5f, half_height * 0.5f, half_width, half_height, 0xffffffff);
+    quarter.uv[2] = 0.5f;
+    quarter.uv[3] = 0.5f;
+    sprites.Draw(0, textures.checker, quarter);
+    sprites.Draw(0, textures.checker, MakeSprite(half_width * 0.5f, half_height * 1.5f, half_width, half_height, 0xffffff00));
+    for(uint32_t i = 0; i < 4; ++i)
+        sprites.Draw(0, textures.tinted[i], MakeSprite(half_width * (1.25f + 0.5f * static_cast<float>(i % 2)), half_height * (1.25f + 0.5f * static_cast<float>(i / 2)), half_width * 0.5f, half_height * 0.5f, 0xffffffff));
+}
+
+/// Many small sprites with one texture, measures instancing throughput
+inline void ManySprites(SpriteRenderer &sprites, const SceneTextures &, int width, int height, uint32_t frame)
+{
+    constexpr uint32_t kCount = 20000;
+    uint32_t state = 1;
+    for(uint32_t i = 0; i < kCount; ++i)
+    {
+        const float x = static_cast<float>(Random(state) % static_cast<uint32_t>(width));
+        const float y = static_cast<float>(Random(state) % static_cast<uint32_t>(height));
+        sprites.Draw(0, 0, MakeSprite(x, y, 8.0f, 8.0f, PaletteColor(i, 0xc0), 0.05f * static_cast<float>(frame + i)));
+    }
+}
+
+/// Sprites that change texture every time, measures cost of batch breaks
+inline void TextureThrash(SpriteRenderer &sprites, const SceneTextures &textures, int width, int height, uint32_t)
+{
+    constexpr uint32_t kCount = 4096;
+    uint32_t state = 2;
+    for(uint32_t i = 0; i < kCount; ++i)
+    {
+        const float x = static_cast<float>(Random(state) % static_cast<uint32_t>(width));
+        const float y = static_cast<float>(Random(state) % static_cast<uint32_t>(height));
+        sprites.Draw(0, textures.tinted[i % textures.tinted.size()], MakeSprite(x, y, 16.0f, 16.0f, 0xffffffff));
+    }
+}
+} // scenes
+
+/// Scenes that have golden images in test/golden
+inline constexpr Scene kGoldenScenes[] = {
+    { "Quads", scenes::Quads },
+    { "Blended", scenes::Blended },
+    { "Textured", scenes::Textured }
+};
+
+/// Scenes frames per second are reported for
+inline constexpr Scene kBenchmarkScenes[] = {
+    { "Quads", scenes::Quads },
+    { "Blended", scenes::Blended },
+    { "Textured", scenes::Textured },
+    { "ManySprites", scenes::ManySprites },
+    { "TextureThrash", scenes::TextureThrash }
+};
+
+/// How much two images differ
+struct ImageDiff
+{
+    /// Pixels with any channel off by more than tolerance
+    std::size_t different_pixels = 0;
+    /// Largest channel difference
+    int max_difference = 0;
+};
+
+/// Images of different size differ in every pixel
+inline ImageDiff CompareImages(const Image &expected, const Image &actual, int tolerance)
+{
+    ImageDiff diff;
+    if(expected.width != actual.width || expected.height != actual.height)
+    {
+        diff.different_pixels = std::max(expected.pixels.size(), actual.pixels.size());
+        diff.max_difference = 255;
+        return diff;
+    }
+
+    for(std::size_t i = 0; i < expected.pixels.size(); ++i)
+    {
+        int max_channel = 0;
+        for(int shift = 0; shift < 32; shift += 8)
+        {
+            const int lhs = static_cast<int>((expected.pixels[i] >> shift) & 0xff);
+            const int rhs = static_cast<int>((actual.pixels[i] >> shift) & 0xff);
+            max_channel = std::max(max_channel, std::abs(lhs - rhs));
+        }
+        diff.max_difference = std::max(diff.max_difference, max_channel);
+        if(max_channel > tolerance)
+            ++diff.different_pixels;
+    }
+    return diff;
+}
+
+/// Hidden window with current OpenGL 4.5 context, every GL test and benchmark gets its context from it
+/// Needs no display or GPU with SDL_VIDEODRIVER=offscreen and Mesa's llvmpipe (LIBGL_ALWAYS_SOFTWARE=1)
+class TestGLContext
+{
+public:
+    /// return empty string on success, reason why there is no context otherwise
+    std::string Init(const char *title, int width, int height)
+    {
+        if(std::getenv("SDL_VIDEODRIVER") == nullptr)
+            SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+        if(SDL_Init(SDL_INIT_VIDEO) != 0)
+            return std::string("No video: ") + SDL_GetError();
+        sdl_initialized_ = true;
+
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_COMPATIBILITY);
+        window_ = SDL_CreateWindow(title, 0, 0, width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+        if(window_ == nullptr)
+            return std::string("No window: ") + SDL_GetError();
+        context_ = SDL_GL_CreateContext(window_);
+        if(context_ == nullptr || !gladLoadGLLoader(SDL_GL_GetProcAddress))
+            return std::string("No OpenGL 4.5: ") + SDL_GetError();
+        ready_ = true;
+        return {};
+    }
+
+    void Exit()
+    {
+        if(context_ != nullptr)
+            SDL_GL_DeleteContext(context_);
+        if(window_ != nullptr)
+            SDL_DestroyWindow(window_);
+        if(sdl_initialized_)
+            SDL_Quit();
+        ready_ = false;
+        context_ = nullptr;
+        window_ = nullptr;
+        sdl_initialized_ = false;
+    }
+
+    /// True if context is current and GL functions are loaded, objects made with them should be deleted before Exit
+    bool IsReady() const { return ready_; }
+    SDL_Window *GetWindow() const { return window_; }
+
+private:
+    bool sdl_initialized_ = false;
+    bool ready_ = false;
+    SDL_Window *window_ = nullptr;
+    SDL_GLContext context_ = nullptr;
+};
+
+/// Hidden window with GL context that renders scenes into offscreen framebuffer
+///
+/// Used by golden image tests and render benchmark
+class RenderHarness
+{
+public:
+    /// return empty string on success, reason why there is no context otherwise
+    std::string Init(int width, int height)
+    {
+        const std::string error = gl_.Init("RenderHarness", width, height);
+        if(!error.empty())
+            return error;
+        // Frame rate shouldn't depend on display refresh rate
+        SDL_GL_SetSwapInterval(0);
+
+        state.Init(false);
+        state.SetBlend(true);
+        state.SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        // Disk cache is off, so runs don't leave files behind
+        shaders.Init("");
+        sprites.Init(shaders, state);
+        readback.Init(state);
+        if(!framebuffer.Init(state, width, height))
+            return "Couldn't create offscreen framebuffer";
+        CreateTextures();
+        ready_ = true;
+        return {};
+    }
+
+    void Exit()
+    {
+        if(ready_)
+        {
+            glDeleteTextures(1, &textures.checker);
+            glDeleteTextures(static_cast<GLsizei>(textures.tinted.size()), textures.tinted.data());
+            framebuffer.Exit();
+            readback.Exit();
+            sprites.Exit();
+            shaders.Exit();
+        }
+        gl_.Exit();
+        ready_ = false;
+    }
+
+    /// Clear framebuffer to opaque black and draw frame of scene
+    /// capture starts asynchronous read of the result
+    /// return false if capture was asked for, but every readback buffer is busy
+    bool RenderFrame(const Scene &scene, uint32_t frame, bool capture)
+    {
+        const int width = framebuffer.GetWidth();
+        const int height = framebuffer.GetHeight();
+        state.BindFramebuffer(framebuffer.GetHandle());
+        state.SetViewport(0, 0, width, height);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        sprites.Begin(width, height);
+        scene.draw(sprites, textures, width, height, frame);
+        sprites.End();
+        state.EndFrame();
+        return !capture || readback.Request(framebuffer.GetHandle(), width, height);
+    }
+
+    GLState state;
+    ShaderCache shaders;
+    SpriteRenderer sprites;
+    Framebuffer framebuffer;
+    PixelReadback readback;
+    SceneTextures textures;
+
+private:
+    GLuint CreateTexture(int size, const uint32_t *pixels)
+    {
+        GLuint texture;
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+        glTextureStorage2D(texture, 1, GL_RGBA8, size, size);
+        glTextureSubImage2D(texture, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+
+    void CreateTextures()
+    {
+        std::array<uint32_t, 64> checker;
+        for(int y = 0; y < 8; ++y)
+            for(int x = 0; x < 8; ++x)
+                checker[y * 8 + x] = ((x / 2 + y / 2) & 1) ? 0xff000000 : 0xffff00ff;
+        textures.checker = CreateTexture(8, checker.data());
+
+        for(std::size_t i = 0; i < textures.tinted.size(); ++i)
+        {
+            std::array<uint32_t, 16> pixels;
+            pixels.fill(scenes::PaletteColor(static_cast<uint32_t>(i)));
+            textures.tinted[i] = CreateTexture(4, pixels.data());
+        }
+    }
+
+    TestGLContext gl_;
+    bool ready_ = false;
+};
+
+#endif
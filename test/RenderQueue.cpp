@@ -0,0 +1,78 @@
+#include "Core/RenderQueue.hpp"
+
+#include "TestSetup.hpp"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <limits>
+
+TEST(RenderQueueTest, KeyOrder)
+{
+    // Layer is more important than shader, shader than texture, texture than depth
+    EXPECT_LT(RenderQueue::MakeKey(0, 100, 100, 1.0f), RenderQueue::MakeKey(1, 0, 0, 0.0f));
+    EXPECT_LT(RenderQueue::MakeKey(1, 1, 100, 1.0f), RenderQueue::MakeKey(1, 2, 0, 0.0f));
+    EXPECT_LT(RenderQueue::MakeKey(1, 1, 1, 1.0f), RenderQueue::MakeKey(1, 1, 2, 0.0f));
+    EXPECT_LT(RenderQueue::MakeKey(1, 1, 1, 0.25f), RenderQueue::MakeKey(1, 1, 1, 0.5f));
+    EXPECT_EQ(RenderQueue::MakeKey(0, 0, 0, -1.0f), RenderQueue::MakeKey(0, 0, 0, 0.0f));
+    EXPECT_EQ(RenderQueue::MakeKey(0, 0, 0, 2.0f), RenderQueue::MakeKey(0, 0, 0, 1.0f));
+    EXPECT_EQ(RenderQueue::MakeKey(1, 2, 3, std::numeric_limits<float>::quiet_NaN()), RenderQueue::MakeKey(1, 2, 3, 0.0f));
+    EXPECT_EQ(RenderQueue::MakeKey(0, 0, 0, std::numeric_limits<float>::infinity()), RenderQueue::MakeKey(0, 0, 0, 1.0f));
+}
+
+TEST(RenderQueueTest, CommandsKeepData)
+{
+    RenderQueue queue;
+    ClearCommand clear;
+    clear.color[1] = 0.5f;
+    queue.Add(RenderQueue::MakeKey(0, 0, 0, 0.0f), clear);
+    queue.Add(RenderQueue::MakeKey(1, 3, 4, 0.0f), DrawCommand{7, 3, 4, DrawCommand::kTriangles, 0, 6, 100});
+    queue.Add(RenderQueue::MakeKey(0, 0, 0, 0.5f), ViewportCommand{0, 0, 640, 480});
+    queue.Sort();
+
+    ASSERT_EQ(queue.GetSize(), 3u);
+    auto it = queue.begin();
+    EXPECT_EQ(queue.GetType(*it), RenderCommandType::Clear);
+    EXPECT_FLOAT_EQ(queue.Get<ClearCommand>(*it).color[1], 0.5f);
+    ++it;
+    EXPECT_EQ(queue.GetType(*it), RenderCommandType::Viewport);
+    EXPECT_EQ(queue.Get<ViewportCommand>(*it).width, 640);
+    ++it;
+    EXPECT_EQ(queue.GetType(*it), RenderCommandType::Draw);
+    EXPECT_EQ(queue.Get<DrawCommand>(*it).vertex_array, 7u);
+    EXPECT_EQ(queue.Get<DrawCommand>(*it).instance_count, 100u);
+
+    queue.Clear();
+    EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(RenderQueueTest, SortMatchesStableSort)
+{
+    std::mt19937_64 random(42);
+    RenderQueue queue;
+    std::vector<std::pair<uint64_t, uint32_t>> expected;
+    for(uint32_t i = 0; i < 20000; ++i)
+    {
+        // Few distinct values, so there are many equal keys
+        const uint64_t key = RenderQueue::MakeKey(random() % 4, random() % 8, random() % 16, static_cast<float>(random() % 3) / 2.0f);
+        queue.Add(key, ViewportCommand{static_cast<int32_t>(i), 0, 0, 0});
+        expected.emplace_back(key, i);
+    }
+
+    queue.Sort();
+    std::stable_sort(expected.begin(), expected.end(), [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+    std::size_t i = 0;
+    for(const RenderQueue::Entry &entry : queue)
+    {
+        ASSERT_EQ(entry.key, expected[i].first);
+        ASSERT_EQ(static_cast<uint32_t>(queue.Get<ViewportCommand>(entry).x), expected[i].second);
+        ++i;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
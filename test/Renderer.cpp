@@ -0,0 +1,26 @@
+#include "Core/Renderer.hpp"
+#include "Utils/FlagParser.hpp"
+
+#include "TestSetup.hpp"
+
+TEST(RendererTest, HeadlessFlagSelectsNullRenderer)
+{
+    const char *argv[] = { "Game", "-headless" };
+    const Flags flags(2, argv);
+
+    Renderer &renderer = Renderer::CreateRenderer(flags);
+    EXPECT_TRUE(renderer.IsHeadless());
+    EXPECT_EQ(renderer.GetSDLWindowFlags(), 0);
+    EXPECT_EQ(&renderer, &Renderer::CreateRenderer(flags));
+
+    // Null renderer works without window or context
+    renderer.AddToQueue(RenderQueue::MakeKey(0, 0, 0, 0.0f), ClearCommand{});
+    renderer.Render(0.5f);
+    renderer.Exit();
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,132 @@
+#include "Platform/OpenGL/ShaderCache.hpp"
+#include "RenderHarness.hpp"
+
+#include "TestSetup.hpp"
+
+#include <string>
+#include <filesystem>
+
+namespace
+{
+constexpr const char *kVertexSource = R"(#version 430 core
+uniform vec2 u_offset;
+uniform float u_weights[4];
+void main()
+{
+  gl_Position = vec4(u_offset + vec2(gl_VertexID & 1, gl_VertexID >> 1) * u_weights[3], 0.0, 1.0);
+}
+)";
+
+constexpr const char *kFragmentSource = R"(#version 430 core
+uniform vec4 u_color;
+uniform sampler2D u_texture;
+out vec4 o_color;
+void main()
+{
+  o_color = u_color * texture(u_texture, vec2(0.5));
+}
+)";
+
+class ShaderCacheTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        std::filesystem::remove_all(directory);
+        const std::string error = gl.Init("ShaderCacheTest", 16, 16);
+        if(!error.empty())
+            GTEST_SKIP() << error;
+    }
+
+    void TearDown() override
+    {
+        gl.Exit();
+        std::filesystem::remove_all(directory);
+    }
+
+    const std::string directory = (std::filesystem::temp_directory_path() / "ShaderCacheTest").string();
+    TestGLContext gl;
+};
+} // namespace
+
+TEST_F(ShaderCacheTest, ReflectsUniformsIntoSlots)
+{
+    ShaderCache shaders;
+    shaders.Init("");
+    const uint32_t id = shaders.Load("Test", kVertexSource, kFragmentSource);
+    ASSERT_NE(id, 0u);
+    EXPECT_EQ(shaders.Load("Same", kVertexSource, kFragmentSource), id);
+
+    const GLuint program = shaders.GetProgram(id);
+    EXPECT_EQ(shaders.GetLocation(id, shaders.GetUniformSlot("u_color")), glGetUniformLocation(program, "u_color"));
+    EXPECT_EQ(shaders.GetLocation(id, shaders.GetUniformSlot("u_offset")), glGetUniformLocation(program, "u_offset"));
+    EXPECT_EQ(shaders.GetLocation(id, ShaderCache::kTextureSlot), glGetUniformLocation(program, "u_texture"));
+    // Arrays are found without [0]
+    EXPECT_EQ(shaders.GetLocation(id, shaders.GetUniformSlot("u_weights")), glGetUniformLocation(program, "u_weights"));
+    EXPECT_EQ(shaders.GetLocation(id, ShaderCache::kScreenSizeSlot), -1);
+    EXPECT_EQ(shaders.GetLocation(id, shaders.GetUniformSlot("u_missing")), -1);
+    shaders.Exit();
+}
+
+TEST_F(ShaderCacheTest, SecondLoadSkipsCompilation)
+{
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if(format_count == 0)
+        GTEST_SKIP() << "Driver doesn't support program binaries";
+
+    {
+        ShaderCache shaders;
+        shaders.Init(directory);
+        ASSERT_NE(shaders.Load("Test", kVertexSource, kFragmentSource), 0u);
+        EXPECT_EQ(shaders.GetCompiledCount(), 1u);
+        EXPECT_EQ(shaders.GetCachedCount(), 0u);
+        shaders.Exit();
+    }
+
+    ShaderCache shaders;
+    shaders.Init(directory);
+    const uint32_t id = shaders.Load("Test", kVertexSource, kFragmentSource);
+    ASSERT_NE(id, 0u);
+    EXPECT_EQ(shaders.GetCompiledCount(), 0u);
+    EXPECT_EQ(shaders.GetCachedCount(), 1u);
+    EXPECT_EQ(shaders.GetLocation(id, shaders.GetUniformSlot("u_color")), glGetUniformLocation(shaders.GetProgram(id), "u_color"));
+
+    // Changed source misses the cache
+    const std::string changed = std::string(kFragmentSource) + "\n";
+    ASSERT_NE(shaders.Load("Changed", kVertexSource, changed), 0u);
+    EXPECT_EQ(shaders.GetCompiledCount(), 1u);
+    shaders.Exit();
+}
+
+TEST_F(ShaderCacheTest, CorruptedBinaryIsCompiledAgain)
+{
+    {
+        ShaderCache shaders;
+        shaders.Init(directory);
+        ASSERT_NE(shaders.Load("Test", kVertexSource, kFragmentSource), 0u);
+        shaders.Exit();
+    }
+    for(const auto &entry : std::filesystem::directory_iterator(directory))
+        std::filesystem::resize_file(entry.path(), std::filesystem::file_size(entry.path()) / 2);
+
+    ShaderCache shaders;
+    shaders.Init(directory);
+    EXPECT_NE(shaders.Load("Test", kVertexSource, kFragmentSource), 0u);
+    EXPECT_EQ(shaders.GetCompiledCount(), 1u);
+    shaders.Exit();
+}
+
+TEST_F(ShaderCacheTest, BrokenSourceFails)
+{
+    ShaderCache shaders;
+    shaders.Init("");
+    EXPECT_EQ(shaders.Load("Broken", kVertexSource, "#version 430 core\nvoid main() { oops }\n"), 0u);
+    shaders.Exit();
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,95 @@
+#include "Utils/SkylinePacker.hpp"
+
+#include "TestSetup.hpp"
+
+#include <vector>
+#include <random>
+
+namespace
+{
+struct Rect
+{
+    int32_t x, y, width, height;
+};
+
+bool Overlap(const Rect &lhs, const Rect &rhs)
+{
+    return lhs.x < rhs.x + rhs.width && rhs.x < lhs.x + lhs.width && lhs.y < rhs.y + rhs.height && rhs.y < lhs.y + lhs.height;
+}
+} // namespace
+
+TEST(SkylinePackerTest, FillsRowsLeftToRight)
+{
+    SkylinePacker packer(64, 64);
+    int32_t x, y;
+    ASSERT_TRUE(packer.Pack(32, 16, x, y));
+    EXPECT_EQ(x, 0);
+    EXPECT_EQ(y, 0);
+    ASSERT_TRUE(packer.Pack(32, 16, x, y));
+    EXPECT_EQ(x, 32);
+    EXPECT_EQ(y, 0);
+    ASSERT_TRUE(packer.Pack(64, 16, x, y));
+    EXPECT_EQ(x, 0);
+    EXPECT_EQ(y, 16);
+    EXPECT_EQ(packer.GetUsedArea(), 64 * 32);
+}
+
+TEST(SkylinePackerTest, FillsLowerGapFirst)
+{
+    SkylinePacker packer(64, 64);
+    int32_t x, y;
+    ASSERT_TRUE(packer.Pack(32, 32, x, y));
+    ASSERT_TRUE(packer.Pack(32, 8, x, y));
+    // Space next to short rectangle is lower than the one on top of tall rectangle
+    ASSERT_TRUE(packer.Pack(16, 16, x, y));
+    EXPECT_EQ(x, 32);
+    EXPECT_EQ(y, 8);
+}
+
+TEST(SkylinePackerTest, RejectsWhatDoesNotFit)
+{
+    SkylinePacker packer(64, 64);
+    int32_t x = -1, y = -1;
+    EXPECT_FALSE(packer.Pack(65, 1, x, y));
+    EXPECT_FALSE(packer.Pack(1, 65, x, y));
+    EXPECT_FALSE(packer.Pack(0, 1, x, y));
+    EXPECT_EQ(x, -1);
+    EXPECT_EQ(y, -1);
+
+    ASSERT_TRUE(packer.Pack(64, 64, x, y));
+    EXPECT_FALSE(packer.Pack(1, 1, x, y));
+    EXPECT_FLOAT_EQ(packer.GetOccupancy(), 1.0f);
+
+    packer.Clear();
+    EXPECT_TRUE(packer.Pack(1, 1, x, y));
+}
+
+TEST(SkylinePackerTest, RandomRectanglesDoNotOverlap)
+{
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int32_t> size(1, 48);
+    SkylinePacker packer(512, 512);
+    std::vector<Rect> packed;
+    for(int i = 0; i < 2000; ++i)
+    {
+        Rect rect{0, 0, size(random), size(random)};
+        if(!packer.Pack(rect.width, rect.height, rect.x, rect.y))
+            continue;
+        ASSERT_GE(rect.x, 0);
+        ASSERT_GE(rect.y, 0);
+        ASSERT_LE(rect.x + rect.width, 512);
+        ASSERT_LE(rect.y + rect.height, 512);
+        for(const Rect &other : packed)
+            ASSERT_FALSE(Overlap(rect, other));
+        packed.push_back(rect);
+    }
+
+    // Skyline wastes space only under overhangs, so random sizes still fill most of the page
+    EXPECT_GT(packer.GetOccupancy(), 0.7f);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+#include "Platform/OpenGL/SpriteRenderer.hpp"
+#include "RenderHarness.hpp"
+
+#include "TestSetup.hpp"
+
+#include <vector>
+
+namespace
+{
+constexpr int kWidth = 64;
+constexpr int kHeight = 64;
+
+class SpriteRendererTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string error = gl.Init("SpriteRendererTest", kWidth, kHeight);
+        if(!error.empty())
+            GTEST_SKIP() << error;
+
+        // Disk cache is off, so tests don't leave files behind
+        state.Init(false);
+        shaders.Init("");
+        sprites.Init(shaders, state);
+        glViewport(0, 0, kWidth, kHeight);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    void TearDown() override
+    {
+        if(gl.IsReady())
+        {
+            sprites.Exit();
+            shaders.Exit();
+        }
+        gl.Exit();
+    }
+
+    /// RGBA of pixel, y from the top
+    uint32_t ReadPixel(int x, int y)
+    {
+        uint32_t pixel;
+        glReadPixels(x, kHeight - 1 - y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &pixel);
+        return pixel;
+    }
+
+    TestGLContext gl;
+    GLState state;
+    ShaderCache shaders;
+    SpriteRenderer sprites;
+};
+
+SpriteInstance MakeSprite(float x, float y, float size, uint32_t color)
+{
+    SpriteInstance sprite;
+    sprite.position[0] = x;
+    sprite.position[1] = y;
+    sprite.size[0] = size;
+    sprite.size[1] = size;
+    sprite.color = color;
+    return sprite;
+}
+} // namespace
+
+TEST_F(SpriteRendererTest, DrawsTintedQuads)
+{
+    constexpr uint32_t kRed = 0xff0000ff;
+    constexpr uint32_t kGreen = 0xff00ff00;
+
+    sprites.Begin(kWidth, kHeight);
+    sprites.Draw(0, 0, MakeSprite(16.0f, 16.0f, 16.0f, kRed));
+    sprites.Draw(0, 0, MakeSprite(48.0f, 48.0f, 16.0f, kGreen));
+    sprites.End();
+    glFinish();
+
+    EXPECT_EQ(sprites.GetDrawCallCount(), 1u);
+    EXPECT_EQ(ReadPixel(16, 16), kRed);
+    EXPECT_EQ(ReadPixel(48, 48), kGreen);
+    EXPECT_EQ(ReadPixel(48, 16), 0xff000000u);
+    EXPECT_EQ(ReadPixel(4, 4), 0xff000000u);
+}
+
+TEST_F(SpriteRendererTest, LaterSpritesAreOnTop)
+{
+    sprites.Begin(kWidth, kHeight);
+    sprites.Draw(0, 0, MakeSprite(32.0f, 32.0f, 32.0f, 0xff0000ff));
+    sprites.Draw(0, 0, MakeSprite(32.0f, 32.0f, 8.0f, 0xffff0000));
+    sprites.End();
+    glFinish();
+
+    EXPECT_EQ(ReadPixel(32, 32), 0xffff0000u);
+    EXPECT_EQ(ReadPixel(20, 20), 0xff0000ffu);
+}
+
+TEST_F(SpriteRendererTest, BatchesByTexture)
+{
+    // White texture is the same as texture 0, but has different handle, so batch is split
+    sprites.Begin(kWidth, kHeight);
+    sprites.Draw(0, 0, MakeSprite(8.0f, 8.0f, 4.0f, 0xffffffff));
+    sprites.Draw(0, 0, MakeSprite(16.0f, 8.0f, 4.0f, 0xffffffff));
+    sprites.Draw(0, sprites.GetWhiteTexture(), MakeSprite(24.0f, 8.0f, 4.0f, 0xffffffff));
+    sprites.End();
+
+    EXPECT_EQ(sprites.GetDrawCallCount(), 2u);
+}
+
+TEST_F(SpriteRendererTest, ManySpritesWrapSegments)
+{
+    // More than one segment per frame for several frames, so fences are waited on
+    const std::size_t count = SpriteRenderer::kSpritesPerSegment + 1000;
+    for(int frame = 0; frame < 4; ++frame)
+    {
+        glClear(GL_COLOR_BUFFER_BIT);
+        sprites.Begin(kWidth, kHeight);
+        for(std::size_t i = 0; i < count; ++i)
+            sprites.Draw(0, 0, MakeSprite(static_cast<float>(i % kWidth) + 0.5f, static_cast<float>(i / kWidth % kHeight) + 0.5f, 1.0f, 0xff00ff00));
+        sprites.End();
+
+        EXPECT_EQ(sprites.GetDrawCallCount(), 2u);
+    }
+    glFinish();
+
+    EXPECT_EQ(ReadPixel(0, 0), 0xff00ff00u);
+    EXPECT_EQ(ReadPixel(kWidth - 1, kHeight - 1), 0xff00ff00u);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
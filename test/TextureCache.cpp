@@ -0,0 +1,263 @@
+#include "Core/TextureCache.hpp"
+
+#include "TestSetup.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+/// res directory is found relative to this file, so test can be run from any directory
+const std::string kResPath = std::string(__FILE__).substr(0, std::string(__FILE__).find_last_of("/\\")) + "/../res/";
+
+Image MakeImage(int32_t width, int32_t height, uint32_t color)
+{
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.assign(static_cast<std::size_t>(width) * height, color);
+    return image;
+}
+} // namespace
+
+TEST(TextureCacheTest, LoadsPng)
+{
+    TextureCache cache;
+    const TextureRegion region = cache.Load(kResPath + "NoTexture64.png");
+    EXPECT_NE(region.texture, 0u);
+    EXPECT_EQ(region.width, 64);
+    EXPECT_EQ(region.height, 64);
+
+    std::vector<TextureUpload> uploads;
+    cache.TakeUploads(uploads);
+    ASSERT_EQ(uploads.size(), 2u);
+    // Page is created, then image is copied into it with padding
+    EXPECT_TRUE(uploads[0].pixels.empty());
+    EXPECT_EQ(uploads[0].texture_width, TextureCache::kPageSize);
+    EXPECT_EQ(uploads[1].texture, region.texture);
+    EXPECT_EQ(uploads[1].width, 64 + TextureCache::kPadding * 2);
+}
+
+TEST(TextureCacheTest, SamePathIsLoadedOnce)
+{
+    TextureCache cache;
+    const TextureRegion first = cache.Load(kResPath + "NoTexture64.png");
+    std::vector<TextureUpload> uploads;
+    cache.TakeUploads(uploads);
+    uploads.clear();
+
+    const TextureRegion second = cache.Load(kResPath + "NoTexture64.png");
+    EXPECT_EQ(first.texture, second.texture);
+    EXPECT_FLOAT_EQ(first.uv[0], second.uv[0]);
+    EXPECT_EQ(cache.GetImageCount(), 1u);
+    cache.TakeUploads(uploads);
+    EXPECT_TRUE(uploads.empty());
+}
+
+TEST(TextureCacheTest, MissingFileFallsBack)
+{
+    TextureCache cache;
+    cache.SetFallbackPath(kResPath + "NoTexture64.png");
+    const TextureRegion missing = cache.Load("does/not/exist.png");
+    const TextureRegion fallback = cache.GetFallback();
+    EXPECT_NE(missing.texture, 0u);
+    EXPECT_EQ(missing.texture, fallback.texture);
+    EXPECT_FLOAT_EQ(missing.uv[1], fallback.uv[1]);
+    EXPECT_EQ(missing.width, 64);
+    EXPECT_NE(cache.Find(kResPath + "NoTexture64.png"), nullptr);
+}
+
+TEST(TextureCacheTest, MissingFallbackIsGenerated)
+{
+    TextureCache cache;
+    cache.SetFallbackPath("does/not/exist/either.png");
+    const TextureRegion region = cache.Load("does/not/exist.png");
+    EXPECT_NE(region.texture, 0u);
+    EXPECT_EQ(region.width, 64);
+    EXPECT_EQ(region.height, 64);
+}
+
+TEST(TextureCacheTest, SmallImagesShareAtlasPage)
+{
+    TextureCache cache;
+    const TextureRegion red = cache.Add("red", MakeImage(16, 16, 0xff0000ff));
+    const TextureRegion green = cache.Add("green", MakeImage(32, 8, 0xff00ff00));
+    EXPECT_EQ(red.texture, green.texture);
+    EXPECT_EQ(cache.GetPageCount(), 1u);
+
+    // Regions don't overlap and span exactly the image
+    constexpr float kTexel = 1.0f / TextureCache::kPageSize;
+    EXPECT_FLOAT_EQ(red.uv[2] - red.uv[0], 16 * kTexel);
+    EXPECT_FLOAT_EQ(green.uv[3] - green.uv[1], 8 * kTexel);
+    const bool separate = red.uv[2] <= green.uv[0] || green.uv[2] <= red.uv[0] || red.uv[3] <= green.uv[1] || green.uv[3] <= red.uv[1];
+    EXPECT_TRUE(separate);
+}
+
+TEST(TextureCacheTest, PaddingRepeatsEdges)
+{
+    TextureCache cache;
+    Image image = MakeImage(2, 2, 0);
+    image.pixels = { 1, 2, 3, 4 };
+    __attribute__((unused)) const TextureRegion region = cache.Add("corners", image);
+
+    std::vector<TextureUpload> uploads;
+    cache.TakeUploads(uploads);
+    ASSERT_EQ(uploads.size(), 2u);
+    const std::vector<uint32_t> expected = {
+        1, 1, 2, 2,
+        1, 1, 2, 2,
+        3, 3, 4, 4,
+        3, 3, 4, 4
+    };
+    EXPECT_EQ(uploads[1].pixels, expected);
+}
+
+TEST(TextureCacheTest, BigImagesGetOwnTexture)
+{
+    TextureCache cache;
+    const TextureRegion small = cache.Add("small", MakeImage(8, 8, 0xffffffff));
+    const TextureRegion big = cache.Add("big", MakeImage(TextureCache::kMaxAtlasedSize + 1, 4, 0xffffffff));
+    EXPECT_NE(small.texture, big.texture);
+    EXPECT_FLOAT_EQ(big.uv[0], 0.0f);
+    EXPECT_FLOAT_EQ(big.uv[3], 1.0f);
+    EXPECT_EQ(cache.GetPageCount(), 1u);
+    EXPECT_EQ(cache.GetTextureCount(), 2u);
+}
+
+TEST(TextureCacheTest, FullPageOpensNewOne)
+{
+    TextureCache cache;
+    const int32_t side = TextureCache::kMaxAtlasedSize - TextureCache::kPadding * 2;
+    const int32_t per_page = (TextureCache::kPageSize / TextureCache::kMaxAtlasedSize) * (TextureCache::kPageSize / TextureCache::kMaxAtlasedSize);
+    const Image image = MakeImage(side, side, 0xffffffff);
+    for(int32_t i = 0; i <= per_page; ++i)
+        __attribute__((unused)) const TextureRegion region = cache.Add("image" + std::to_string(i), image);
+    EXPECT_EQ(cache.GetPageCount(), 2u);
+}
+
+TEST(TextureCacheTest, EvictsOnlyUnreferencedTextures)
+{
+    TextureCache cache;
+    const int32_t side = TextureCache::kMaxAtlasedSize + 1;
+    const int64_t bytes = int64_t{side} * side * sizeof(uint32_t);
+    const TextureRegion pinned = cache.Add("pinned", MakeImage(side, side, 0));
+    const TextureRegion kept = cache.Add("kept", MakeImage(side, side, 0), true);
+    const TextureRegion old = cache.Add("old", MakeImage(side, side, 0), true);
+    const TextureRegion recent = cache.Add("recent", MakeImage(side, side, 0), true);
+    cache.Retain(kept.texture);
+    cache.Retain(old.texture);
+    cache.Retain(recent.texture);
+    cache.Release(old.texture);
+    cache.Release(recent.texture);
+    EXPECT_EQ(cache.GetMemoryUsage(), bytes * 4);
+
+    // Least recently released goes first
+    EXPECT_EQ(cache.Evict(bytes * 3), bytes);
+    EXPECT_EQ(cache.Find("old"), nullptr);
+    EXPECT_NE(cache.Find("recent"), nullptr);
+
+    // Pinned and retained textures stay even if limit can't be reached
+    EXPECT_EQ(cache.Evict(0), bytes);
+    EXPECT_EQ(cache.GetMemoryUsage(), bytes * 2);
+    EXPECT_NE(cache.Find("pinned"), nullptr);
+    EXPECT_NE(cache.Find("kept"), nullptr);
+    EXPECT_EQ(cache.Find("recent"), nullptr);
+
+    std::vector<TextureUpload> uploads;
+    cache.TakeUploads(uploads);
+    ASSERT_EQ(uploads.size(), 6u);
+    EXPECT_TRUE(uploads[4].release);
+    EXPECT_EQ(uploads[4].texture, old.texture);
+    EXPECT_TRUE(uploads[5].release);
+    EXPECT_EQ(uploads[5].texture, recent.texture);
+    EXPECT_NE(pinned.texture, 0u);
+}
+
+TEST(TextureCacheTest, EvictedIdIsReused)
+{
+    TextureCache cache;
+    const int32_t side = TextureCache::kMaxAtlasedSize + 1;
+    const TextureRegion evicted = cache.Add("evicted", MakeImage(side, side, 0), true);
+    EXPECT_GT(cache.Evict(0), 0);
+    const TextureRegion added = cache.Add("added", MakeImage(side, side, 1), true);
+    EXPECT_EQ(added.texture, evicted.texture);
+    EXPECT_EQ(cache.GetTextureCount(), 1u);
+
+    // Release comes before pixels of the new texture, so backend deletes the old one first
+    std::vector<TextureUpload> uploads;
+    cache.TakeUploads(uploads);
+    ASSERT_EQ(uploads.size(), 3u);
+    EXPECT_TRUE(uploads[1].release);
+    EXPECT_FALSE(uploads[2].release);
+    EXPECT_EQ(uploads[2].texture, evicted.texture);
+    EXPECT_EQ(uploads[2].pixels, std::vector<uint32_t>(static_cast<std::size_t>(side) * side, 1));
+}
+
+TEST(TextureCacheTest, LoadPinsEvictableTexture)
+{
+    TextureCache cache;
+    const TextureRegion region = cache.Add(kResPath + "NoTexture64.png", MakeImage(4, 4, 0), true);
+    EXPECT_EQ(cache.Load(kResPath + "NoTexture64.png").texture, region.texture);
+    EXPECT_EQ(cache.Evict(0), 0);
+    EXPECT_NE(cache.Find(kResPath + "NoTexture64.png"), nullptr);
+}
+
+TEST(TextureCacheTest, ReloadOverwritesInPlace)
+{
+    TextureCache cache;
+    __attribute__((unused)) const TextureRegion other = cache.Add("other", MakeImage(8, 8, 1));
+    const TextureRegion region = cache.Add("image", MakeImage(4, 4, 2));
+    std::vector<TextureUpload> uploads;
+    cache.TakeUploads(uploads);
+    const TextureUpload original = uploads.back();
+    uploads.clear();
+
+    const TextureRegion *reloaded = cache.Reload("image", MakeImage(4, 4, 3));
+    ASSERT_NE(reloaded, nullptr);
+    EXPECT_EQ(reloaded->texture, region.texture);
+    EXPECT_FLOAT_EQ(reloaded->uv[0], region.uv[0]);
+    EXPECT_FLOAT_EQ(reloaded->uv[3], region.uv[3]);
+
+    // Same padded rectangle is uploaded again
+    cache.TakeUploads(uploads);
+    ASSERT_EQ(uploads.size(), 1u);
+    EXPECT_EQ(uploads[0].x, original.x);
+    EXPECT_EQ(uploads[0].y, original.y);
+    EXPECT_EQ(uploads[0].width, original.width);
+    EXPECT_EQ(uploads[0].pixels, std::vector<uint32_t>(original.pixels.size(), 3));
+
+    EXPECT_EQ(cache.Reload("missing", MakeImage(4, 4, 3)), nullptr);
+}
+
+TEST(TextureCacheTest, ReloadWithNewSizePlacesImageAgain)
+{
+    TextureCache cache;
+    const int32_t big = TextureCache::kMaxAtlasedSize + 1;
+    const TextureRegion region = cache.Add("image", MakeImage(big, big, 2));
+    const TextureRegion *reloaded = cache.Reload("image", MakeImage(4, 4, 3));
+    ASSERT_NE(reloaded, nullptr);
+    EXPECT_NE(reloaded->texture, region.texture);
+    EXPECT_EQ(reloaded->width, 4);
+    EXPECT_EQ(cache.Find("image")->texture, reloaded->texture);
+
+    // Old texture isn't pinned anymore, so it can be freed
+    EXPECT_EQ(cache.Evict(0), int64_t{big} * big * sizeof(uint32_t));
+    EXPECT_NE(cache.Find("image"), nullptr);
+}
+
+TEST(TextureCacheTest, ReloadDoesntOverwriteFallback)
+{
+    TextureCache cache;
+    cache.SetFallbackPath(kResPath + "NoTexture64.png");
+    const TextureRegion failed = cache.Load(kResPath + "Missing.png");
+    const TextureRegion *reloaded = cache.Reload(kResPath + "Missing.png", MakeImage(64, 64, 3));
+    ASSERT_NE(reloaded, nullptr);
+    EXPECT_FALSE(reloaded->texture == failed.texture && reloaded->uv[0] == failed.uv[0] && reloaded->uv[1] == failed.uv[1]);
+    EXPECT_FLOAT_EQ(cache.GetFallback().uv[0], failed.uv[0]);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,78 @@
+/*
+Packs directory into archive that is read by game::Archive
+
+Usage: AssetPacker <output> <directory> [-prefix=name] [-lz4]
+Entries are named as prefix/relative/path with '/' separators, prefix is the directory name by default,
+so res/NoTexture64.png is found under the same path it has when loaded from files
+*/
+
+#include "Setup.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "Core/Archive.hpp"
+#include "Utils/FlagParser.hpp"
+#include "Utils/Logger.hpp"
+
+
+int main(int argc, char **argv)
+{
+  namespace fs = std::filesystem;
+  using namespace game;
+
+  Flags flags(argc, argv);
+  if(argc < 3)
+  {
+    GAME_LOG(LogType::Error) << "Usage: AssetPacker <output> <directory> [-prefix=name] [-lz4]";
+    return 1;
+  }
+  const std::string output = argv[1];
+  const fs::path directory = argv[2];
+  fs::path normal = fs::absolute(directory).lexically_normal();
+  // Trailing separator leaves empty file name
+  if(!normal.has_filename())
+    normal = normal.parent_path();
+  const std::string prefix = flags.Contains("-prefix") ? flags.Get("-prefix") : normal.filename().string();
+  const bool compress = flags.Contains("-lz4");
+
+  std::error_code error;
+  std::vector<fs::path> files;
+  for(const fs::directory_entry &entry : fs::recursive_directory_iterator(directory, error))
+    if(entry.is_regular_file())
+      files.push_back(entry.path());
+  if(error)
+  {
+    GAME_LOG(LogType::Error) << "Couldn't list " << directory.string() << ": " << error.message();
+    return 1;
+  }
+  // Same input always gives same archive
+  std::sort(files.begin(), files.end());
+
+  ArchiveWriter writer;
+  std::size_t total_size = 0;
+  for(const fs::path &file : files)
+  {
+    std::ifstream stream(file, std::ios::binary);
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    if(!stream.good() && !stream.eof())
+    {
+      GAME_LOG(LogType::Error) << "Couldn't read " << file.string();
+      return 1;
+    }
+
+    const std::string name = prefix.empty() ? file.lexically_relative(directory).generic_string() : prefix + '/' + file.lexically_relative(directory).generic_string();
+    if(!writer.Add(name, reinterpret_cast<const std::byte*>(bytes.data()), bytes.size(), compress))
+      return 1;
+    total_size += bytes.size();
+  }
+
+  if(!writer.Write(output))
+    return 1;
+  GAME_LOG(LogType::Info) << "Packed " << writer.GetEntryCount() << " files of " << total_size << " bytes into " << output;
+  return 0;
+}
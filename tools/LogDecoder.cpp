@@ -0,0 +1,70 @@
+/*
+Turns .binlog file written by GAME_BLOG lines into text
+Archived logs compressed by Logger are decompressed first, archived text log is written as it is
+
+Usage: LogDecoder <input> [-output=path]
+Text is written to standard output without -output, lines look like they would if they were logged by GAME_LOG
+Errors go to standard error instead of Logger, which would truncate last_log.txt next to the decoded file
+*/
+
+#include "Setup.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "Utils/BinaryLog.hpp"
+#include "Utils/FlagParser.hpp"
+#include "Utils/LogArchive.hpp"
+
+
+int main(int argc, char **argv)
+{
+  using namespace game;
+
+  Flags flags(argc, argv);
+  if(argc < 2)
+  {
+    std::cerr << "Usage: LogDecoder <input> [-output=path]\n";
+    return 1;
+  }
+  const std::string input = argv[1];
+
+  std::string content;
+  if(!ReadLogFile(input, content))
+  {
+    std::cerr << "Couldn't read " << input << '\n';
+    return 1;
+  }
+  std::string text;
+  bool complete = true;
+  if(content.compare(0, kBinaryLogMagic.size(), kBinaryLogMagic) == 0)
+  {
+    // Log of crashed game can end in the middle of entry, lines before it are still worth reading
+    std::istringstream in(content);
+    complete = DecodeBinaryLog(in, text);
+  }
+  else
+    text = std::move(content);
+
+  if(flags.Contains("-output"))
+  {
+    std::ofstream out(flags.Get("-output"), std::ios::binary);
+    out << text;
+    if(!out.good())
+    {
+      std::cerr << "Couldn't write " << flags.Get("-output") << '\n';
+      return 1;
+    }
+  }
+  else
+    std::cout << text << std::flush;
+
+  if(!complete)
+  {
+    std::cerr << input << " isn't binary log or it is cut short\n";
+    return 1;
+  }
+  return 0;
+}